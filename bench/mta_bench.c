@@ -0,0 +1,1061 @@
+/**
+ * Microbenchmarks for the point operations, base OT, COT and MtA
+ *
+ * Every benchmark runs a warm-up iteration, then times single iterations
+ * until both --min-time seconds and --min-iters iterations are reached.
+ * Results are printed as JSON (default) or CSV with ops/sec, items/sec
+ * and the p50/p99 latency of one iteration.
+ *
+ * Usage: mta_bench [--format json|csv] [--filter SUBSTRING]
+ *                  [--threads 1,2,4] [--min-time SECONDS] [--min-iters N]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "mta.h"
+#include "mta_pool.h"
+#include "cot.h"
+#include "point_ops.h"
+#include "thread_pool.h"
+#include "transport.h"
+#include "mta_party.h"
+#include "utils.h"
+#include "kdf.h"
+#include "logger.h"
+#include "rand.h"
+
+#define BENCH_MAX_ITERS 100000
+#define BENCH_MAX_THREAD_COUNTS 16
+#define BENCH_NAME_LEN 64
+
+// Sizes of the batched benchmarks
+#define BENCH_BASE_OT_BATCH OT_EXT_KAPPA
+#define BENCH_MTA_BATCH 16
+#define BENCH_MTA_PARALLEL 4
+#define BENCH_KDF_ROWS 512
+
+typedef enum {
+    FORMAT_JSON = 0,
+    FORMAT_CSV = 1
+} bench_format_t;
+
+typedef struct {
+    bench_format_t format;
+    const char *filter;
+    double min_time;
+    size_t min_iters;
+    int thread_counts[BENCH_MAX_THREAD_COUNTS];
+    int num_thread_counts;
+} bench_options_t;
+
+/**
+ * One benchmark: setup runs once, run is one timed iteration
+ */
+typedef struct {
+    const char *name;
+    size_t items;                            // Items processed per iteration
+    int uses_threads;                        // Run once per --threads entry
+    int (*setup)(int threads);
+    int (*run)(void);
+    void (*teardown)(void);
+} bench_t;
+
+typedef struct {
+    char name[BENCH_NAME_LEN];
+    int threads;
+    size_t iterations;
+    double total_ns;
+    double mean_ns;
+    double p50_ns;
+    double p99_ns;
+    double ops_per_sec;
+    double items_per_sec;
+} bench_result_t;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1e9 * ts.tv_sec + ts.tv_nsec;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const double *sorted, size_t n, double p) {
+    size_t rank = (size_t)(p / 100.0 * n + 0.999999);
+    if (rank < 1) {
+        rank = 1;
+    }
+    if (rank > n) {
+        rank = n;
+    }
+    return sorted[rank - 1];
+}
+
+static void random_scalar(bignum256 *k) {
+    generate_random_nonzero_scalar(k);
+}
+
+/* ---- Point operations ---- */
+
+static bignum256 bench_k;
+static curve_point bench_p;
+static bignum256 bench_multi_k[2];
+static curve_point bench_multi_p[2];
+
+static int setup_point(int threads) {
+    (void)threads;
+    bignum256 p_key;
+    random_scalar(&bench_k);
+    random_scalar(&p_key);
+    for (int i = 0; i < 2; i++) {
+        random_scalar(&bench_multi_k[i]);
+        random_scalar(&p_key);
+        if (opt_scalar_multiply(&secp256k1, &p_key, &bench_multi_p[i]) != 1) {
+            return -1;
+        }
+    }
+    return opt_scalar_multiply(&secp256k1, &p_key, &bench_p) == 1 ? 0 : -1;
+}
+
+static int run_scalar_multiply(void) {
+    curve_point res;
+    return opt_scalar_multiply(&secp256k1, &bench_k, &res) == 1 ? 0 : -1;
+}
+
+static int run_point_multiply(void) {
+    curve_point res;
+    return opt_point_multiply(&secp256k1, &bench_k, &bench_p, &res) == 1 ? 0 : -1;
+}
+
+static int run_point_multiply_ct(void) {
+    curve_point res;
+    return opt_point_multiply_ct(&secp256k1, &bench_k, &bench_p, &res) == 1 ? 0 : -1;
+}
+
+static int run_multi_point_multiply(void) {
+    curve_point res;
+    return opt_multi_point_multiply(&secp256k1, 2, bench_multi_k, bench_multi_p, &res) == 1
+               ? 0 : -1;
+}
+
+/* ---- Base OT and COT ---- */
+
+static uint8_t bench_m0[32], bench_m1[32];
+static OT_SenderMessage bench_sender_msg;
+static OT_ReceiverMessage bench_receiver_msg;
+static bignum256 bench_a;
+
+static int setup_base_ot(int threads) {
+    (void)threads;
+    uint8_t k_c[32];
+    random_buffer(bench_m0, sizeof(bench_m0));
+    random_buffer(bench_m1, sizeof(bench_m1));
+    if (base_ot_init_sender(bench_m0, bench_m1, &bench_sender_msg, &bench_a) != 0) {
+        return -1;
+    }
+    return base_ot_receiver_choice(&bench_sender_msg, 1, &bench_receiver_msg, k_c);
+}
+
+static int run_base_ot_init_sender(void) {
+    OT_SenderMessage msg;
+    bignum256 a;
+    return base_ot_init_sender(bench_m0, bench_m1, &msg, &a);
+}
+
+static int run_base_ot_receiver_choice(void) {
+    OT_ReceiverMessage msg;
+    uint8_t k_c[32];
+    return base_ot_receiver_choice(&bench_sender_msg, 1, &msg, k_c);
+}
+
+static int run_base_ot_sender_keys(void) {
+    uint8_t k0[32], k1[32];
+    return base_ot_sender_keys(&bench_a, &bench_receiver_msg, k0, k1);
+}
+
+static int run_cot_transfer(void) {
+    uint8_t c0[32], c1[32];
+    return cot_transfer(bench_m1, &bench_a, &bench_receiver_msg, bench_m0, c0, c1, 32);
+}
+
+static int run_base_ot_batch(void) {
+    static OT_SenderMessage sender_msgs[BENCH_BASE_OT_BATCH];
+    static OT_ReceiverMessage receiver_msgs[BENCH_BASE_OT_BATCH];
+    static bignum256 a[BENCH_BASE_OT_BATCH];
+    static int choice_bits[BENCH_BASE_OT_BATCH];
+    static uint8_t k_c[BENCH_BASE_OT_BATCH][32];
+    static uint8_t k0[BENCH_BASE_OT_BATCH][32], k1[BENCH_BASE_OT_BATCH][32];
+
+    for (int i = 0; i < BENCH_BASE_OT_BATCH; i++) {
+        choice_bits[i] = i & 1;
+    }
+
+    if (base_ot_init_sender_batch(BENCH_BASE_OT_BATCH, sender_msgs, a) != 0 ||
+        base_ot_receiver_choice_batch(BENCH_BASE_OT_BATCH, sender_msgs, choice_bits,
+                                      receiver_msgs, k_c) != 0 ||
+        base_ot_sender_keys_batch(BENCH_BASE_OT_BATCH, a, receiver_msgs, k0, k1) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Runs a benchmark with the OT key agreement over Curve25519
+static int setup_curve25519(int threads) {
+    (void)threads;
+    return base_ot_set_backend(BASE_OT_BACKEND_CURVE25519);
+}
+
+static void teardown_curve25519(void) {
+    base_ot_set_backend(BASE_OT_DEFAULT_BACKEND);
+}
+
+/* ---- SHA-256 ---- */
+
+// Two blocks per message once padded, like the key derivation of a point
+#define BENCH_SHA256_LEN 65
+
+static uint8_t bench_sha256_msgs[8][BENCH_SHA256_LEN];
+
+static int run_sha256_raw(void) {
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    sha256_Raw(bench_sha256_msgs[0], BENCH_SHA256_LEN, digest);
+    return 0;
+}
+
+static int run_sha256_raw_x8(void) {
+    const uint8_t *ptrs[8];
+    uint8_t digests[8][SHA256_DIGEST_LENGTH];
+    for (int i = 0; i < 8; i++) {
+        ptrs[i] = bench_sha256_msgs[i];
+    }
+    sha256_Raw_x8(ptrs, BENCH_SHA256_LEN, digests);
+    return 0;
+}
+
+/* ---- KDF backends ---- */
+
+// One chunk of OT extension matrix rows
+static uint8_t bench_kdf_rows[BENCH_KDF_ROWS][KDF_CRH_INPUT_LEN];
+static uint8_t bench_kdf_keys[BENCH_KDF_ROWS][KDF_BLOCK_LEN];
+
+static int run_kdf_crh(kdf_backend_t backend) {
+    kdf_crh_rows(backend, 0, (const uint8_t (*)[KDF_CRH_INPUT_LEN])bench_kdf_rows,
+                 BENCH_KDF_ROWS, bench_kdf_keys);
+    return 0;
+}
+
+static int run_kdf_crh_sha256(void) {
+    return run_kdf_crh(KDF_BACKEND_SHA256);
+}
+
+static int run_kdf_crh_blake2s(void) {
+    return run_kdf_crh(KDF_BACKEND_BLAKE2S);
+}
+
+static int run_kdf_crh_aes(void) {
+    return run_kdf_crh(KDF_BACKEND_AES);
+}
+
+/* ---- OT extension ---- */
+
+static ot_ext_sender_t bench_ot_sender;
+static ot_ext_receiver_t bench_ot_receiver;
+
+static int run_ot_ext_setup(void) {
+    static OT_SenderMessage base_msgs[OT_EXT_KAPPA];
+    static OT_ReceiverMessage base_responses[OT_EXT_KAPPA];
+
+    if (ot_ext_receiver_setup(&bench_ot_receiver, base_msgs) != 0 ||
+        ot_ext_sender_setup(&bench_ot_sender, base_msgs, base_responses) != 0 ||
+        ot_ext_receiver_setup_complete(&bench_ot_receiver, base_responses) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int setup_ot_ext(int threads) {
+    (void)threads;
+    return run_ot_ext_setup();
+}
+
+static void teardown_ot_ext(void) {
+    ot_ext_sender_clear(&bench_ot_sender);
+    ot_ext_receiver_clear(&bench_ot_receiver);
+}
+
+// OT extension sessions with the BLAKE2s and AES kdf backends
+static int setup_ot_ext_blake2s(int threads) {
+    (void)threads;
+    kdf_set_backend(KDF_BACKEND_BLAKE2S);
+    return run_ot_ext_setup();
+}
+
+static int setup_ot_ext_aes(int threads) {
+    (void)threads;
+    kdf_set_backend(KDF_BACKEND_AES);
+    return run_ot_ext_setup();
+}
+
+static void teardown_ot_ext_kdf(void) {
+    teardown_ot_ext();
+    kdf_set_backend(KDF_DEFAULT_BACKEND);
+}
+
+static int run_ot_ext_extend(void) {
+    static uint8_t choices[MTA_NUM_BITS / 8];
+    static uint8_t matrix[MTA_EXT_MATRIX_LEN];
+    static uint8_t keys[MTA_NUM_BITS][32], k0[MTA_NUM_BITS][32], k1[MTA_NUM_BITS][32];
+
+    random_buffer(choices, sizeof(choices));
+    if (ot_ext_receiver_extend(&bench_ot_receiver, choices, MTA_NUM_BITS, matrix, keys) != 0 ||
+        ot_ext_sender_extend(&bench_ot_sender, matrix, MTA_NUM_BITS, k0, k1) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/* ---- MtA ---- */
+
+static thread_pool_t bench_pool;
+static int bench_pool_ready = 0;
+
+static int setup_mta_per_bit(int threads) {
+    if (thread_pool_init(&bench_pool, threads) != 0) {
+        return -1;
+    }
+    bench_pool_ready = 1;
+    return 0;
+}
+
+static void teardown_mta_per_bit(void) {
+    if (bench_pool_ready) {
+        thread_pool_free(&bench_pool);
+        bench_pool_ready = 0;
+    }
+}
+
+static int run_mta_per_bit(void) {
+    static mta_context_t sender_ctx, receiver_ctx;
+    static OT_SenderMessage sender_msgs[MTA_NUM_BITS];
+    static OT_ReceiverMessage receiver_msgs[MTA_NUM_BITS];
+    static uint8_t c0[MTA_NUM_BITS][32], c1[MTA_NUM_BITS][32];
+    bignum256 a, b;
+
+    random_scalar(&a);
+    random_scalar(&b);
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0 ||
+        mta_sender_messages_parallel(&sender_ctx, &bench_pool, sender_msgs) != 0 ||
+        mta_receiver_responses_parallel(&receiver_ctx, &bench_pool, sender_msgs, receiver_msgs) != 0 ||
+        mta_sender_complete_parallel(&sender_ctx, &bench_pool, receiver_msgs, c0, c1) != 0 ||
+        mta_receiver_complete_parallel(&receiver_ctx, &bench_pool,
+                                       (const uint8_t (*)[32])c0,
+                                       (const uint8_t (*)[32])c1) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int run_mta_rounds(void) {
+    static mta_context_t sender_ctx, receiver_ctx;
+    static OT_SenderMessage sender_msgs[MTA_NUM_BITS];
+    static OT_ReceiverMessage receiver_msgs[MTA_NUM_BITS];
+    static uint8_t c0[MTA_NUM_BITS][32], c1[MTA_NUM_BITS][32];
+    bignum256 a, b;
+
+    random_scalar(&a);
+    random_scalar(&b);
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0 ||
+        mta_sender_round1(&sender_ctx, sender_msgs) != 0 ||
+        mta_receiver_round1(&receiver_ctx, sender_msgs, receiver_msgs) != 0 ||
+        mta_sender_round2(&sender_ctx, receiver_msgs, c0, c1) != 0 ||
+        mta_receiver_round2(&receiver_ctx, (const uint8_t (*)[32])c0,
+                            (const uint8_t (*)[32])c1) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int run_mta_rounds_simplest(void) {
+    static mta_context_t sender_ctx, receiver_ctx;
+    static OT_ReceiverMessage receiver_msgs[MTA_NUM_BITS];
+    static uint8_t c0[MTA_NUM_BITS][32], c1[MTA_NUM_BITS][32];
+    OT_SenderMessage sender_msg;
+    bignum256 a, b;
+
+    random_scalar(&a);
+    random_scalar(&b);
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0 ||
+        mta_sender_round1_simplest(&sender_ctx, &sender_msg) != 0 ||
+        mta_receiver_round1_simplest(&receiver_ctx, &sender_msg, receiver_msgs) != 0 ||
+        mta_sender_round2_simplest(&sender_ctx, receiver_msgs, c0, c1) != 0 ||
+        mta_receiver_round2(&receiver_ctx, (const uint8_t (*)[32])c0,
+                            (const uint8_t (*)[32])c1) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int run_mta_ot_ext(void) {
+    static mta_context_t sender_ctx, receiver_ctx;
+    static uint8_t matrix[MTA_EXT_MATRIX_LEN];
+    static uint8_t corrections[MTA_NUM_BITS][32];
+    bignum256 a, b;
+
+    random_scalar(&a);
+    random_scalar(&b);
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0 ||
+        mta_receiver_ext_choose(&receiver_ctx, &bench_ot_receiver, matrix) != 0 ||
+        mta_sender_ext_transfer(&sender_ctx, &bench_ot_sender, matrix, corrections) != 0 ||
+        mta_receiver_ext_complete(&receiver_ctx, (const uint8_t (*)[32])corrections) != 0) {
+        return -1;
+    }
+    return mta_compute_additive_share(&sender_ctx);
+}
+
+// The same MtA on sessions from a pool: no memset on acquire, release
+// wipes only what the session wrote
+static mta_pool_t *bench_session_pool;
+
+static int setup_session_pool(int threads) {
+    (void)threads;
+    bench_session_pool = mta_pool_create(2);
+    return bench_session_pool ? 0 : -1;
+}
+
+static int setup_ot_ext_session_pool(int threads) {
+    if (setup_ot_ext(threads) != 0) {
+        return -1;
+    }
+    return setup_session_pool(threads);
+}
+
+static void teardown_session_pool(void) {
+    mta_pool_destroy(bench_session_pool);
+    bench_session_pool = NULL;
+}
+
+static void teardown_ot_ext_session_pool(void) {
+    teardown_session_pool();
+    teardown_ot_ext();
+}
+
+static int run_mta_init(void) {
+    static mta_context_t sender_ctx, receiver_ctx;
+    bignum256 a, b;
+
+    random_scalar(&a);
+    random_scalar(&b);
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int run_mta_session(void) {
+    bignum256 a, b;
+
+    random_scalar(&a);
+    random_scalar(&b);
+    mta_context_t *sender_ctx = mta_session_acquire(bench_session_pool, MTA_ROLE_SENDER, &a);
+    mta_context_t *receiver_ctx = mta_session_acquire(bench_session_pool, MTA_ROLE_RECEIVER, &b);
+    int ret = sender_ctx && receiver_ctx ? 0 : -1;
+
+    if (sender_ctx) {
+        mta_session_release(bench_session_pool, sender_ctx);
+    }
+    if (receiver_ctx) {
+        mta_session_release(bench_session_pool, receiver_ctx);
+    }
+    return ret;
+}
+
+static int run_mta_ot_ext_pooled(void) {
+    static uint8_t matrix[MTA_EXT_MATRIX_LEN];
+    static uint8_t corrections[MTA_NUM_BITS][32];
+    bignum256 a, b;
+
+    random_scalar(&a);
+    random_scalar(&b);
+    mta_context_t *sender_ctx = mta_session_acquire(bench_session_pool, MTA_ROLE_SENDER, &a);
+    mta_context_t *receiver_ctx = mta_session_acquire(bench_session_pool, MTA_ROLE_RECEIVER, &b);
+
+    int ret = -1;
+    if (sender_ctx && receiver_ctx &&
+        mta_receiver_ext_choose(receiver_ctx, &bench_ot_receiver, matrix) == 0 &&
+        mta_sender_ext_transfer(sender_ctx, &bench_ot_sender, matrix, corrections) == 0 &&
+        mta_receiver_ext_complete(receiver_ctx, (const uint8_t (*)[32])corrections) == 0) {
+        ret = mta_compute_additive_share(sender_ctx);
+    }
+
+    if (sender_ctx) {
+        mta_session_release(bench_session_pool, sender_ctx);
+    }
+    if (receiver_ctx) {
+        mta_session_release(bench_session_pool, receiver_ctx);
+    }
+    return ret;
+}
+
+// Random OT pools over the OT extension session. The online benchmark
+// refills its pools when they run dry, once every BENCH_ROT_REFILL MtAs:
+// its p50 is the online latency, its throughput includes the offline work
+#define BENCH_ROT_REFILL 64
+static rot_sender_pool_t bench_rot_sender;
+static rot_receiver_pool_t bench_rot_receiver;
+
+static int setup_rot_pool(int threads) {
+    if (setup_ot_ext(threads) != 0 ||
+        rot_sender_pool_init(&bench_rot_sender, BENCH_ROT_REFILL * MTA_NUM_BITS) != 0 ||
+        rot_receiver_pool_init(&bench_rot_receiver, BENCH_ROT_REFILL * MTA_NUM_BITS) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static void teardown_rot_pool(void) {
+    rot_sender_pool_free(&bench_rot_sender);
+    rot_receiver_pool_free(&bench_rot_receiver);
+    teardown_ot_ext();
+}
+
+static int fill_rot_pools(size_t count) {
+    static uint8_t matrix[OT_EXT_MATRIX_LEN(BENCH_ROT_REFILL * MTA_NUM_BITS)];
+
+    if (rot_receiver_pool_fill(&bench_rot_receiver, &bench_ot_receiver, count, matrix) != 0 ||
+        rot_sender_pool_fill(&bench_rot_sender, &bench_ot_sender, matrix, count) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int run_rot_fill(void) {
+    // Each iteration pools and then drops one MtA's worth of random OTs
+    static uint8_t flips[MTA_ROT_FLIPS_LEN], choices[MTA_ROT_FLIPS_LEN];
+    static uint8_t keys[MTA_NUM_BITS][OT_EXT_KEY_LEN];
+    static uint8_t k0[MTA_NUM_BITS][OT_EXT_KEY_LEN], k1[MTA_NUM_BITS][OT_EXT_KEY_LEN];
+    uint64_t first_index;
+
+    if (fill_rot_pools(MTA_NUM_BITS) != 0 ||
+        rot_receiver_pool_derandomize(&bench_rot_receiver, choices, MTA_NUM_BITS,
+                                      &first_index, flips, keys) != 0 ||
+        rot_sender_pool_derandomize(&bench_rot_sender, first_index, flips, MTA_NUM_BITS,
+                                    k0, k1) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int run_mta_rot_online(void) {
+    static mta_context_t sender_ctx, receiver_ctx;
+    static uint8_t corrections[MTA_NUM_BITS][32];
+    uint8_t flips[MTA_ROT_FLIPS_LEN];
+    uint64_t first_index;
+    bignum256 a, b;
+
+    if (rot_receiver_pool_available(&bench_rot_receiver) < MTA_NUM_BITS &&
+        fill_rot_pools(BENCH_ROT_REFILL * MTA_NUM_BITS) != 0) {
+        return -1;
+    }
+
+    random_scalar(&a);
+    random_scalar(&b);
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0 ||
+        mta_receiver_rot_choose(&receiver_ctx, &bench_rot_receiver, &first_index, flips) != 0 ||
+        mta_sender_rot_transfer(&sender_ctx, &bench_rot_sender, first_index, flips,
+                                corrections) != 0 ||
+        mta_receiver_ext_complete(&receiver_ctx, (const uint8_t (*)[32])corrections) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Batched and independent MtAs spread over the worker pool. For mta/batch
+// shard t runs its share of the BENCH_MTA_BATCH instances as one batch on
+// its own OT extension session (a session extends one batch at a time);
+// mta/parallel runs BENCH_MTA_PARALLEL three-flow MtAs side by side
+typedef struct {
+    ot_ext_sender_t ot_sender;
+    ot_ext_receiver_t ot_receiver;
+} bench_session_pair_t;
+
+static bench_session_pair_t *bench_sessions;
+static int bench_num_sessions;
+
+static int setup_mta_batch(int threads) {
+    static OT_SenderMessage base_msgs[OT_EXT_KAPPA];
+    static OT_ReceiverMessage base_responses[OT_EXT_KAPPA];
+
+    if (setup_mta_per_bit(threads) != 0) {
+        return -1;
+    }
+    bench_sessions = calloc((size_t)threads, sizeof(bench_session_pair_t));
+    if (!bench_sessions) {
+        return -1;
+    }
+    bench_num_sessions = threads;
+
+    for (int t = 0; t < threads; t++) {
+        if (ot_ext_receiver_setup(&bench_sessions[t].ot_receiver, base_msgs) != 0 ||
+            ot_ext_sender_setup(&bench_sessions[t].ot_sender, base_msgs, base_responses) != 0 ||
+            ot_ext_receiver_setup_complete(&bench_sessions[t].ot_receiver, base_responses) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void teardown_mta_batch(void) {
+    for (int t = 0; bench_sessions && t < bench_num_sessions; t++) {
+        ot_ext_sender_clear(&bench_sessions[t].ot_sender);
+        ot_ext_receiver_clear(&bench_sessions[t].ot_receiver);
+    }
+    free(bench_sessions);
+    bench_sessions = NULL;
+    bench_num_sessions = 0;
+    teardown_mta_per_bit();
+}
+
+// Instances [begin, end) of the BENCH_MTA_BATCH that shard t of n runs
+static void bench_shard_range(size_t t, size_t *begin, size_t *end) {
+    size_t n = (size_t)bench_num_sessions;
+    *begin = t * BENCH_MTA_BATCH / n;
+    *end = (t + 1) * BENCH_MTA_BATCH / n;
+}
+
+static int run_mta_batch_shard(void *arg, size_t begin, size_t end) {
+    (void)arg;
+    for (size_t t = begin; t < end; t++) {
+        size_t first, last;
+        bench_shard_range(t, &first, &last);
+        size_t count = last - first;
+        if (count == 0) {
+            continue;
+        }
+
+        uint8_t *matrix = malloc(MTA_BATCH_MATRIX_LEN(count));
+        uint8_t *corrections = malloc(MTA_BATCH_CORRECTIONS_LEN(count));
+        bignum256 a[BENCH_MTA_BATCH], b[BENCH_MTA_BATCH];
+        mta_batch_t sender_batch, receiver_batch;
+        int ret = matrix && corrections ? 0 : -1;
+
+        for (size_t k = 0; k < count; k++) {
+            random_scalar(&a[k]);
+            random_scalar(&b[k]);
+        }
+        if (ret == 0 && mta_batch_init(&sender_batch, MTA_ROLE_SENDER, a, count) != 0) {
+            ret = -1;
+        } else if (ret == 0 &&
+                   mta_batch_init(&receiver_batch, MTA_ROLE_RECEIVER, b, count) != 0) {
+            mta_batch_free(&sender_batch);
+            ret = -1;
+        } else if (ret == 0) {
+            bench_session_pair_t *session = &bench_sessions[t];
+            if (mta_batch_receiver_choose(&receiver_batch, &session->ot_receiver, matrix) != 0 ||
+                mta_batch_sender_transfer(&sender_batch, &session->ot_sender, matrix,
+                                          corrections) != 0 ||
+                mta_batch_receiver_complete(&receiver_batch, corrections) != 0) {
+                ret = -1;
+            }
+            mta_batch_free(&sender_batch);
+            mta_batch_free(&receiver_batch);
+        }
+
+        free(matrix);
+        free(corrections);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+static int run_mta_batch(void) {
+    return thread_pool_run(&bench_pool, (size_t)bench_num_sessions, run_mta_batch_shard, NULL);
+}
+
+// Buffers of one shard of independent three-flow MtAs
+typedef struct {
+    mta_context_t sender_ctx, receiver_ctx;
+    OT_SenderMessage sender_msgs[MTA_NUM_BITS];
+    OT_ReceiverMessage receiver_msgs[MTA_NUM_BITS];
+    uint8_t c0[MTA_NUM_BITS][32], c1[MTA_NUM_BITS][32];
+} bench_rounds_t;
+
+static int run_mta_parallel_shard(void *arg, size_t begin, size_t end) {
+    (void)arg;
+    bench_rounds_t *r = malloc(sizeof(bench_rounds_t));
+    if (!r) {
+        return -1;
+    }
+
+    int ret = 0;
+    for (size_t k = begin; k < end && ret == 0; k++) {
+        bignum256 a, b;
+        random_scalar(&a);
+        random_scalar(&b);
+        if (mta_init(&r->sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+            mta_init(&r->receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0 ||
+            mta_sender_round1(&r->sender_ctx, r->sender_msgs) != 0 ||
+            mta_receiver_round1(&r->receiver_ctx, r->sender_msgs, r->receiver_msgs) != 0 ||
+            mta_sender_round2(&r->sender_ctx, r->receiver_msgs, r->c0, r->c1) != 0 ||
+            mta_receiver_round2(&r->receiver_ctx, (const uint8_t (*)[32])r->c0,
+                                (const uint8_t (*)[32])r->c1) != 0) {
+            ret = -1;
+        }
+    }
+
+    free(r);
+    return ret;
+}
+
+static int run_mta_parallel(void) {
+    return thread_pool_run(&bench_pool, BENCH_MTA_PARALLEL, run_mta_parallel_shard, NULL);
+}
+
+static int run_mta_compact(void) {
+    mta_compact_t sender_ctx, receiver_ctx;
+    bignum256 a, b;
+
+    random_scalar(&a);
+    random_scalar(&b);
+    if (mta_compact_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_compact_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < MTA_NUM_BITS; i++) {
+        OT_SenderMessage sender_msg;
+        OT_ReceiverMessage receiver_msg;
+        uint8_t c0[32], c1[32];
+        if (mta_compact_sender_bit_message(&sender_ctx, i, &sender_msg) != 0 ||
+            mta_compact_receiver_bit_response(&receiver_ctx, i, &sender_msg, &receiver_msg) != 0 ||
+            mta_compact_sender_bit_complete(&sender_ctx, i, &receiver_msg, c0, c1) != 0 ||
+            mta_compact_receiver_bit_complete(&receiver_ctx, i, c0, c1) != 0) {
+            return -1;
+        }
+    }
+
+    mta_compact_clear(&sender_ctx);
+    mta_compact_clear(&receiver_ctx);
+    return 0;
+}
+
+// Two parties in two threads, the receiver's end served by a fresh thread
+// per iteration
+static transport_t bench_sender_end, bench_receiver_end;
+static mta_context_t bench_party_receiver;
+static int bench_party_pipelined;
+
+// Window and chunk of the pipelined benchmarks
+#define BENCH_PIPELINE_WINDOW 64
+#define BENCH_PIPELINE_CHUNK 16
+
+static int setup_party_loopback(int threads) {
+    (void)threads;
+    return transport_loopback_pair(&bench_sender_end, &bench_receiver_end);
+}
+
+static int setup_party_socketpair(int threads) {
+    (void)threads;
+    return transport_socketpair(&bench_sender_end, &bench_receiver_end);
+}
+
+static int setup_party_tcp(int threads) {
+    (void)threads;
+    return transport_tcp_pair(&bench_sender_end, &bench_receiver_end);
+}
+
+static void teardown_party(void) {
+    transport_close(&bench_sender_end);
+    transport_close(&bench_receiver_end);
+}
+
+static void *party_receiver_main(void *arg) {
+    if (bench_party_pipelined) {
+        *(int *)arg = mta_party_run_receiver_pipelined(&bench_party_receiver,
+                                                       &bench_receiver_end, 0);
+    } else {
+        *(int *)arg = mta_party_run_receiver(&bench_party_receiver, &bench_receiver_end,
+                                             NULL, 0);
+    }
+    return NULL;
+}
+
+static int run_two_party(void) {
+    static mta_context_t sender_ctx;
+    bignum256 a, b;
+
+    random_scalar(&a);
+    random_scalar(&b);
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&bench_party_receiver, MTA_ROLE_RECEIVER, &b) != 0) {
+        return -1;
+    }
+
+    pthread_t thread;
+    int receiver_ret = -1;
+    if (pthread_create(&thread, NULL, party_receiver_main, &receiver_ret) != 0) {
+        return -1;
+    }
+    int ret;
+    if (bench_party_pipelined) {
+        ret = mta_party_run_sender_pipelined(&sender_ctx, &bench_sender_end, 0,
+                                             BENCH_PIPELINE_WINDOW, BENCH_PIPELINE_CHUNK);
+    } else {
+        ret = mta_party_run_sender(&sender_ctx, &bench_sender_end, NULL, 0);
+    }
+    pthread_join(thread, NULL);
+
+    return ret != 0 ? ret : receiver_ret;
+}
+
+static int run_mta_two_party(void) {
+    bench_party_pipelined = 0;
+    return run_two_party();
+}
+
+static int run_mta_pipelined(void) {
+    bench_party_pipelined = 1;
+    return run_two_party();
+}
+
+static const bench_t benchmarks[] = {
+    { "point/opt_scalar_multiply", 1, 0, setup_point, run_scalar_multiply, NULL },
+    { "point/opt_point_multiply", 1, 0, setup_point, run_point_multiply, NULL },
+    { "point/opt_point_multiply_ct", 1, 0, setup_point, run_point_multiply_ct, NULL },
+    { "point/opt_multi_point_multiply_2", 2, 0, setup_point, run_multi_point_multiply, NULL },
+    { "sha256/raw_65", 1, 0, NULL, run_sha256_raw, NULL },
+    { "sha256/raw_x8_65", 8, 0, NULL, run_sha256_raw_x8, NULL },
+    { "kdf/crh_sha256", BENCH_KDF_ROWS, 0, NULL, run_kdf_crh_sha256, NULL },
+    { "kdf/crh_blake2s", BENCH_KDF_ROWS, 0, NULL, run_kdf_crh_blake2s, NULL },
+    { "kdf/crh_aes", BENCH_KDF_ROWS, 0, NULL, run_kdf_crh_aes, NULL },
+    { "base_ot/init_sender", 1, 0, setup_base_ot, run_base_ot_init_sender, NULL },
+    { "base_ot/receiver_choice", 1, 0, setup_base_ot, run_base_ot_receiver_choice, NULL },
+    { "base_ot/sender_keys", 1, 0, setup_base_ot, run_base_ot_sender_keys, NULL },
+    { "base_ot/batch", BENCH_BASE_OT_BATCH, 0, NULL, run_base_ot_batch, NULL },
+    { "base_ot/batch_curve25519", BENCH_BASE_OT_BATCH, 0, setup_curve25519, run_base_ot_batch,
+      teardown_curve25519 },
+    { "cot/transfer", 1, 0, setup_base_ot, run_cot_transfer, NULL },
+    { "ot_ext/setup", OT_EXT_KAPPA, 0, NULL, run_ot_ext_setup, teardown_ot_ext },
+    { "ot_ext/extend", MTA_NUM_BITS, 0, setup_ot_ext, run_ot_ext_extend, teardown_ot_ext },
+    { "ot_ext/extend_blake2s", MTA_NUM_BITS, 0, setup_ot_ext_blake2s, run_ot_ext_extend,
+      teardown_ot_ext_kdf },
+    { "ot_ext/extend_aes", MTA_NUM_BITS, 0, setup_ot_ext_aes, run_ot_ext_extend,
+      teardown_ot_ext_kdf },
+    { "rot/fill", MTA_NUM_BITS, 0, setup_rot_pool, run_rot_fill, teardown_rot_pool },
+    { "mta/per_bit", 1, 1, setup_mta_per_bit, run_mta_per_bit, teardown_mta_per_bit },
+    { "mta/compact", 1, 0, NULL, run_mta_compact, NULL },
+    { "mta/rounds", 1, 0, NULL, run_mta_rounds, NULL },
+    { "mta/rounds_simplest", 1, 0, NULL, run_mta_rounds_simplest, NULL },
+    { "mta/rounds_curve25519", 1, 0, setup_curve25519, run_mta_rounds, teardown_curve25519 },
+    { "mta/rounds_simplest_curve25519", 1, 0, setup_curve25519, run_mta_rounds_simplest,
+      teardown_curve25519 },
+    { "mta/rot_online", 1, 0, setup_rot_pool, run_mta_rot_online, teardown_rot_pool },
+    { "mta/init", 1, 0, NULL, run_mta_init, NULL },
+    { "mta/session", 1, 0, setup_session_pool, run_mta_session, teardown_session_pool },
+    { "mta/ot_ext", 1, 0, setup_ot_ext, run_mta_ot_ext, teardown_ot_ext },
+    { "mta/ot_ext_pooled", 1, 0, setup_ot_ext_session_pool, run_mta_ot_ext_pooled,
+      teardown_ot_ext_session_pool },
+    { "mta/batch", BENCH_MTA_BATCH, 1, setup_mta_batch, run_mta_batch, teardown_mta_batch },
+    { "mta/parallel", BENCH_MTA_PARALLEL, 1, setup_mta_per_bit, run_mta_parallel,
+      teardown_mta_per_bit },
+    { "mta/two_party_loopback", 1, 0, setup_party_loopback, run_mta_two_party, teardown_party },
+    { "mta/two_party_socketpair", 1, 0, setup_party_socketpair, run_mta_two_party, teardown_party },
+    { "mta/two_party_tcp", 1, 0, setup_party_tcp, run_mta_two_party, teardown_party },
+    { "mta/pipelined_loopback", 1, 0, setup_party_loopback, run_mta_pipelined, teardown_party },
+    { "mta/pipelined_socketpair", 1, 0, setup_party_socketpair, run_mta_pipelined, teardown_party },
+    { "mta/pipelined_tcp", 1, 0, setup_party_tcp, run_mta_pipelined, teardown_party },
+};
+
+static int run_benchmark(const bench_t *bench, int threads, const bench_options_t *opts,
+                         double *samples, bench_result_t *result) {
+    if (bench->setup && bench->setup(threads) != 0) {
+        fprintf(stderr, "Setup of %s failed\n", bench->name);
+        return -1;
+    }
+
+    int ret = bench->run();  // Warm-up, also checks the benchmark works
+    size_t n = 0;
+    double total = 0.0;
+
+    while (ret == 0 && n < BENCH_MAX_ITERS &&
+           (n < opts->min_iters || total < opts->min_time * 1e9)) {
+        double start = now_ns();
+        ret = bench->run();
+        samples[n] = now_ns() - start;
+        total += samples[n];
+        n++;
+    }
+
+    if (bench->teardown) {
+        bench->teardown();
+    }
+    if (ret != 0) {
+        fprintf(stderr, "Benchmark %s failed\n", bench->name);
+        return -1;
+    }
+
+    qsort(samples, n, sizeof(double), compare_double);
+
+    memset(result, 0, sizeof(bench_result_t));
+    if (bench->uses_threads) {
+        snprintf(result->name, sizeof(result->name), "%s/threads:%d", bench->name, threads);
+    } else {
+        snprintf(result->name, sizeof(result->name), "%s", bench->name);
+    }
+    result->threads = threads;
+    result->iterations = n;
+    result->total_ns = total;
+    result->mean_ns = total / n;
+    result->p50_ns = percentile(samples, n, 50.0);
+    result->p99_ns = percentile(samples, n, 99.0);
+    result->ops_per_sec = 1e9 * n / total;
+    result->items_per_sec = result->ops_per_sec * bench->items;
+
+    return 0;
+}
+
+static void print_result(const bench_result_t *r, bench_format_t format, int first) {
+    if (format == FORMAT_CSV) {
+        printf("%s,%d,%zu,%.0f,%.0f,%.0f,%.3f,%.3f\n", r->name, r->threads, r->iterations,
+               r->mean_ns, r->p50_ns, r->p99_ns, r->ops_per_sec, r->items_per_sec);
+    } else {
+        printf("%s    {\n", first ? "" : ",\n");
+        printf("      \"name\": \"%s\",\n", r->name);
+        printf("      \"threads\": %d,\n", r->threads);
+        printf("      \"iterations\": %zu,\n", r->iterations);
+        printf("      \"mean_ns\": %.0f,\n", r->mean_ns);
+        printf("      \"p50_ns\": %.0f,\n", r->p50_ns);
+        printf("      \"p99_ns\": %.0f,\n", r->p99_ns);
+        printf("      \"ops_per_sec\": %.3f,\n", r->ops_per_sec);
+        printf("      \"items_per_sec\": %.3f\n", r->items_per_sec);
+        printf("    }");
+    }
+    fflush(stdout);
+}
+
+static int parse_threads(const char *arg, bench_options_t *opts) {
+    opts->num_thread_counts = 0;
+    while (*arg) {
+        char *end;
+        long t = strtol(arg, &end, 10);
+        if (end == arg || t < 1 || t > THREAD_POOL_MAX_THREADS ||
+            opts->num_thread_counts == BENCH_MAX_THREAD_COUNTS) {
+            return -1;
+        }
+        opts->thread_counts[opts->num_thread_counts++] = (int)t;
+        arg = *end == ',' ? end + 1 : end;
+    }
+    return opts->num_thread_counts > 0 ? 0 : -1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--format json|csv] [--filter SUBSTRING] "
+                    "[--threads 1,2,4] [--min-time SECONDS] [--min-iters N]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    bench_options_t opts = {
+        .format = FORMAT_JSON,
+        .filter = NULL,
+        .min_time = 0.5,
+        .min_iters = 3,
+        .thread_counts = {1, 2, 4},
+        .num_thread_counts = 3,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!strcmp(argv[i], "--format") && value) {
+            if (!strcmp(value, "json")) {
+                opts.format = FORMAT_JSON;
+            } else if (!strcmp(value, "csv")) {
+                opts.format = FORMAT_CSV;
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--filter") && value) {
+            opts.filter = value;
+        } else if (!strcmp(argv[i], "--threads") && value) {
+            if (parse_threads(value, &opts) != 0) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--min-time") && value) {
+            opts.min_time = atof(value);
+        } else if (!strcmp(argv[i], "--min-iters") && value) {
+            opts.min_iters = strtoul(value, NULL, 10);
+            if (opts.min_iters < 1) {
+                opts.min_iters = 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+
+    srand(time(NULL));
+    random_reseed(rand());
+
+    // Only errors are reported, nothing is written to a log file
+    logger_init(LOG_ERROR, NULL, LOG_NONE);
+
+    double *samples = malloc(BENCH_MAX_ITERS * sizeof(double));
+    if (!samples) {
+        fprintf(stderr, "Failed to allocate samples\n");
+        return 1;
+    }
+
+    if (opts.format == FORMAT_CSV) {
+        printf("name,threads,iterations,mean_ns,p50_ns,p99_ns,ops_per_sec,items_per_sec\n");
+    } else {
+        printf("{\n  \"context\": {\n");
+        printf("    \"date\": %ld,\n", (long)time(NULL));
+        printf("    \"min_time\": %.3f,\n", opts.min_time);
+        printf("    \"min_iters\": %zu\n", opts.min_iters);
+        printf("  },\n  \"benchmarks\": [\n");
+    }
+
+    int status = 0, first = 1;
+    size_t num_benchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    for (size_t b = 0; b < num_benchmarks; b++) {
+        const bench_t *bench = &benchmarks[b];
+        if (opts.filter && !strstr(bench->name, opts.filter)) {
+            continue;
+        }
+
+        int runs = bench->uses_threads ? opts.num_thread_counts : 1;
+        for (int t = 0; t < runs; t++) {
+            int threads = bench->uses_threads ? opts.thread_counts[t] : 1;
+            bench_result_t result;
+            if (run_benchmark(bench, threads, &opts, samples, &result) != 0) {
+                status = 1;
+                continue;
+            }
+            print_result(&result, opts.format, first);
+            first = 0;
+        }
+    }
+
+    if (opts.format == FORMAT_JSON) {
+        printf("\n  ]\n}\n");
+    }
+
+    logger_close();
+    free(samples);
+    return status;
+}
@@ -719,12 +719,144 @@ void bn_reduce(bignum512 *x, const bignum256 *prime) {
   }
 }
 
+#if USE_BN_INT128
+// Multiplication modulo the two secp256k1 moduli with 64-bit limbs.
+// Both are pseudo-Mersenne: prime = 2**256 - c with c small, so a product is
+// reduced by folding: hi * 2**256 + lo == hi * c + lo (mod prime).
+
+typedef unsigned __int128 uint128_t;
+
+// secp256k1 field prime p = 2**256 - 0x1000003d1
+static const bignum256 bn_secp256k1_p = {
+    {0x1ffffc2f, 0x1ffffff7, 0x1fffffff, 0x1fffffff, 0x1fffffff, 0x1fffffff,
+     0x1fffffff, 0x1fffffff, 0xffffff}};
+static const uint64_t bn_secp256k1_p_c[3] = {0x1000003d1ULL, 0, 0};
+
+// secp256k1 group order n = 2**256 - 0x14551231950b75fc4402da1732fc9bebf
+static const bignum256 bn_secp256k1_n = {
+    {0x10364141, 0x1e92f466, 0x12280eef, 0x1db9cd5e, 0x1fffebaa, 0x1fffffff,
+     0x1fffffff, 0x1fffffff, 0xffffff}};
+static const uint64_t bn_secp256k1_n_c[3] = {0x402da1732fc9bebfULL,
+                                             0x4551231950b75fc4ULL, 1};
+
+// Converts a normalized x (x < 2**261) to 5 limbs of 64 bits
+static inline void bn_to_u64(const bignum256 *x, uint64_t res[5]) {
+  res[0] = (uint64_t)x->val[0] | (uint64_t)x->val[1] << 29 |
+           (uint64_t)x->val[2] << 58;
+  res[1] = (uint64_t)x->val[2] >> 6 | (uint64_t)x->val[3] << 23 |
+           (uint64_t)x->val[4] << 52;
+  res[2] = (uint64_t)x->val[4] >> 12 | (uint64_t)x->val[5] << 17 |
+           (uint64_t)x->val[6] << 46;
+  res[3] = (uint64_t)x->val[6] >> 18 | (uint64_t)x->val[7] << 11 |
+           (uint64_t)x->val[8] << 40;
+  res[4] = (uint64_t)x->val[8] >> 24;
+}
+
+// Converts x < 2**256 from 4 limbs of 64 bits to a normalized bignum256
+static inline void bn_from_u64(const uint64_t x[4], bignum256 *res) {
+  res->val[0] = x[0] & BN_LIMB_MASK;
+  res->val[1] = (x[0] >> 29) & BN_LIMB_MASK;
+  res->val[2] = (x[0] >> 58 | x[1] << 6) & BN_LIMB_MASK;
+  res->val[3] = (x[1] >> 23) & BN_LIMB_MASK;
+  res->val[4] = (x[1] >> 52 | x[2] << 12) & BN_LIMB_MASK;
+  res->val[5] = (x[2] >> 17) & BN_LIMB_MASK;
+  res->val[6] = (x[2] >> 46 | x[3] << 18) & BN_LIMB_MASK;
+  res->val[7] = (x[3] >> 11) & BN_LIMB_MASK;
+  res->val[8] = x[3] >> 40;
+}
+
+// x = x[0..3] + x[4..4+hi_limbs) * c, with c of c_limbs limbs
+// Assumes the result fits in len limbs and x[4+hi_limbs..len) are zero
+static inline void bn_u64_fold(uint64_t *x, int len, int hi_limbs,
+                               const uint64_t *c, int c_limbs) {
+  uint64_t hi[6] = {0};
+
+  for (int i = 0; i < hi_limbs; i++) {
+    hi[i] = x[4 + i];
+    x[4 + i] = 0;
+  }
+
+  for (int i = 0; i < hi_limbs; i++) {
+    uint128_t carry = 0;
+    for (int j = 0; j < c_limbs; j++) {
+      uint128_t m = (uint128_t)hi[i] * c[j] + x[i + j] + carry;
+      x[i + j] = (uint64_t)m;
+      carry = m >> 64;
+    }
+    for (int j = i + c_limbs; j < len; j++) {
+      uint128_t m = (uint128_t)x[j] + carry;
+      x[j] = (uint64_t)m;
+      carry = m >> 64;
+    }
+  }
+}
+
+// x = k * x % prime for prime = 2**256 - c with c < 2**129
+// Same contract as bn_multiply, the result is below 2**256 < 2 * prime
+static inline void bn_multiply_u64(const bignum256 *k, bignum256 *x,
+                                   const uint64_t *c, int c_limbs) {
+  uint64_t a[5] = {0}, b[5] = {0}, r[10] = {0};
+
+  bn_to_u64(k, a);
+  bn_to_u64(x, b);
+
+  // 5x5 schoolbook multiplication, r < 2**522
+  for (int i = 0; i < 5; i++) {
+    uint128_t carry = 0;
+    for (int j = 0; j < 5; j++) {
+      uint128_t m = (uint128_t)a[i] * b[j] + r[i + j] + carry;
+      r[i + j] = (uint64_t)m;
+      carry = m >> 64;
+    }
+    r[i + 5] = (uint64_t)carry;
+  }
+
+  // Each fold shrinks the part above 2**256 by 256 - log2(c) bits, the last
+  // one only absorbs the carry of the one before
+  bn_u64_fold(r, 4 + c_limbs + 3, 5, c, c_limbs);
+  if (c_limbs > 1) {
+    bn_u64_fold(r, 4 + c_limbs, 3, c, c_limbs);
+  }
+  bn_u64_fold(r, 5, 1, c, c_limbs);
+  bn_u64_fold(r, 5, 1, c, c_limbs);
+
+  bn_from_u64(r, x);
+
+  memzero(a, sizeof(a));
+  memzero(b, sizeof(b));
+  memzero(r, sizeof(r));
+}
+
+// Returns 1 and computes x = k * x % prime if prime has a 64-bit path
+static int bn_multiply_int128(const bignum256 *k, bignum256 *x,
+                              const bignum256 *prime) {
+  // The lowest limb tells the two moduli apart, the full check is only done
+  // on a match
+  if (prime->val[0] == bn_secp256k1_p.val[0] &&
+      bn_is_equal(prime, &bn_secp256k1_p)) {
+    bn_multiply_u64(k, x, bn_secp256k1_p_c, 1);
+    return 1;
+  }
+  if (prime->val[0] == bn_secp256k1_n.val[0] &&
+      bn_is_equal(prime, &bn_secp256k1_n)) {
+    bn_multiply_u64(k, x, bn_secp256k1_n_c, 3);
+    return 1;
+  }
+  return 0;
+}
+#endif
+
 // x = k * x % prime
 // Assumes k, x are normalized, k * x < 2**519
 // Guarantees x is normalized and partly reduced modulo prime
 // Assumes prime is normalized, 2**256 - 2**224 <= prime <= 2**256
 void bn_multiply(const bignum256 *k, bignum256 *x, const bignum256 *prime) {
   bignum512 res = {0};
+#if USE_BN_INT128
+  if (bn_multiply_int128(k, x, prime)) {
+    return;
+  }
+#endif
 
   bn_multiply_long(k, x, &res);
   bn_reduce(&res, prime);
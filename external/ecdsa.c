@@ -168,10 +168,6 @@ int point_is_negative_of(const curve_point *p, const curve_point *q) {
   return !bn_is_equal(&(p->y), &(q->y));
 }
 
-typedef struct jacobian_curve_point {
-  bignum256 x, y, z;
-} jacobian_curve_point;
-
 // generate random K for signing/side-channel noise
 static void generate_k_random(bignum256 *k, const bignum256 *prime) {
   do {
@@ -218,6 +214,66 @@ void jacobian_to_curve(const jacobian_curve_point *jp, curve_point *p,
   bn_mod(&p->y, prime);
 }
 
+// Converts n jacobian points to affine with a single inversion
+// (Montgomery's trick). Points with z == 0 become the point at infinity.
+// out[i].x is used to hold prefix products until it is overwritten.
+void jacobian_batch_to_affine(const jacobian_curve_point *points,
+                              curve_point *out, size_t n,
+                              const bignum256 *prime) {
+  bignum256 acc = {0}, inv = {0}, z = {0}, zinv = {0}, zinv2 = {0};
+
+  if (n == 0) {
+    return;
+  }
+
+  // out[i].x = z_0 * ... * z_{i-1}
+  bn_one(&acc);
+  for (size_t i = 0; i < n; i++) {
+    out[i].x = acc;
+    z = points[i].z;
+    bn_mod(&z, prime);
+    if (!bn_is_zero(&z)) {
+      bn_multiply(&z, &acc, prime);
+    }
+  }
+
+  // inv = 1 / (z_0 * ... * z_{n-1})
+  inv = acc;
+  bn_mod(&inv, prime);
+  bn_inverse(&inv, prime);
+
+  for (size_t i = n; i-- > 0;) {
+    z = points[i].z;
+    bn_mod(&z, prime);
+    if (bn_is_zero(&z)) {
+      point_set_infinity(&out[i]);
+      continue;
+    }
+
+    // zinv = 1 / z_i, then strip z_i from inv
+    zinv = out[i].x;
+    bn_multiply(&inv, &zinv, prime);
+    bn_multiply(&z, &inv, prime);
+
+    zinv2 = zinv;
+    bn_multiply(&zinv2, &zinv2, prime);
+    // zinv = z^-3
+    bn_multiply(&zinv2, &zinv, prime);
+
+    out[i].x = points[i].x;
+    bn_multiply(&zinv2, &out[i].x, prime);
+    out[i].y = points[i].y;
+    bn_multiply(&zinv, &out[i].y, prime);
+    bn_mod(&out[i].x, prime);
+    bn_mod(&out[i].y, prime);
+  }
+
+  memzero(&acc, sizeof(acc));
+  memzero(&inv, sizeof(inv));
+  memzero(&zinv, sizeof(zinv));
+  memzero(&zinv2, sizeof(zinv2));
+}
+
 void point_jacobian_add(const curve_point *p1, jacobian_curve_point *p2,
                         const ecdsa_curve *curve) {
   bignum256 r = {0}, h = {0}, r2 = {0};
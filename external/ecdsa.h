@@ -48,6 +48,11 @@ typedef struct {
 
 } ecdsa_curve;
 
+// curve point in jacobian coordinates (x/z^2, y/z^3)
+typedef struct jacobian_curve_point {
+  bignum256 x, y, z;
+} jacobian_curve_point;
+
 // 4 byte prefix + 40 byte data (segwit)
 // 1 byte prefix + 64 byte data (cashaddr)
 #define MAX_ADDR_RAW_SIZE 65
@@ -67,6 +72,16 @@ void point_add(const ecdsa_curve *curve, const curve_point *cp1,
 void point_double(const ecdsa_curve *curve, curve_point *cp);
 int point_multiply(const ecdsa_curve *curve, const bignum256 *k,
                    const curve_point *p, curve_point *res);
+void curve_to_jacobian(const curve_point *p, jacobian_curve_point *jp,
+                       const bignum256 *prime);
+void jacobian_to_curve(const jacobian_curve_point *jp, curve_point *p,
+                       const bignum256 *prime);
+void jacobian_batch_to_affine(const jacobian_curve_point *points,
+                              curve_point *out, size_t n,
+                              const bignum256 *prime);
+void point_jacobian_add(const curve_point *p1, jacobian_curve_point *p2,
+                        const ecdsa_curve *curve);
+void point_jacobian_double(jacobian_curve_point *p, const ecdsa_curve *curve);
 void point_set_infinity(curve_point *p);
 int point_is_infinity(const curve_point *p);
 int point_is_equal(const curve_point *p, const curve_point *q);
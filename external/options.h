@@ -49,6 +49,24 @@
 #define USE_INVERSE_FAST 1
 #endif
 
+// use 64-bit limbs and unsigned __int128 in bn_multiply when the modulus is
+// the secp256k1 field prime or group order (needs a 64-bit compiler)
+#ifndef USE_BN_INT128
+#define USE_BN_INT128 0
+#endif
+
+// x86 SHA-256: the SHA extensions in sha256_Transform and AVX2 in
+// sha256_Raw_x8, each picked at run time when the CPU supports it
+#ifndef USE_SHA2_X86
+#define USE_SHA2_X86 0
+#endif
+
+// AES-NI in the AES kdf backend (src/kdf.c), picked at run time when the
+// CPU supports it
+#ifndef USE_AES_NI
+#define USE_AES_NI 0
+#endif
+
 // support for printing bignum256 structures via printf
 #ifndef USE_BN_PRINT
 #define USE_BN_PRINT 0
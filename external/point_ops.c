@@ -1,79 +1,522 @@
 #include <string.h>
+#if !USE_PRECOMPUTED_CP
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+#include "memzero.h"
 #include "point_ops.h"
 
-// Number of bits in the window
-#define WINDOW_SIZE 4
-// Number of precomputed points (2^WINDOW_SIZE)
-#define PRECOMP_SIZE (1 << WINDOW_SIZE)
+// Width of the signed digits used for variable-base multiplication
+#define WNAF_WINDOW 5
+// Number of precomputed odd multiples P, 3P, ..., 15P
+#define ODD_TABLE_SIZE (1 << (WNAF_WINDOW - 2))
 
-int opt_scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *res) {
-    // Use 4-bit window for efficiency (16 precomputed points)
-    curve_point precomp[PRECOMP_SIZE];
+// table[i] = (2i + 1) * p, in affine coordinates.
+// Built in Jacobian coordinates and converted with one shared inversion.
+static void precompute_odd_multiples(const ecdsa_curve *curve, const curve_point *p,
+                                     curve_point table[ODD_TABLE_SIZE]) {
+    curve_point p2;
+    point_copy(p, &p2);
+    point_double(curve, &p2);
+
+    jacobian_curve_point jtable[ODD_TABLE_SIZE];
+    curve_to_jacobian(p, &jtable[0], &curve->prime);
+    for (int i = 1; i < ODD_TABLE_SIZE; i++) {
+        jtable[i] = jtable[i - 1];
+        point_jacobian_add(&p2, &jtable[i], curve);
+    }
+
+    jacobian_batch_to_affine(jtable, table, ODD_TABLE_SIZE, &curve->prime);
+}
+
+// Jacobian representation of the point at infinity
+static void jacobian_set_infinity(jacobian_curve_point *jp) {
+    bn_zero(&jp->x);
+    bn_zero(&jp->y);
+    bn_zero(&jp->z);
+}
+
+// res = jp in affine coordinates, handling the point at infinity
+static void jacobian_to_affine(const ecdsa_curve *curve, jacobian_curve_point *jp,
+                               curve_point *res) {
+    bn_mod(&jp->z, &curve->prime);
+    if (bn_is_zero(&jp->z)) {
+        point_set_infinity(res);
+    } else {
+        jacobian_to_curve(jp, res, &curve->prime);
+    }
+}
+
+// out = table[index] without a secret-dependent memory access pattern
+static void select_odd_multiple(const curve_point table[ODD_TABLE_SIZE], uint32_t index,
+                                curve_point *out) {
+    point_copy(&table[0], out);
+    for (uint32_t i = 1; i < ODD_TABLE_SIZE; i++) {
+        uint32_t eq = (((i ^ index) - 1) >> 31) & 1;
+        bn_cmov(&out->x, eq, &table[i].x, &out->x);
+        bn_cmov(&out->y, eq, &table[i].y, &out->y);
+    }
+}
+
+// Bits [bit, bit + count) of a little-endian 256-bit scalar, count <= WNAF_WINDOW
+static uint32_t scalar_bits(const uint32_t words[8], int bit, int count) {
+    uint32_t value = 0;
+    for (int j = 0; j < count && bit + j < 256; j++) {
+        value |= ((words[(bit + j) >> 5] >> ((bit + j) & 31)) & 1) << j;
+    }
+    return value;
+}
+
+// Recode k into width-WNAF_WINDOW NAF: k = sum(wnaf[i] * 2^i), every nonzero
+// digit is odd with |digit| < 2^(WNAF_WINDOW - 1).
+// Returns the number of digits up to and including the highest nonzero one.
+static int scalar_to_wnaf(const bignum256 *k, int8_t wnaf[257]) {
+    uint8_t bytes[32];
+    uint32_t words[8];
+    bn_write_le(k, bytes);
+    for (int i = 0; i < 8; i++) {
+        words[i] = read_le(bytes + 4 * i);
+    }
+
+    memset(wnaf, 0, 257);
+
+    int carry = 0, len = 0;
+    for (int bit = 0; bit < 256;) {
+        if ((int)scalar_bits(words, bit, 1) == carry) {
+            bit++;
+            continue;
+        }
+
+        int word = (int)scalar_bits(words, bit, WNAF_WINDOW) + carry;
+        carry = (word >> (WNAF_WINDOW - 1)) & 1;
+        word -= carry << WNAF_WINDOW;
+
+        wnaf[bit] = (int8_t)word;
+        len = bit + 1;
+        bit += WNAF_WINDOW;
+    }
+    if (carry) {
+        wnaf[256] = 1;
+        len = 257;
+    }
+
+    memzero(bytes, sizeof(bytes));
+    memzero(words, sizeof(words));
+    return len;
+}
+
+// out = digit * P for an odd digit, looked up in the odd multiples table
+static void wnaf_entry(const ecdsa_curve *curve, const curve_point table[ODD_TABLE_SIZE],
+                       int digit, curve_point *out) {
+    if (digit > 0) {
+        point_copy(&table[(digit - 1) / 2], out);
+    } else {
+        point_copy(&table[(-digit - 1) / 2], out);
+        bn_subtract(&curve->prime, &out->y, &out->y);
+    }
+}
+
+int opt_point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, curve_point *res) {
+    // Copy scalar and reduce modulo curve order
     bignum256 k_reduced;
-    
-    // Make a copy of k and reduce it modulo curve order
     bn_copy(k, &k_reduced);
     bn_mod(&k_reduced, &curve->order);
-    
-    // Precompute multiples of G: G, 2G, 3G, ..., 15G
-    point_set_infinity(&precomp[0]);
-    point_copy(&curve->G, &precomp[1]);
-    
-    for (int i = 2; i < PRECOMP_SIZE; i++) {
-        point_copy(&precomp[i-1], &precomp[i]);
-        point_add(curve, &curve->G, &precomp[i]);
-    }
-    
-    // Start with infinity
-    point_set_infinity(res);
-    
-    // Process scalar from most significant bit to least significant
-    // (Right-to-left binary method with windowing)
-    for (int i = 256 - WINDOW_SIZE; i >= 0; i -= WINDOW_SIZE) {
-        // Double the result WINDOW_SIZE times
-        for (int j = 0; j < WINDOW_SIZE; j++) {
-            point_double(curve, res);
+
+    if (bn_is_zero(&k_reduced) || point_is_infinity(p)) {
+        point_set_infinity(res);
+        return 1;
+    }
+
+    int8_t wnaf[257];
+    int len = scalar_to_wnaf(&k_reduced, wnaf);
+
+    curve_point table[ODD_TABLE_SIZE];
+    precompute_odd_multiples(curve, p, table);
+
+    // Start from the most significant digit, then one Jacobian doubling per
+    // digit and one mixed addition per nonzero digit
+    curve_point entry;
+    jacobian_curve_point jres;
+    wnaf_entry(curve, table, wnaf[len - 1], &entry);
+    curve_to_jacobian(&entry, &jres, &curve->prime);
+
+    for (int i = len - 2; i >= 0; i--) {
+        point_jacobian_double(&jres, curve);
+        if (wnaf[i] != 0) {
+            wnaf_entry(curve, table, wnaf[i], &entry);
+            point_jacobian_add(&entry, &jres, curve);
+        }
+    }
+
+    // A single inversion brings the result back to affine coordinates
+    jacobian_to_affine(curve, &jres, res);
+
+    memzero(&k_reduced, sizeof(k_reduced));
+    memzero(wnaf, sizeof(wnaf));
+    return 1;
+}
+
+// Whether a Jacobian point is the point at infinity (z == 0 mod p)
+static int jacobian_is_infinity(const ecdsa_curve *curve, const jacobian_curve_point *jp) {
+    bignum256 z;
+    bn_copy(&jp->z, &z);
+    bn_mod(&z, &curve->prime);
+    return bn_is_zero(&z);
+}
+
+int opt_multi_point_multiply(const ecdsa_curve *curve, size_t count, const bignum256 *k,
+                             const curve_point *p, curve_point *res) {
+    if (!curve || !res || count > OPT_MULTI_MAX_POINTS || (count > 0 && (!k || !p))) {
+        return 0;
+    }
+
+    // Terms with a zero scalar or point drop out of the sum
+    int8_t wnaf[OPT_MULTI_MAX_POINTS][257];
+    int len[OPT_MULTI_MAX_POINTS];
+    const curve_point *base[OPT_MULTI_MAX_POINTS];
+    size_t n = 0;
+    int max_len = 0;
+    for (size_t i = 0; i < count; i++) {
+        bignum256 k_reduced;
+        bn_copy(&k[i], &k_reduced);
+        bn_mod(&k_reduced, &curve->order);
+        if (bn_is_zero(&k_reduced) || point_is_infinity(&p[i])) {
+            continue;
+        }
+        len[n] = scalar_to_wnaf(&k_reduced, wnaf[n]);
+        if (len[n] > max_len) {
+            max_len = len[n];
         }
-        
-        // Extract window_size bits
-        int window = 0;
-        for (int j = 0; j < WINDOW_SIZE && i + j < 256; j++) {
-            if (bn_testbit(&k_reduced, i + j)) {
-                window |= (1 << j);
+        base[n++] = &p[i];
+    }
+
+    if (n == 0) {
+        point_set_infinity(res);
+        return 1;
+    }
+
+    // Odd multiples of every point, with two inversions for all tables:
+    // one for the doubled points, one for the tables themselves
+    jacobian_curve_point jtable[OPT_MULTI_MAX_POINTS * ODD_TABLE_SIZE];
+    curve_point table[OPT_MULTI_MAX_POINTS * ODD_TABLE_SIZE];
+    curve_point p2[OPT_MULTI_MAX_POINTS];
+    for (size_t i = 0; i < n; i++) {
+        curve_to_jacobian(base[i], &jtable[i], &curve->prime);
+        point_jacobian_double(&jtable[i], curve);
+    }
+    jacobian_batch_to_affine(jtable, p2, n, &curve->prime);
+    for (size_t i = 0; i < n; i++) {
+        jacobian_curve_point *row = &jtable[i * ODD_TABLE_SIZE];
+        curve_to_jacobian(base[i], &row[0], &curve->prime);
+        for (int j = 1; j < ODD_TABLE_SIZE; j++) {
+            row[j] = row[j - 1];
+            point_jacobian_add(&p2[i], &row[j], curve);
+        }
+    }
+    jacobian_batch_to_affine(jtable, table, n * ODD_TABLE_SIZE, &curve->prime);
+
+    // One doubling chain for all points, plus one mixed addition per nonzero
+    // digit of any scalar. The accumulator is at infinity until the first
+    // addition, and again whenever a partial sum cancels.
+    curve_point entry;
+    jacobian_curve_point jres;
+    int started = 0;
+    for (int bit = max_len - 1; bit >= 0; bit--) {
+        if (started) {
+            point_jacobian_double(&jres, curve);
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (bit >= len[i] || wnaf[i][bit] == 0) {
+                continue;
+            }
+            wnaf_entry(curve, &table[i * ODD_TABLE_SIZE], wnaf[i][bit], &entry);
+            if (started) {
+                point_jacobian_add(&entry, &jres, curve);
+                started = !jacobian_is_infinity(curve, &jres);
+            } else {
+                curve_to_jacobian(&entry, &jres, &curve->prime);
+                started = 1;
             }
         }
-        
-        // Add the precomputed value if window is not 0
-        if (window > 0) {
-            point_add(curve, &precomp[window], res);
+    }
+
+    if (started) {
+        jacobian_to_affine(curve, &jres, res);
+    } else {
+        point_set_infinity(res);
+    }
+
+    memzero(wnaf, sizeof(wnaf));
+    return 1;
+}
+
+int opt_point_multiply_ct_jacobian(const ecdsa_curve *curve, const bignum256 *k,
+                                   const curve_point *p, jacobian_curve_point *res) {
+    bignum256 k_reduced;
+    bn_copy(k, &k_reduced);
+    bn_mod(&k_reduced, &curve->order);
+
+    // Zero scalar or point: not a secret-dependent case worth hiding
+    if (bn_is_zero(&k_reduced) || point_is_infinity(p)) {
+        jacobian_set_infinity(res);
+        return 1;
+    }
+
+    // Regular signed recoding as in point_multiply (ecdsa.c):
+    // a = k + 2^256 (mod order) made odd, written as sum(a[i] 16^i) with every
+    // digit odd and |a[i]| < 16, so every step is 4 doublings + 1 addition
+    bignum256 a;
+    uint32_t is_even = (k_reduced.val[0] & 1) - 1;
+    uint32_t tmp = 1;
+    int j;
+    for (j = 0; j < 8; j++) {
+        tmp += (BN_BASE - 1) + k_reduced.val[j] - (curve->order.val[j] & is_even);
+        a.val[j] = tmp & (BN_BASE - 1);
+        tmp >>= BN_BITS_PER_LIMB;
+    }
+    a.val[j] = tmp + 0xffffff + k_reduced.val[j] - (curve->order.val[j] & is_even);
+
+    curve_point table[ODD_TABLE_SIZE];
+    precompute_odd_multiples(curve, p, table);
+
+    const uint32_t *aptr = &a.val[8];
+    uint32_t abits = *aptr;
+    int ashift = 256 - (BN_BITS_PER_LIMB * 8) - 4;
+    uint32_t bits = abits >> ashift;
+    uint32_t sign = (bits >> 4) - 1;
+    uint32_t nsign;
+    bits ^= sign;
+    bits &= 15;
+
+    curve_point entry;
+    jacobian_curve_point *jres = res;
+    select_odd_multiple(table, bits >> 1, &entry);
+    curve_to_jacobian(&entry, jres, &curve->prime);
+
+    for (int i = 62; i >= 0; i--) {
+        point_jacobian_double(jres, curve);
+        point_jacobian_double(jres, curve);
+        point_jacobian_double(jres, curve);
+        point_jacobian_double(jres, curve);
+
+        // Next 5 bits of a; the branch only depends on the iteration number
+        ashift -= 4;
+        if (ashift < 0) {
+            bits = abits << (-ashift);
+            abits = *(--aptr);
+            ashift += BN_BITS_PER_LIMB;
+            bits |= abits >> ashift;
+        } else {
+            bits = abits >> ashift;
+        }
+        bits &= 31;
+        nsign = (bits >> 4) - 1;
+        bits ^= nsign;
+        bits &= 15;
+
+        // Make the sign of the accumulator match the sign of this digit
+        bn_cnegate((sign ^ nsign) & 1, &jres->z, &curve->prime);
+
+        select_odd_multiple(table, bits >> 1, &entry);
+        point_jacobian_add(&entry, jres, curve);
+        sign = nsign;
+    }
+    bn_cnegate(sign & 1, &jres->z, &curve->prime);
+
+    memzero(&k_reduced, sizeof(k_reduced));
+    memzero(&a, sizeof(a));
+    memzero(&entry, sizeof(entry));
+    return 1;
+}
+
+int opt_point_multiply_ct(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, curve_point *res) {
+    jacobian_curve_point jres;
+    int ret = opt_point_multiply_ct_jacobian(curve, k, p, &jres);
+    if (ret == 1) {
+        jacobian_to_affine(curve, &jres, res);
+    }
+    memzero(&jres, sizeof(jres));
+    return ret;
+}
+
+// Rows of the comb table converted to affine per shared inversion
+#define COMB_BUILD_ROWS 8
+
+int opt_comb_table_build(const ecdsa_curve *curve, const curve_point *p, opt_comb_table *table) {
+    if (point_is_infinity(p)) {
+        return 0;
+    }
+
+    const bignum256 *prime = &curve->prime;
+
+    // bases[i] = 16^i * p and doubles[i] = 2 * 16^i * p, one doubling chain
+    jacobian_curve_point bases[OPT_COMB_ROWS];
+    jacobian_curve_point doubles[OPT_COMB_ROWS];
+    curve_point doubles_affine[OPT_COMB_ROWS];
+
+    curve_to_jacobian(p, &bases[0], prime);
+    for (int i = 0; i < OPT_COMB_ROWS; i++) {
+        doubles[i] = bases[i];
+        point_jacobian_double(&doubles[i], curve);
+        if (i + 1 < OPT_COMB_ROWS) {
+            bases[i + 1] = doubles[i];
+            point_jacobian_double(&bases[i + 1], curve);
+            point_jacobian_double(&bases[i + 1], curve);
+            point_jacobian_double(&bases[i + 1], curve);
+        }
+    }
+    jacobian_batch_to_affine(doubles, doubles_affine, OPT_COMB_ROWS, prime);
+
+    // Row i holds the odd multiples of bases[i], obtained by repeatedly
+    // adding doubles[i]; a block of rows shares one inversion
+    jacobian_curve_point jrows[COMB_BUILD_ROWS][OPT_COMB_COLS];
+    for (int block = 0; block < OPT_COMB_ROWS; block += COMB_BUILD_ROWS) {
+        for (int r = 0; r < COMB_BUILD_ROWS; r++) {
+            jrows[r][0] = bases[block + r];
+            for (int j = 1; j < OPT_COMB_COLS; j++) {
+                jrows[r][j] = jrows[r][j - 1];
+                point_jacobian_add(&doubles_affine[block + r], &jrows[r][j], curve);
+            }
         }
+        jacobian_batch_to_affine(&jrows[0][0], &table->cp[block][0],
+                                 COMB_BUILD_ROWS * OPT_COMB_COLS, prime);
     }
-    
+
     return 1;
 }
 
-int opt_point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, curve_point *res) {
-    // Copy scalar and reduce modulo curve order
+int opt_comb_multiply_jacobian(const ecdsa_curve *curve, const curve_point (*cp)[OPT_COMB_COLS],
+                               const bignum256 *k, jacobian_curve_point *res) {
     bignum256 k_reduced;
     bn_copy(k, &k_reduced);
     bn_mod(&k_reduced, &curve->order);
-    
-    // Set result to infinity (identity element)
-    point_set_infinity(res);
-    
-    // Use efficient double-and-add algorithm
-    // This avoids the nested loop in your original implementation
-    curve_point tmp;
-    point_copy(p, &tmp);
-    
-    for (int i = 0; i < 256; i++) {
-        if (bn_testbit(&k_reduced, i)) {
-            point_add(curve, &tmp, res);
+
+    if (bn_is_zero(&k_reduced)) {
+        jacobian_set_infinity(res);
+        return 1;
+    }
+
+    // Same recoding as opt_point_multiply_ct, but the digits are consumed from
+    // the least significant end and every 16^i factor comes from the table,
+    // so no doublings are needed at all
+    bignum256 a;
+    uint32_t is_even = (k_reduced.val[0] & 1) - 1;
+    uint32_t tmp = 1;
+    int i, j;
+    for (j = 0; j < 8; j++) {
+        tmp += (BN_BASE - 1) + k_reduced.val[j] - (curve->order.val[j] & is_even);
+        a.val[j] = tmp & (BN_BASE - 1);
+        tmp >>= BN_BITS_PER_LIMB;
+    }
+    a.val[j] = tmp + 0xffffff + k_reduced.val[j] - (curve->order.val[j] & is_even);
+
+    curve_point entry;
+    jacobian_curve_point *jres = res;
+    uint32_t lowbits = a.val[0] & ((1 << 5) - 1);
+    lowbits ^= (lowbits >> 4) - 1;
+    lowbits &= 15;
+    select_odd_multiple(cp[0], lowbits >> 1, &entry);
+    curve_to_jacobian(&entry, jres, &curve->prime);
+
+    for (i = 1; i < OPT_COMB_ROWS; i++) {
+        // a >>= 4
+        for (j = 0; j < 8; j++) {
+            a.val[j] = (a.val[j] >> 4) | ((a.val[j + 1] & 0xf) << (BN_BITS_PER_LIMB - 4));
         }
-        
-        // Double the temporary point
-        point_double(curve, &tmp);
+        a.val[j] >>= 4;
+
+        lowbits = a.val[0] & ((1 << 5) - 1);
+        lowbits ^= (lowbits >> 4) - 1;
+        lowbits &= 15;
+
+        // Make the sign of the accumulator match the sign of this digit
+        bn_cnegate(~lowbits & 1, &jres->y, &curve->prime);
+
+        select_odd_multiple(cp[i], lowbits >> 1, &entry);
+        point_jacobian_add(&entry, jres, curve);
     }
-    
+    bn_cnegate(~(a.val[0] >> 4) & 1, &jres->y, &curve->prime);
+
+    memzero(&k_reduced, sizeof(k_reduced));
+    memzero(&a, sizeof(a));
+    memzero(&entry, sizeof(entry));
     return 1;
-}
\ No newline at end of file
+}
+
+int opt_comb_multiply(const ecdsa_curve *curve, const curve_point (*cp)[OPT_COMB_COLS],
+                      const bignum256 *k, curve_point *res) {
+    jacobian_curve_point jres;
+    int ret = opt_comb_multiply_jacobian(curve, cp, k, &jres);
+    if (ret == 1) {
+        jacobian_to_affine(curve, &jres, res);
+    }
+    memzero(&jres, sizeof(jres));
+    return ret;
+}
+
+#if !USE_PRECOMPUTED_CP
+// Generator tables built on first use when the curves do not carry one,
+// one per curve. A table is built under the lock and published read-only
+// by bumping generator_tables_used; lookups of built tables take no lock.
+#define GENERATOR_TABLE_SLOTS 4
+static struct {
+    const ecdsa_curve *curve;
+    opt_comb_table table;
+} generator_tables[GENERATOR_TABLE_SLOTS];
+static atomic_int generator_tables_used;
+static pthread_mutex_t generator_table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// The published table of curve, NULL if it is not built yet
+static const curve_point (*generator_table_find(const ecdsa_curve *curve))[OPT_COMB_COLS] {
+    int used = atomic_load_explicit(&generator_tables_used, memory_order_acquire);
+    for (int i = 0; i < used; i++) {
+        if (generator_tables[i].curve == curve) {
+            return (const curve_point (*)[OPT_COMB_COLS])generator_tables[i].table.cp;
+        }
+    }
+    return NULL;
+}
+#endif
+
+// Comb table of the generator of curve
+static const curve_point (*generator_table_of(const ecdsa_curve *curve))[OPT_COMB_COLS] {
+#if USE_PRECOMPUTED_CP
+    // curve->cp[i][j] = (2j + 1) * 16^i * G, shipped with the curve
+    return curve->cp;
+#else
+    const curve_point (*cp)[OPT_COMB_COLS] = generator_table_find(curve);
+    if (cp) {
+        return cp;
+    }
+
+    // Build path: another thread may have published the table meanwhile
+    pthread_mutex_lock(&generator_table_lock);
+    cp = generator_table_find(curve);
+    int used = atomic_load_explicit(&generator_tables_used, memory_order_relaxed);
+    if (!cp && used < GENERATOR_TABLE_SLOTS &&
+        opt_comb_table_build(curve, &curve->G, &generator_tables[used].table)) {
+        generator_tables[used].curve = curve;
+        atomic_store_explicit(&generator_tables_used, used + 1, memory_order_release);
+        cp = (const curve_point (*)[OPT_COMB_COLS])generator_tables[used].table.cp;
+    }
+    pthread_mutex_unlock(&generator_table_lock);
+    return cp;
+#endif
+}
+
+int opt_scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *res) {
+    const curve_point (*cp)[OPT_COMB_COLS] = generator_table_of(curve);
+    if (!cp) {
+        return 0;
+    }
+    return opt_comb_multiply(curve, cp, k, res);
+}
+
+int opt_scalar_multiply_jacobian(const ecdsa_curve *curve, const bignum256 *k,
+                                 jacobian_curve_point *res) {
+    const curve_point (*cp)[OPT_COMB_COLS] = generator_table_of(curve);
+    if (!cp) {
+        return 0;
+    }
+    return opt_comb_multiply_jacobian(curve, cp, k, res);
+}
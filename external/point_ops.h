@@ -6,12 +6,28 @@
  #ifndef __POINT_OPS_H__
  #define __POINT_OPS_H__
  
+ #include <stddef.h>
  #include "bignum.h"
  #include "ecdsa.h"
  
+ // Rows (4-bit digits of a scalar) and columns (odd multiples) of a comb table
+ #define OPT_COMB_ROWS 64
+ #define OPT_COMB_COLS 8
+ 
+ /**
+  * Fixed-base comb table, same layout as curve->cp under USE_PRECOMPUTED_CP:
+  * cp[i][j] = (2j + 1) * 16^i * P
+  */
+ typedef struct {
+     curve_point cp[OPT_COMB_ROWS][OPT_COMB_COLS];
+ } opt_comb_table;
+ 
  /**
-  * Optimized scalar multiplication using window method
-  * Computes res = k * G where G is the generator point
+  * Optimized scalar multiplication using a precomputed comb table
+  * Computes res = k * G where G is the generator point.
+  * Uses curve->cp when built with USE_PRECOMPUTED_CP, otherwise a table
+  * built on the first call under a lock.
+  * Constant time, 64 mixed additions and no doublings.
   * 
   * @param curve The elliptic curve to use
   * @param k The scalar to multiply by
@@ -21,8 +37,47 @@
  int opt_scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *res);
  
  /**
-  * Optimized point multiplication
-  * Computes res = k * p
+  * Same as opt_scalar_multiply, but leaves the result in Jacobian
+  * coordinates (z == 0 for the point at infinity) so that many results
+  * can be converted at once with jacobian_batch_to_affine
+  */
+ int opt_scalar_multiply_jacobian(const ecdsa_curve *curve, const bignum256 *k,
+                                  jacobian_curve_point *res);
+ 
+ /**
+  * Build the comb table of a point
+  * 
+  * @param curve The elliptic curve to use
+  * @param p The fixed base point
+  * @param table The resulting table (output)
+  * @return 1 on success, 0 on failure
+  */
+ int opt_comb_table_build(const ecdsa_curve *curve, const curve_point *p, opt_comb_table *table);
+ 
+ /**
+  * Fixed-base multiplication with a comb table (constant time)
+  * Computes res = k * P where cp is the comb table of P
+  * 
+  * @param curve The elliptic curve to use
+  * @param cp The comb table (curve->cp or opt_comb_table.cp)
+  * @param k The scalar to multiply by
+  * @param res The resulting point (output)
+  * @return 1 on success, 0 on failure
+  */
+ int opt_comb_multiply(const ecdsa_curve *curve, const curve_point (*cp)[OPT_COMB_COLS],
+                       const bignum256 *k, curve_point *res);
+ 
+ /**
+  * Same as opt_comb_multiply, with the result in Jacobian coordinates
+  */
+ int opt_comb_multiply_jacobian(const ecdsa_curve *curve, const curve_point (*cp)[OPT_COMB_COLS],
+                                const bignum256 *k, jacobian_curve_point *res);
+ 
+ /**
+  * Optimized point multiplication (variable time)
+  * Computes res = k * p with a width-5 wNAF in Jacobian coordinates,
+  * needing a single inversion for the result.
+  * Only use it when k is not secret.
   * 
   * @param curve The elliptic curve to use
   * @param k The scalar to multiply by
@@ -32,4 +87,44 @@
   */
  int opt_point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, curve_point *res);
  
+ // Most points opt_multi_point_multiply takes in one call
+ #define OPT_MULTI_MAX_POINTS 16
+ 
+ /**
+  * Multi-scalar multiplication (variable time, Straus/Shamir)
+  * Computes res = k[0] * p[0] + ... + k[count-1] * p[count-1] with the
+  * width-5 wNAF of every scalar interleaved over a single doubling chain,
+  * so the sum costs about 256 doublings in total instead of 256 per term.
+  * Only use it when the scalars are not secret.
+  * 
+  * @param curve The elliptic curve to use
+  * @param count Number of terms, at most OPT_MULTI_MAX_POINTS
+  * @param k The scalars (count entries)
+  * @param p The points (count entries)
+  * @param res The resulting point (output)
+  * @return 1 on success, 0 on failure
+  */
+ int opt_multi_point_multiply(const ecdsa_curve *curve, size_t count, const bignum256 *k,
+                              const curve_point *p, curve_point *res);
+ 
+ /**
+  * Optimized point multiplication (constant time)
+  * Computes res = k * p with a regular signed 4-bit window in Jacobian
+  * coordinates: always 4 doublings and 1 addition per digit, and table
+  * lookups that do not depend on k.
+  * 
+  * @param curve The elliptic curve to use
+  * @param k The secret scalar to multiply by
+  * @param p The point to multiply
+  * @param res The resulting point (output)
+  * @return 1 on success, 0 on failure
+  */
+ int opt_point_multiply_ct(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, curve_point *res);
+ 
+ /**
+  * Same as opt_point_multiply_ct, with the result in Jacobian coordinates
+  */
+ int opt_point_multiply_ct_jacobian(const ecdsa_curve *curve, const bignum256 *k,
+                                    const curve_point *p, jacobian_curve_point *res);
+ 
  #endif /* __POINT_OPS_H__ */
\ No newline at end of file
@@ -33,6 +33,11 @@
 #include "sha2.h"
 #include "memzero.h"
 #include "byte_order.h"
+#include "options.h"
+
+#if USE_SHA2_X86
+#include <immintrin.h>
+#endif
 
 /*
  * ASSERT NOTE:
@@ -720,7 +725,7 @@ void sha256_Init_ex(SHA256_CTX *context, const uint32_t state[8], uint64_t bitco
 	(h) = T1 + Sigma0_256(a) + Maj((a), (b), (c)); \
 	j++
 
-void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+static void sha256_Transform_generic(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
 	sha2_word32	a = 0, b = 0, c = 0, d = 0, e = 0, f = 0, g = 0, h = 0, s0 = 0, s1 = 0;
 	sha2_word32	T1 = 0;
 	sha2_word32 W256[16] = {0};
@@ -777,7 +782,7 @@ void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2
 
 #else /* SHA2_UNROLL_TRANSFORM */
 
-void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+static void sha256_Transform_generic(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
 	sha2_word32	a = 0, b = 0, c = 0, d = 0, e = 0, f = 0, g = 0, h = 0, s0 = 0, s1 = 0;
 	sha2_word32	T1 = 0, T2 = 0 , W256[16] = {0};
 	int		j = 0;
@@ -848,6 +853,71 @@ void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2
 
 #endif /* SHA2_UNROLL_TRANSFORM */
 
+#if USE_SHA2_X86
+
+/*
+ * sha256_Transform with the x86 SHA extensions. The block is given as
+ * host-order words, so it is loaded without a byte shuffle; the state is
+ * rearranged into the ABEF/CDGH halves that sha256rnds2 works on.
+ */
+__attribute__((target("sha,sse4.1")))
+static void sha256_Transform_shani(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+	__m128i	state0, state1, tmp, msg, abef_save, cdgh_save;
+	__m128i	w[4];
+
+	tmp = _mm_loadu_si128((const __m128i*)&state_in[0]);		/* DCBA */
+	state1 = _mm_loadu_si128((const __m128i*)&state_in[4]);	/* HGFE */
+	tmp = _mm_shuffle_epi32(tmp, 0xB1);				/* CDAB */
+	state1 = _mm_shuffle_epi32(state1, 0x1B);			/* EFGH */
+	state0 = _mm_alignr_epi8(tmp, state1, 8);			/* ABEF */
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);			/* CDGH */
+	abef_save = state0;
+	cdgh_save = state1;
+
+	for (int j = 0; j < 4; j++) {
+		w[j] = _mm_loadu_si128((const __m128i*)&data[4 * j]);
+	}
+
+	/* 16 groups of 4 rounds; w[j & 3] holds words 4j..4j+3 of the schedule */
+	for (int j = 0; j < 16; j++) {
+		msg = _mm_add_epi32(w[j & 3], _mm_loadu_si128((const __m128i*)&K256[4 * j]));
+		state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+
+		/* Words 4(j+4).. from words 4j.. to 4j+15 */
+		if (j < 12) {
+			tmp = _mm_sha256msg1_epu32(w[j & 3], w[(j + 1) & 3]);
+			tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(w[(j + 3) & 3], w[(j + 2) & 3], 4));
+			w[j & 3] = _mm_sha256msg2_epu32(tmp, w[(j + 3) & 3]);
+		}
+
+		msg = _mm_shuffle_epi32(msg, 0x0E);
+		state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+	}
+
+	state0 = _mm_add_epi32(state0, abef_save);
+	state1 = _mm_add_epi32(state1, cdgh_save);
+
+	tmp = _mm_shuffle_epi32(state0, 0x1B);				/* FEBA */
+	state1 = _mm_shuffle_epi32(state1, 0xB1);			/* DCHG */
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);			/* DCBA */
+	state1 = _mm_alignr_epi8(state1, tmp, 8);			/* HGFE */
+
+	_mm_storeu_si128((__m128i*)&state_out[0], state0);
+	_mm_storeu_si128((__m128i*)&state_out[4], state1);
+}
+
+#endif /* USE_SHA2_X86 */
+
+void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+#if USE_SHA2_X86
+	if (__builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1")) {
+		sha256_Transform_shani(state_in, data, state_out);
+		return;
+	}
+#endif
+	sha256_Transform_generic(state_in, data, state_out);
+}
+
 void sha256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 	unsigned int	freespace = 0, usedspace = 0;
 
@@ -987,6 +1057,134 @@ void sha256_Raw(const sha2_byte* data, size_t len, uint8_t digest[SHA256_DIGEST_
 	sha256_Final(&context, digest);
 }
 
+#if USE_SHA2_X86
+
+static inline sha2_word32 sha256_load_be32(const sha2_byte* p) {
+	return ((sha2_word32)p[0] << 24) | ((sha2_word32)p[1] << 16) |
+	       ((sha2_word32)p[2] << 8) | (sha2_word32)p[3];
+}
+
+#define ROTR32_X8(b,x)		_mm256_or_si256(_mm256_srli_epi32((x), (b)), _mm256_slli_epi32((x), 32 - (b)))
+#define Sigma0_256_X8(x)	_mm256_xor_si256(_mm256_xor_si256(ROTR32_X8(2, (x)), ROTR32_X8(13, (x))), ROTR32_X8(22, (x)))
+#define Sigma1_256_X8(x)	_mm256_xor_si256(_mm256_xor_si256(ROTR32_X8(6, (x)), ROTR32_X8(11, (x))), ROTR32_X8(25, (x)))
+#define sigma0_256_X8(x)	_mm256_xor_si256(_mm256_xor_si256(ROTR32_X8(7, (x)), ROTR32_X8(18, (x))), _mm256_srli_epi32((x), 3))
+#define sigma1_256_X8(x)	_mm256_xor_si256(_mm256_xor_si256(ROTR32_X8(17, (x)), ROTR32_X8(19, (x))), _mm256_srli_epi32((x), 10))
+
+/*
+ * Eight SHA-256 computations in the 32-bit lanes of AVX2 registers: lane i
+ * hashes data[i]. All messages have the same length, so they share the
+ * block count and the padding layout.
+ */
+__attribute__((target("avx2")))
+static void sha256_Raw_x8_avx2(const sha2_byte* const data[8], size_t len, sha2_byte digest[8][SHA256_DIGEST_LENGTH]) {
+	sha2_byte	tail[8][2 * SHA256_BLOCK_LENGTH];
+	sha2_word32	words[8][8];
+	__m256i		state[8], v[8], w[16], t1, t2;
+	size_t		full = len / SHA256_BLOCK_LENGTH;
+	size_t		rest = len % SHA256_BLOCK_LENGTH;
+	size_t		tail_blocks = rest < SHA256_SHORT_BLOCK_LENGTH ? 1 : 2;
+	uint64_t	bitcount = (uint64_t)len << 3;
+
+	/* The last bytes of every message, padded like sha256_Final does */
+	for (int i = 0; i < 8; i++) {
+		memzero(tail[i], sizeof(tail[i]));
+		memcpy(tail[i], data[i] + full * SHA256_BLOCK_LENGTH, rest);
+		tail[i][rest] = 0x80;
+		for (int k = 0; k < 8; k++) {
+			tail[i][tail_blocks * SHA256_BLOCK_LENGTH - 1 - k] = (sha2_byte)(bitcount >> (8 * k));
+		}
+	}
+
+	for (int j = 0; j < 8; j++) {
+		state[j] = _mm256_set1_epi32((int)sha256_initial_hash_value[j]);
+	}
+
+	for (size_t block = 0; block < full + tail_blocks; block++) {
+		const sha2_byte* p[8];
+		for (int i = 0; i < 8; i++) {
+			p[i] = block < full ? data[i] + block * SHA256_BLOCK_LENGTH
+			                    : tail[i] + (block - full) * SHA256_BLOCK_LENGTH;
+		}
+		for (int j = 0; j < 16; j++) {
+			w[j] = _mm256_setr_epi32((int)sha256_load_be32(p[0] + 4 * j), (int)sha256_load_be32(p[1] + 4 * j),
+			                         (int)sha256_load_be32(p[2] + 4 * j), (int)sha256_load_be32(p[3] + 4 * j),
+			                         (int)sha256_load_be32(p[4] + 4 * j), (int)sha256_load_be32(p[5] + 4 * j),
+			                         (int)sha256_load_be32(p[6] + 4 * j), (int)sha256_load_be32(p[7] + 4 * j));
+		}
+
+		for (int j = 0; j < 8; j++) {
+			v[j] = state[j];
+		}
+		for (int j = 0; j < 64; j++) {
+			if (j >= 16) {
+				w[j & 15] = _mm256_add_epi32(_mm256_add_epi32(w[j & 15], sigma0_256_X8(w[(j + 1) & 15])),
+				                             _mm256_add_epi32(w[(j + 9) & 15], sigma1_256_X8(w[(j + 14) & 15])));
+			}
+			/* T1 = h + Sigma1(e) + Ch(e, f, g) + K[j] + W[j] */
+			t1 = _mm256_add_epi32(v[7], Sigma1_256_X8(v[4]));
+			t1 = _mm256_add_epi32(t1, _mm256_xor_si256(_mm256_and_si256(v[4], v[5]), _mm256_andnot_si256(v[4], v[6])));
+			t1 = _mm256_add_epi32(t1, _mm256_add_epi32(_mm256_set1_epi32((int)K256[j]), w[j & 15]));
+			/* T2 = Sigma0(a) + Maj(a, b, c) */
+			t2 = _mm256_or_si256(_mm256_and_si256(v[0], v[1]), _mm256_and_si256(v[2], _mm256_or_si256(v[0], v[1])));
+			t2 = _mm256_add_epi32(t2, Sigma0_256_X8(v[0]));
+
+			v[7] = v[6];
+			v[6] = v[5];
+			v[5] = v[4];
+			v[4] = _mm256_add_epi32(v[3], t1);
+			v[3] = v[2];
+			v[2] = v[1];
+			v[1] = v[0];
+			v[0] = _mm256_add_epi32(t1, t2);
+		}
+		for (int j = 0; j < 8; j++) {
+			state[j] = _mm256_add_epi32(state[j], v[j]);
+		}
+	}
+
+	for (int j = 0; j < 8; j++) {
+		_mm256_storeu_si256((__m256i*)words[j], state[j]);
+	}
+	for (int i = 0; i < 8; i++) {
+		for (int j = 0; j < 8; j++) {
+			digest[i][4 * j] = (sha2_byte)(words[j][i] >> 24);
+			digest[i][4 * j + 1] = (sha2_byte)(words[j][i] >> 16);
+			digest[i][4 * j + 2] = (sha2_byte)(words[j][i] >> 8);
+			digest[i][4 * j + 3] = (sha2_byte)words[j][i];
+		}
+	}
+
+	memzero(tail, sizeof(tail));
+	memzero(words, sizeof(words));
+	memzero(w, sizeof(w));
+	memzero(v, sizeof(v));
+}
+
+#endif /* USE_SHA2_X86 */
+
+void sha256_Raw_x8(const sha2_byte* const data[8], size_t len, sha2_byte digest[8][SHA256_DIGEST_LENGTH]) {
+#if USE_SHA2_X86
+	if (__builtin_cpu_supports("avx2")) {
+		sha256_Raw_x8_avx2(data, len, digest);
+		return;
+	}
+#endif
+	for (int i = 0; i < 8; i++) {
+		sha256_Raw(data[i], len, digest[i]);
+	}
+}
+
+void sha256_Raw_batch(size_t count, const sha2_byte* const* data, size_t len, sha2_byte (*digest)[SHA256_DIGEST_LENGTH]) {
+	size_t i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		sha256_Raw_x8(data + i, len, digest + i);
+	}
+	for (; i < count; i++) {
+		sha256_Raw(data[i], len, digest[i]);
+	}
+}
+
 char* sha256_Data(const sha2_byte* data, size_t len, char digest[SHA256_DIGEST_STRING_LENGTH]) {
 	SHA256_CTX	context = {0};
 
@@ -80,6 +80,10 @@ void sha256_Update(SHA256_CTX*, const uint8_t*, size_t);
 void sha256_Final(SHA256_CTX*, uint8_t[SHA256_DIGEST_LENGTH]);
 char* sha256_End(SHA256_CTX*, char[SHA256_DIGEST_STRING_LENGTH]);
 void sha256_Raw(const uint8_t*, size_t, uint8_t[SHA256_DIGEST_LENGTH]);
+// Hashes 8 messages of len bytes each (AVX2 when available)
+void sha256_Raw_x8(const uint8_t* const data[8], size_t len, uint8_t digest[8][SHA256_DIGEST_LENGTH]);
+// Hashes count messages of len bytes each, 8 at a time with sha256_Raw_x8
+void sha256_Raw_batch(size_t count, const uint8_t* const* data, size_t len, uint8_t (*digest)[SHA256_DIGEST_LENGTH]);
 char* sha256_Data(const uint8_t*, size_t, char[SHA256_DIGEST_STRING_LENGTH]);
 
 void sha384_Raw(const uint8_t*, size_t, uint8_t[SHA384_DIGEST_LENGTH]);
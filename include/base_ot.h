@@ -8,13 +8,16 @@
   - Alice learns nothing about Bob's choice bit c
   
   This implementation uses the secp256k1 elliptic curve with SHA-256 for
-  key derivation and XOR for encryption.
+  key derivation and XOR for encryption (BLAKE2s with kdf_set_backend). The key agreement can run over
+  Curve25519 instead (base_ot_set_backend, base_ot_25519.h): the private
+  keys are still bignum256 scalars and the messages keep their size.
  */
 
  #ifndef __BASE_OT_H__
  #define __BASE_OT_H__
  
  #include <stdint.h>
+ #include <stddef.h>
  #include "bignum.h"
  #include "ecdsa.h"
  #include "secp256k1.h"
@@ -34,6 +37,40 @@
      uint8_t B_compressed[33]; // Compressed public key B
  } OT_ReceiverMessage;
  
+ // First byte of the points of the Curve25519 backend
+ #define BASE_OT_CURVE25519_TAG 0x25
+ 
+ /**
+  * Group of the OT key agreement. The sender picks it for the OTs it
+  * starts; the receiver follows the sender's message.
+  */
+ typedef enum {
+     BASE_OT_BACKEND_SECP256K1 = 0,
+     BASE_OT_BACKEND_CURVE25519 = 1
+ } base_ot_backend_t;
+ 
+ // Backend before any base_ot_set_backend call (MTA_BASE_OT_BACKEND in CMake)
+ #ifndef BASE_OT_DEFAULT_BACKEND
+ #define BASE_OT_DEFAULT_BACKEND BASE_OT_BACKEND_SECP256K1
+ #endif
+ 
+ /**
+  * Select the group of the OTs started from now on. Not synchronized:
+  * set it before running OTs, and keep it until their sender keys are
+  * derived.
+  * 
+  * @param backend The backend
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_set_backend(base_ot_backend_t backend);
+ 
+ /**
+  * The backend of the OTs started from now on
+  * 
+  * @return The backend
+  */
+ base_ot_backend_t base_ot_get_backend(void);
+ 
  /**
   * Initialize the Base OT protocol as a sender
   * 
@@ -46,6 +83,16 @@
  int base_ot_init_sender(const uint8_t *m0, const uint8_t *m1, 
                          OT_SenderMessage *message, bignum256 *a);
  
+ /**
+  * Compute the sender message A = a·G for a given private key, so that a
+  * sender who derives a on demand does not have to store it
+  * 
+  * @param a The sender's private key (non-zero)
+  * @param message Sender message containing public key A (output)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_sender_message(const bignum256 *a, OT_SenderMessage *message);
+ 
  /**
   * Receiver generates a choice message based on which message they want to receive
   * 
@@ -58,6 +105,21 @@
  int base_ot_receiver_choice(const OT_SenderMessage *sender_msg, int choice_bit,
                             OT_ReceiverMessage *receiver_msg, uint8_t *k_c);
  
+ /**
+  * Same as base_ot_receiver_choice with a caller-provided secret b, e.g.
+  * drawn from a seeded PRG so that the run can be reproduced
+  * 
+  * @param sender_msg Sender's message containing key A
+  * @param choice_bit 0 for m0, 1 for m1
+  * @param b Receiver's secret scalar (non-zero)
+  * @param receiver_msg Receiver's message to send back to sender (output)
+  * @param k_c Receiver's derived key (output)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_receiver_choice_keyed(const OT_SenderMessage *sender_msg, int choice_bit,
+                                   const bignum256 *b, OT_ReceiverMessage *receiver_msg,
+                                   uint8_t *k_c);
+ 
  /**
   * Sender computes the two encryption keys based on receiver's message
   * 
@@ -70,6 +132,142 @@
  int base_ot_sender_keys(const bignum256 *a, const OT_ReceiverMessage *receiver_msg,
                          uint8_t *k0, uint8_t *k1);
  
+ // Base OTs whose points share one inversion in the batch functions
+ #define BASE_OT_BATCH_CHUNK 64
+ 
+ /**
+  * Batched base_ot_init_sender for count independent OTs
+  * 
+  * Points are kept in Jacobian coordinates and converted to affine together,
+  * so each chunk of BASE_OT_BATCH_CHUNK OTs costs a single field inversion.
+  * 
+  * @param count Number of OTs
+  * @param messages Sender messages (output, count entries)
+  * @param a The sender's private keys (output, count entries)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_init_sender_batch(size_t count, OT_SenderMessage *messages, bignum256 *a);
+ 
+ /**
+  * Batched base_ot_sender_message: the messages of count OTs whose
+  * private keys were drawn by the caller
+  * 
+  * @param count Number of OTs
+  * @param a The sender's private keys, nonzero (count entries)
+  * @param messages Sender messages (output, count entries)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_sender_message_batch(size_t count, const bignum256 *a, OT_SenderMessage *messages);
+ 
+ /**
+  * Batched base_ot_receiver_choice for count independent OTs
+  * 
+  * @param count Number of OTs
+  * @param sender_msgs Sender's messages (count entries)
+  * @param choice_bits Choice bit per OT, 0 or 1 (count entries)
+  * @param receiver_msgs Receiver's messages (output, count entries)
+  * @param k_c Receiver's derived keys (output, count entries)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_receiver_choice_batch(size_t count, const OT_SenderMessage *sender_msgs,
+                                   const int *choice_bits, OT_ReceiverMessage *receiver_msgs,
+                                   uint8_t (*k_c)[32]);
+ 
+ /**
+  * base_ot_receiver_choice_batch with the receiver's secrets b given
+  * by the caller (e.g. derived from a seed), NULL draws them at random
+  * 
+  * @param count Number of OTs
+  * @param sender_msgs Sender's messages (count entries)
+  * @param choice_bits Choice bit per OT, 0 or 1 (count entries)
+  * @param secrets Receiver's nonzero secrets (count entries), or NULL
+  * @param receiver_msgs Receiver's messages (output, count entries)
+  * @param k_c Receiver's derived keys (output, count entries)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_receiver_choice_batch_keyed(size_t count, const OT_SenderMessage *sender_msgs,
+                                         const int *choice_bits, const bignum256 *secrets,
+                                         OT_ReceiverMessage *receiver_msgs,
+                                         uint8_t (*k_c)[32]);
+ 
+ /**
+  * Batched base_ot_sender_keys for count independent OTs
+  * 
+  * @param count Number of OTs
+  * @param a Sender's private keys from base_ot_init_sender_batch (count entries)
+  * @param receiver_msgs Receiver's messages (count entries)
+  * @param k0 Keys for choice bit 0 (output, count entries)
+  * @param k1 Keys for choice bit 1 (output, count entries)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_sender_keys_batch(size_t count, const bignum256 *a,
+                               const OT_ReceiverMessage *receiver_msgs,
+                               uint8_t (*k0)[32], uint8_t (*k1)[32]);
+ 
+ /**
+  * Simplest OT (Chou-Orlandi): one sender key pair (a, A) serves every OT
+  * of a session, so A is sent once and a·A is computed once. The keys of
+  * OT i are H(A || B_i || i || point), so each OT of the session needs its
+  * own index and the sender key must not be reused across sessions.
+  */
+ typedef struct {
+     base_ot_backend_t backend;          // Group of the session
+     bignum256 a;                        // Sender's private key
+     curve_point A;                      // A = a·G (secp256k1 only)
+     curve_point neg_aA;                 // -(a·A), turns a·B into a·(B-A) (secp256k1 only)
+     OT_SenderMessage message;           // Compressed A, the only sender message
+ } base_ot_simplest_sender_t;
+ 
+ /**
+  * Set up a Simplest OT sender in the current backend
+  * 
+  * @param sender The sender to set up
+  * @param a Nonzero private key, or NULL to draw one at random
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_simplest_sender_init(base_ot_simplest_sender_t *sender, const bignum256 *a);
+ 
+ /**
+  * Wipe a Simplest OT sender
+  * 
+  * @param sender The sender
+  */
+ void base_ot_simplest_sender_clear(base_ot_simplest_sender_t *sender);
+ 
+ /**
+  * Receiver's answers to count Simplest OTs of one sender
+  * 
+  * @param count Number of OTs
+  * @param first_index Index of the first OT in the session
+  * @param sender_msg The sender's only message
+  * @param choice_bits Choice bit per OT, 0 or 1 (count entries)
+  * @param secrets Receiver's nonzero secrets (count entries), or NULL
+  * @param receiver_msgs Receiver's messages (output, count entries)
+  * @param k_c Receiver's derived keys (output, count entries)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_simplest_receiver_choice_batch(size_t count, uint32_t first_index,
+                                            const OT_SenderMessage *sender_msg,
+                                            const int *choice_bits, const bignum256 *secrets,
+                                            OT_ReceiverMessage *receiver_msgs,
+                                            uint8_t (*k_c)[32]);
+ 
+ /**
+  * Sender's keys of count Simplest OTs, one point multiplication each
+  * 
+  * @param sender The sender
+  * @param count Number of OTs
+  * @param first_index Index of the first OT in the session
+  * @param receiver_msgs Receiver's messages (count entries)
+  * @param k0 Keys for choice bit 0 (output, count entries)
+  * @param k1 Keys for choice bit 1 (output, count entries)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_simplest_sender_keys_batch(const base_ot_simplest_sender_t *sender,
+                                        size_t count, uint32_t first_index,
+                                        const OT_ReceiverMessage *receiver_msgs,
+                                        uint8_t (*k0)[32], uint8_t (*k1)[32]);
+ 
  /**
   * Encrypt the original messages with derived keys and send them to receiver
   * 
@@ -0,0 +1,75 @@
+/*
+  Curve25519 backend of the base OT
+
+  The same sender/receiver flows as base_ot.c, over the Edwards form of
+  Curve25519 with the ed25519-donna field and group code. Only the OT key
+  agreement moves to this group: the private keys stay the bignum256
+  scalars of the callers (reduced mod the group order l here), and the
+  payloads and the MtA arithmetic are unchanged.
+
+  Points travel as BASE_OT_CURVE25519_TAG followed by the 32-byte
+  Edwards encoding, so they fit the 33-byte OT messages and can never be
+  mistaken for a compressed secp256k1 point. The group has cofactor 8,
+  so the receiver answers A with 8·A and the sender multiplies its key
+  points by 8: a small-order component in either message cannot leak a
+  choice bit or bits of a key.
+
+  These functions are called by the base_ot_* functions when the
+  Curve25519 backend is selected (see base_ot_set_backend).
+ */
+
+ #ifndef __BASE_OT_25519_H__
+ #define __BASE_OT_25519_H__
+
+ #include <stdint.h>
+ #include <stddef.h>
+ #include "base_ot.h"
+
+ /**
+  * Sender messages A_i = a_i·G of count OTs
+  *
+  * @param count Number of OTs
+  * @param a The sender's private keys, nonzero mod l (count entries)
+  * @param messages Sender messages (output, count entries)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_25519_sender_message_batch(size_t count, const bignum256 *a,
+                                        OT_SenderMessage *messages);
+
+ /**
+  * Receiver's answers B_i = b_i·G + c_i·8·A_i and keys H(b_i·8·A_i)
+  *
+  * @param count Number of OTs
+  * @param sender_msgs Sender's messages (count entries, one if simplest)
+  * @param simplest Nonzero for Simplest OT: one A for all OTs, keys bound to A and the index
+  * @param first_index Index of the first OT in the Simplest OT session
+  * @param choice_bits Choice bit per OT, 0 or 1 (count entries)
+  * @param secrets Receiver's secrets, nonzero mod l (count entries), or NULL
+  * @param receiver_msgs Receiver's messages (output, count entries)
+  * @param k_c Receiver's derived keys (output, count entries)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_25519_receiver_choice_batch(size_t count, const OT_SenderMessage *sender_msgs,
+                                         int simplest, uint32_t first_index,
+                                         const int *choice_bits, const bignum256 *secrets,
+                                         OT_ReceiverMessage *receiver_msgs,
+                                         uint8_t (*k_c)[32]);
+
+ /**
+  * Sender's keys H(8·a·B) and H(8·a·(B - 8·A)) of count OTs
+  *
+  * @param count Number of OTs
+  * @param a Sender's private keys (count entries, one if simplest_msg is set)
+  * @param simplest_msg The sender's message for Simplest OT, NULL for independent OTs
+  * @param first_index Index of the first OT in the Simplest OT session
+  * @param receiver_msgs Receiver's messages (count entries)
+  * @param k0 Keys for choice bit 0 (output, count entries)
+  * @param k1 Keys for choice bit 1 (output, count entries)
+  * @return 0 on success, error code otherwise
+  */
+ int base_ot_25519_sender_keys_batch(size_t count, const bignum256 *a,
+                                     const OT_SenderMessage *simplest_msg, uint32_t first_index,
+                                     const OT_ReceiverMessage *receiver_msgs,
+                                     uint8_t (*k0)[32], uint8_t (*k1)[32]);
+
+ #endif /* __BASE_OT_25519_H__ */
@@ -0,0 +1,143 @@
+/*
+  Hash / KDF backends of the OTs
+
+  Every symmetric primitive the OTs use goes through one of these
+  backends:
+  - SHA-256 (the default): the hashes of sha2.c, SHA-NI and 8-way AVX2
+    when the CPU has them
+  - BLAKE2s: the same constructions with BLAKE2s-256, keyed BLAKE2s for
+    the PRG and the keystream
+  - AES: fixed-key AES as correlation-robust hash and AES-128 in counter
+    mode as PRG for OT extension, with AES-NI when the CPU has it
+    (the portable AES of external/aes otherwise)
+
+  The hash of OT extension keys is the tweakable correlation-robust hash
+  of Guo, Katz, Wang and Yu (TMMO): with pi a fixed-key AES permutation,
+    H(i, x) = pi(pi(x) ^ T(i, h)) ^ pi(x)    h = 0, 1 for the two halves
+  three AES blocks per 32-byte key. A fixed-key permutation is no random
+  oracle, so the AES backend still hashes points and encrypts the base OT
+  payloads with SHA-256 (kdf_hash, kdf_xor_crypt).
+
+  OT extension sessions keep the backend of their base phase; base OTs
+  and payload encryption follow the current backend. Both parties must
+  select the same one.
+ */
+
+ #ifndef __KDF_H__
+ #define __KDF_H__
+
+ #include <stdint.h>
+ #include <stddef.h>
+
+ // Output of every hash and PRG block
+ #define KDF_BLOCK_LEN 32
+
+ // Input of the correlation-robust hash (a row of the OT extension matrix)
+ #define KDF_CRH_INPUT_LEN 16
+
+ typedef enum {
+     KDF_BACKEND_SHA256 = 0,
+     KDF_BACKEND_BLAKE2S = 1,
+     KDF_BACKEND_AES = 2
+ } kdf_backend_t;
+
+ // Backend before any kdf_set_backend call (MTA_KDF_BACKEND in CMake)
+ #ifndef KDF_DEFAULT_BACKEND
+ #define KDF_DEFAULT_BACKEND KDF_BACKEND_SHA256
+ #endif
+
+ /**
+  * Select the backend of the OTs and OT extension sessions started from
+  * now on. Not synchronized: set it before running OTs.
+  *
+  * @param backend The backend
+  * @return 0 on success, error code otherwise
+  */
+ int kdf_set_backend(kdf_backend_t backend);
+
+ /**
+  * The backend of the OTs started from now on
+  *
+  * @return The backend
+  */
+ kdf_backend_t kdf_get_backend(void);
+
+ /**
+  * Name of a backend, for logs and benchmarks
+  *
+  * @param backend The backend
+  * @return "sha256", "blake2s", "aes" or "unknown"
+  */
+ const char *kdf_backend_name(kdf_backend_t backend);
+
+ /**
+  * Let the AES backend use AES-NI when the CPU has it (the default), or
+  * force the portable AES. Both compute the same values.
+  *
+  * @param enable Nonzero to use AES-NI when available
+  * @return 1 if AES-NI is used from now on, 0 otherwise
+  */
+ int kdf_use_aes_ni(int enable);
+
+ /**
+  * Hash of a message, SHA-256 for the SHA-256 and AES backends
+  *
+  * @param backend The backend
+  * @param data The message
+  * @param len Length of the message
+  * @param out The digest (KDF_BLOCK_LEN bytes)
+  */
+ void kdf_hash(kdf_backend_t backend, const uint8_t *data, size_t len, uint8_t *out);
+
+ /**
+  * kdf_hash of count messages of the same length
+  *
+  * @param backend The backend
+  * @param count Number of messages
+  * @param data The messages (count entries)
+  * @param len Length of every message
+  * @param out The digests (count entries)
+  */
+ void kdf_hash_batch(kdf_backend_t backend, size_t count, const uint8_t *const *data,
+                     size_t len, uint8_t (*out)[KDF_BLOCK_LEN]);
+
+ /**
+  * Encrypt or decrypt data with the keystream of a 32-byte key:
+  * sha256_xor_crypt, or keyed BLAKE2s of a 64-bit big-endian counter
+  *
+  * @param backend The backend
+  * @param data Data to encrypt/decrypt (in-place)
+  * @param key The key (32 bytes)
+  * @param len Length of the data, any length
+  */
+ void kdf_xor_crypt(kdf_backend_t backend, uint8_t *data, const uint8_t *key, size_t len);
+
+ /**
+  * Correlation-robust hash of count rows, out[i] = H(first_index + i, rows[i])
+  *
+  * @param backend The backend
+  * @param first_index Tweak of the first row
+  * @param rows The rows (count entries)
+  * @param count Number of rows
+  * @param out The hashes (count entries)
+  */
+ void kdf_crh_rows(kdf_backend_t backend, uint64_t first_index,
+                   const uint8_t (*rows)[KDF_CRH_INPUT_LEN], size_t count,
+                   uint8_t (*out)[KDF_BLOCK_LEN]);
+
+ /**
+  * PRG blocks [first_block, first_block + num_blocks) of count seeds,
+  * the stream of seeds[j] going to out + j * stride
+  *
+  * @param backend The backend
+  * @param seeds The seeds (count entries of 32 bytes)
+  * @param count Number of seeds
+  * @param first_block Index of the first block
+  * @param num_blocks Blocks per seed
+  * @param out The streams (num_blocks * KDF_BLOCK_LEN bytes per seed)
+  * @param stride Distance between two streams in out
+  */
+ void kdf_prg(kdf_backend_t backend, const uint8_t (*seeds)[32], size_t count,
+              uint64_t first_block, size_t num_blocks, uint8_t *out, size_t stride);
+
+ #endif /* __KDF_H__ */
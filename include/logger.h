@@ -6,6 +6,23 @@
  #define __LOGGER_H__
  
  #include <stdio.h>
+ #include <stdint.h>
+ 
+ // Most verbose level compiled in (0 none, 1 error, 2 info, 3 debug), set
+ // with MTA_LOG_LEVEL in CMakeLists.txt. Calls above it are removed at
+ // compile time, arguments included.
+ #ifndef LOG_MAX_LEVEL
+ #define LOG_MAX_LEVEL 3
+ #endif
+ 
+ // Lines the async sink can hold before it drops new ones
+ #define LOGGER_ASYNC_SLOTS 1024
+ 
+ // Longest line of the async sink, longer lines are truncated
+ #define LOGGER_LINE_MAX 256
+ 
+ // Longest logfile path, terminator included
+ #define LOGGER_PATH_MAX 256
  
  // Log levels
  typedef enum {
@@ -18,11 +35,38 @@
  /**
   * Initialize the logger
   * 
-  * @param level The logging level to use
+  * @param level The most verbose level printed to the terminal
   * @param logfile Path to the log file, NULL for no file logging
+  * @param file_level The most verbose level written to the log file
   * @return 0 on success, error code on failure
   */
- int logger_init(log_level_t level, const char *logfile);
+ int logger_init(log_level_t level, const char *logfile, log_level_t file_level);
+ 
+ /**
+  * Configuration of the logger, to put it back after changing it
+  */
+ typedef struct {
+     log_level_t level;                  // Terminal level
+     log_level_t file_level;             // Logfile level
+     char logfile[LOGGER_PATH_MAX];      // Path of the logfile, empty for none
+     int async;                          // Async sink running
+ } logger_config_t;
+ 
+ /**
+  * Read the current configuration of the logger
+  * 
+  * @param config Output configuration
+  */
+ void logger_get_config(logger_config_t *config);
+ 
+ /**
+  * Apply a configuration read with logger_get_config. The logfile is
+  * reopened for appending, so its earlier lines are kept.
+  * 
+  * @param config The configuration
+  * @return 0 on success, error code on failure
+  */
+ int logger_set_config(const logger_config_t *config);
  
  /**
   * Close the logger and free resources
@@ -30,12 +74,45 @@
  void logger_close(void);
  
  /**
-  * Set the current logging level
+  * Set the most verbose level printed to the terminal
   * 
   * @param level The new logging level
   */
  void logger_set_level(log_level_t level);
  
+ /**
+  * Whether a message of this level reaches any sink (terminal, logfile or
+  * async sink). Check it before formatting anything expensive for a log
+  * line, or use LOG_ENABLED to include the compile-time level.
+  * 
+  * @param level The logging level
+  * @return 1 if the message would be written, 0 otherwise
+  */
+ int logger_is_enabled(log_level_t level);
+ 
+ /**
+  * Move writing off the logging threads: log_message formats the line into
+  * a slot of a lock-free ring of LOGGER_ASYNC_SLOTS lines and returns, and
+  * a background thread writes the lines to the terminal and logfile. When
+  * the ring is full, lines are dropped and counted, never waited for.
+  * 
+  * @return 0 on success, error code on failure
+  */
+ int logger_start_async(void);
+ 
+ /**
+  * Write the lines still in the ring and stop the background thread
+  * (also done by logger_close)
+  */
+ void logger_stop_async(void);
+ 
+ /**
+  * Lines the async sink dropped because its ring was full
+  * 
+  * @return Number of dropped lines since logger_start_async
+  */
+ uint64_t logger_dropped_lines(void);
+ 
  /**
   * Log a message with the specified level
   * 
@@ -45,9 +122,12 @@
   */
  void log_message(log_level_t level, const char *format, ...);
  
- // Convenience macros
- #define LOG_ERROR(...) log_message(LOG_ERROR, __VA_ARGS__)
- #define LOG_INFO(...) log_message(LOG_INFO, __VA_ARGS__)
- #define LOG_DEBUG(...) log_message(LOG_DEBUG, __VA_ARGS__)
+ // Whether a level is compiled in and reaches a sink
+ #define LOG_ENABLED(level) ((level) <= LOG_MAX_LEVEL && logger_is_enabled(level))
+ 
+ // Convenience macros, the arguments are only evaluated when the level is enabled
+ #define LOG_ERROR(...) do { if (LOG_ENABLED(LOG_ERROR)) log_message(LOG_ERROR, __VA_ARGS__); } while (0)
+ #define LOG_INFO(...) do { if (LOG_ENABLED(LOG_INFO)) log_message(LOG_INFO, __VA_ARGS__); } while (0)
+ #define LOG_DEBUG(...) do { if (LOG_ENABLED(LOG_DEBUG)) log_message(LOG_DEBUG, __VA_ARGS__); } while (0)
  
  #endif /* __LOGGER_H__ */
\ No newline at end of file
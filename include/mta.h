@@ -8,6 +8,14 @@
   
   This implementation uses Correlated OT with bits of the receiver's share
   as choice bits to enable the conversion from multiplicative to additive shares.
+  
+  The canonical schedule runs all MTA_NUM_BITS bits at once in three flows:
+    sender   -> receiver: mta_sender_round1, the OT points A of all bits
+    receiver -> sender:   mta_receiver_round1, the OT points B of all bits
+    sender   -> receiver: mta_sender_round2, the ciphertexts of all bits
+  after which mta_receiver_round2 gives the receiver his share. The per-bit
+  functions run the same protocol one bit at a time and, from the same
+  seeds, produce the same messages and shares.
  */
 
  #ifndef __MTA_H__
@@ -19,10 +27,21 @@
  #include "secp256k1.h"
  #include "base_ot.h"
  #include "cot.h"
+ #include "ot_ext.h"
+ #include "rot_pool.h"
+ #include "prg.h"
+ #include "thread_pool.h"
+ #include "utils.h"
  
  // Set to 256 for full security
  #define MTA_NUM_BITS 256
  
+ // Size of the OT extension matrix the receiver sends for one MtA
+ #define MTA_EXT_MATRIX_LEN OT_EXT_MATRIX_LEN(MTA_NUM_BITS)
+ 
+ // Size of the choice bit flips the receiver sends for one MtA over pooled OTs
+ #define MTA_ROT_FLIPS_LEN OT_EXT_COLUMN_LEN(MTA_NUM_BITS)
+ 
  /**
   * Role in the MtA protocol
   */
@@ -31,6 +50,15 @@
      MTA_ROLE_RECEIVER = 1  // Bob in the protocol
  } mta_role_t;
  
+ // Groups of per-bit fields of mta_context_t written by the protocol
+ // steps, tracked in its dirty mask so that mta_clear wipes only those
+ #define MTA_DIRTY_SENDER_SECRETS (1u << 0) // random_values, shifted_shares, sender_private_keys
+ #define MTA_DIRTY_OT_MSGS        (1u << 1) // sender_msgs, receiver_msgs
+ #define MTA_DIRTY_RECEIVER_KEYS  (1u << 2) // receiver_keys, choice_bits
+ #define MTA_DIRTY_PAYLOADS       (1u << 3) // m0_values, m1_values
+ #define MTA_DIRTY_SENDER_KEYS    (1u << 4) // k0_values, k1_values
+ #define MTA_DIRTY_SIMPLEST       (1u << 5) // simplest_ot
+ 
  /**
   * The MtA protocol context
   */
@@ -38,7 +66,10 @@
      mta_role_t role;                    // Role in the protocol (sender or receiver)
      bignum256 share;                    // The local multiplicative share (a or b)
      bignum256 additive_share;           // The resulting additive share (c or d)
+     scalar_acc_t additive_acc;          // Receiver's running Σ received, reduced once
+     uint8_t seed[PRG_SEED_LEN];         // Seed of all the randomness of this instance
      bignum256 random_values[MTA_NUM_BITS]; // Random values Ui for sender
+     bignum256 shifted_shares[MTA_NUM_BITS]; // x(2^i) for sender, see mta_precompute_shifted_shares
      OT_SenderMessage sender_msgs[MTA_NUM_BITS];   // Sender's messages for each bit
      OT_ReceiverMessage receiver_msgs[MTA_NUM_BITS]; // Receiver's messages for each bit
      bignum256 sender_private_keys[MTA_NUM_BITS];    // Sender's private keys for OT
@@ -48,8 +79,54 @@
      uint8_t k0_values[MTA_NUM_BITS][32];           // k0 values for sender
      uint8_t k1_values[MTA_NUM_BITS][32];           // k1 values for sender
      int choice_bits[MTA_NUM_BITS];                 // Receiver's choice bits
+     base_ot_simplest_sender_t simplest_ot;         // Sender's reused OT key (mta_*_simplest)
+     uint32_t dirty;                                // MTA_DIRTY_* groups written so far
  } mta_context_t;
  
+ /**
+  * A batch of independent MtA instances of the same role, run together
+  * over one OT extension session. All OT messages of the batch are packed
+  * in contiguous buffers, instance k at offset k * MTA_EXT_MATRIX_LEN
+  * (matrix) or k * MTA_NUM_BITS * 32 (corrections).
+  */
+ typedef struct {
+     mta_role_t role;                    // Role of every instance in the batch
+     size_t count;                       // Number of instances
+     bignum256 *shares;                  // Multiplicative shares, one per instance
+     bignum256 *additive_shares;         // Resulting additive shares, one per instance
+     uint8_t (*keys)[32];                // Receiver's pending OT keys (count * MTA_NUM_BITS)
+     size_t memory_len;                  // Size of the single allocation behind the arrays
+ } mta_batch_t;
+ 
+ // Size of the packed receiver matrices for a batch
+ #define MTA_BATCH_MATRIX_LEN(count) ((count) * MTA_EXT_MATRIX_LEN)
+ 
+ // Size of the packed sender corrections for a batch
+ #define MTA_BATCH_CORRECTIONS_LEN(count) ((count) * MTA_NUM_BITS * 32)
+ 
+ // In-flight bits a compact receiver can hold between response and completion
+ #define MTA_COMPACT_WINDOW 8
+ 
+ /**
+  * Compact MtA context for the per-bit protocol (a few hundred bytes
+  * instead of the ~85 KB of mta_context_t). Nothing is stored per bit:
+  * - the sender derives Ui and the base OT key a_i from seed when needed
+  *   and adds Ui to the running share as soon as a bit completes
+  * - the receiver keeps the key of a bit only between its response and
+  *   its completion, in a window of MTA_COMPACT_WINDOW slots
+  */
+ typedef struct {
+     mta_role_t role;                    // Role in the protocol (sender or receiver)
+     bignum256 share;                    // The local multiplicative share (a or b)
+     scalar_acc_t additive_acc;          // Running ΣUi (sender) or Σ received (receiver)
+     uint8_t seed[32];                   // Sender's seed for Ui and a_i
+     bignum256 shifted_share;            // Sender's x(2^shifted_bit), doubled bit to bit
+     int16_t shifted_bit;                // Bit of shifted_share
+     uint8_t done[MTA_NUM_BITS / 8];     // Completed bits, each counted once
+     int16_t pending_bits[MTA_COMPACT_WINDOW];      // Bit held by each slot, -1 if free
+     uint8_t pending_keys[MTA_COMPACT_WINDOW][32];  // Receiver's key per slot
+ } mta_compact_t;
+ 
  /**
   * Initialize an MtA context for a specific role
   * 
@@ -60,6 +137,54 @@
   */
  int mta_init(mta_context_t *ctx, mta_role_t role, const bignum256 *share);
  
+ /**
+  * Initialize an MtA context whose randomness all comes from one seed:
+  * the sender's Ui and base OT keys are drawn in bulk from it, and the
+  * receiver's base OT secret of bit i from its own stream of it. Two runs
+  * with the same seeds and shares produce the same messages.
+  * mta_init calls this with a fresh random seed.
+  * 
+  * @param ctx The MtA context to initialize
+  * @param role The role in the protocol (sender or receiver)
+  * @param share The multiplicative share (a for sender, b for receiver)
+  * @param seed The seed (PRG_SEED_LEN bytes)
+  * @return 0 on success, error code on failure
+  */
+ int mta_init_seeded(mta_context_t *ctx, mta_role_t role, const bignum256 *share,
+                     const uint8_t *seed);
+ 
+ /**
+  * mta_init for a context that is all zero (fresh from calloc, or wiped
+  * by mta_clear): skips clearing the ~85 KB of the context again
+  * 
+  * @param ctx The MtA context to initialize, all zero
+  * @param role The role in the protocol (sender or receiver)
+  * @param share The multiplicative share (a for sender, b for receiver)
+  * @return 0 on success, error code on failure
+  */
+ int mta_init_wiped(mta_context_t *ctx, mta_role_t role, const bignum256 *share);
+ 
+ /**
+  * Wipe the secrets of a context: the scalar fields and the per-bit
+  * fields its dirty mask names, leaving the whole context zero. A
+  * receiver that ran over OT extension wipes ~10 KB instead of ~85 KB.
+  * 
+  * @param ctx The MtA context
+  */
+ void mta_clear(mta_context_t *ctx);
+
+ /**
+  * Sender-side precomputation of the shifted shares x(2^i) mod order for
+  * every bit i. Each entry is the previous one doubled modulo the order, so
+  * the table costs MTA_NUM_BITS modular doublings instead of one modular
+  * multiplication per bit. The sender contexts fill it in mta_init.
+  * 
+  * @param x The sender's multiplicative share
+  * @param shifted Output table (MTA_NUM_BITS entries, fully reduced)
+  * @return 0 on success, error code on failure
+  */
+ int mta_precompute_shifted_shares(const bignum256 *x, bignum256 *shifted);
+ 
  /**
   * Sender (Alice) starts the MtA protocol by generating messages for each bit
   * 
@@ -106,9 +231,372 @@
  int mta_receiver_bit_complete(mta_context_t *ctx, int bit_index, 
                               const uint8_t *m0, const uint8_t *m1);
  
+ /**
+  * Sender (Alice) encrypts m0 and m1 of a bit with the keys derived in
+  * mta_sender_bit_complete, for the receiver's mta_receiver_bit_complete
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_SENDER)
+  * @param bit_index The bit index to process (0 to MTA_NUM_BITS-1)
+  * @param c0 Output encryption of m0 (32 bytes)
+  * @param c1 Output encryption of m1 (32 bytes)
+  * @return 0 on success, error code on failure
+  */
+ int mta_sender_bit_encrypt(mta_context_t *ctx, int bit_index, uint8_t *c0, uint8_t *c1);
+ 
+ /**
+  * Sender (Alice) flow 1: the OT messages of all bits, with the points
+  * of the whole MtA normalized together
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_SENDER)
+  * @param sender_msgs Output sender's messages (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_sender_round1(mta_context_t *ctx, OT_SenderMessage *sender_msgs);
+ 
+ /**
+  * Receiver (Bob) flow 2: answers the sender's messages of all bits
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_RECEIVER)
+  * @param sender_msgs The sender's messages (MTA_NUM_BITS entries)
+  * @param receiver_msgs Output receiver's responses (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_receiver_round1(mta_context_t *ctx, const OT_SenderMessage *sender_msgs,
+                         OT_ReceiverMessage *receiver_msgs);
+ 
+ /**
+  * Sender (Alice) flow 3: derives the keys of all bits, encrypts m0 and m1
+  * with them and computes her additive share
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_SENDER)
+  * @param receiver_msgs The receiver's responses (MTA_NUM_BITS entries)
+  * @param c0 Output encryptions of m0 (MTA_NUM_BITS entries)
+  * @param c1 Output encryptions of m1 (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_sender_round2(mta_context_t *ctx, const OT_ReceiverMessage *receiver_msgs,
+                       uint8_t (*c0)[32], uint8_t (*c1)[32]);
+ 
+ /**
+  * Receiver (Bob) decrypts the chosen message of all bits and computes
+  * his additive share
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_RECEIVER)
+  * @param c0 The encryptions of m0 (MTA_NUM_BITS entries)
+  * @param c1 The encryptions of m1 (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_receiver_round2(mta_context_t *ctx, const uint8_t (*c0)[32], const uint8_t (*c1)[32]);
+ 
+ /**
+  * The three flows over Simplest OT: the sender sends a single OT message
+  * for all bits and derives every key with one point multiplication. The
+  * receiver finishes with mta_receiver_round2 as usual.
+  */
+ 
+ /**
+  * Sender (Alice) flow 1 with one OT key for all bits
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_SENDER)
+  * @param sender_msg Output sender's only message
+  * @return 0 on success, error code on failure
+  */
+ int mta_sender_round1_simplest(mta_context_t *ctx, OT_SenderMessage *sender_msg);
+ 
+ /**
+  * Receiver (Bob) flow 2 against the sender's single message
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_RECEIVER)
+  * @param sender_msg The sender's message
+  * @param receiver_msgs Output receiver's responses (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_receiver_round1_simplest(mta_context_t *ctx, const OT_SenderMessage *sender_msg,
+                                  OT_ReceiverMessage *receiver_msgs);
+ 
+ /**
+  * Sender (Alice) flow 3 with the cached OT key
+  * 
+  * @param ctx The MtA context (after mta_sender_round1_simplest)
+  * @param receiver_msgs The receiver's responses (MTA_NUM_BITS entries)
+  * @param c0 Output encryptions of m0 (MTA_NUM_BITS entries)
+  * @param c1 Output encryptions of m1 (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_sender_round2_simplest(mta_context_t *ctx, const OT_ReceiverMessage *receiver_msgs,
+                                uint8_t (*c0)[32], uint8_t (*c1)[32]);
+ 
+ /**
+  * Parallel execution of the per-bit protocol: each function runs one
+  * phase for all MTA_NUM_BITS bits, sharding the bit indices across the
+  * threads of pool (NULL runs the phase on the calling thread). Phases
+  * follow the per-bit order:
+  *   mta_sender_messages_parallel -> mta_receiver_responses_parallel ->
+  *   mta_sender_complete_parallel -> mta_receiver_complete_parallel
+  * The received values are summed after the threads join and reduced
+  * once, so the result does not depend on the number of threads.
+  */
+ 
+ /**
+  * Sender (Alice) generates the OT messages of all bits
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_SENDER)
+  * @param pool Worker pool, or NULL
+  * @param messages Output sender's messages (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_sender_messages_parallel(mta_context_t *ctx, thread_pool_t *pool,
+                                  OT_SenderMessage *messages);
+ 
+ /**
+  * Receiver (Bob) answers the sender's messages of all bits
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_RECEIVER)
+  * @param pool Worker pool, or NULL
+  * @param sender_msgs The sender's messages (MTA_NUM_BITS entries)
+  * @param receiver_msgs Output receiver's responses (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_receiver_responses_parallel(mta_context_t *ctx, thread_pool_t *pool,
+                                     const OT_SenderMessage *sender_msgs,
+                                     OT_ReceiverMessage *receiver_msgs);
+ 
+ /**
+  * Sender (Alice) derives the keys of all bits, encrypts m0 and m1 with
+  * them and computes her additive share
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_SENDER)
+  * @param pool Worker pool, or NULL
+  * @param receiver_msgs The receiver's responses (MTA_NUM_BITS entries)
+  * @param c0 Output encryptions of m0 (MTA_NUM_BITS entries)
+  * @param c1 Output encryptions of m1 (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_sender_complete_parallel(mta_context_t *ctx, thread_pool_t *pool,
+                                  const OT_ReceiverMessage *receiver_msgs,
+                                  uint8_t (*c0)[32], uint8_t (*c1)[32]);
+ 
+ /**
+  * Receiver (Bob) decrypts the chosen message of all bits and accumulates
+  * his additive share
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_RECEIVER)
+  * @param pool Worker pool, or NULL
+  * @param c0 The encryptions of m0 (MTA_NUM_BITS entries)
+  * @param c1 The encryptions of m1 (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_receiver_complete_parallel(mta_context_t *ctx, thread_pool_t *pool,
+                                    const uint8_t (*c0)[32], const uint8_t (*c1)[32]);
+ 
+ /**
+  * Receiver (Bob) runs all bits at once over an OT extension session,
+  * using the bits of his share as choice bits
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_RECEIVER)
+  * @param ot The OT extension receiver session (base phase completed)
+  * @param matrix Output correction matrix for the sender (MTA_EXT_MATRIX_LEN bytes)
+  * @return 0 on success, error code on failure
+  */
+ int mta_receiver_ext_choose(mta_context_t *ctx, ot_ext_receiver_t *ot, uint8_t *matrix);
+ 
+ /**
+  * Sender (Alice) processes the receiver's matrix and computes one correction
+  * per bit: m0 = Ui is the key for choice 0, and the correction turns the key
+  * for choice 1 into m1 = Ui + x(2^i). Also sets the sender's additive share
+  * -ΣUi, so mta_compute_additive_share is not needed afterwards.
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_SENDER)
+  * @param ot The OT extension sender session (base phase completed)
+  * @param matrix The receiver's correction matrix (MTA_EXT_MATRIX_LEN bytes)
+  * @param corrections Output corrections for the receiver (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_sender_ext_transfer(mta_context_t *ctx, ot_ext_sender_t *ot,
+                             const uint8_t *matrix, uint8_t (*corrections)[32]);
+ 
+ /**
+  * Receiver (Bob) applies the sender's corrections and accumulates his share
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_RECEIVER)
+  * @param corrections The sender's corrections (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure
+  */
+ int mta_receiver_ext_complete(mta_context_t *ctx, const uint8_t (*corrections)[32]);
+ 
+ /**
+  * Receiver (Bob) runs all bits at once over MTA_NUM_BITS pooled random OTs:
+  * flips their random choice bits to the bits of his share. The online
+  * phase does no group operation; the sender's corrections are applied
+  * with mta_receiver_ext_complete.
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_RECEIVER)
+  * @param pool The receiver's random OT pool (MTA_NUM_BITS OTs available)
+  * @param first_index Output sequence number of the first pooled OT used
+  * @param flips Output choice bit flips for the sender (MTA_ROT_FLIPS_LEN bytes)
+  * @return 0 on success, error code on failure
+  */
+ int mta_receiver_rot_choose(mta_context_t *ctx, rot_receiver_pool_t *pool,
+                             uint64_t *first_index, uint8_t *flips);
+ 
+ /**
+  * Sender (Alice) takes the same MTA_NUM_BITS pooled random OTs, applies the
+  * receiver's flips and computes the corrections and the sender's additive
+  * share like mta_sender_ext_transfer
+  * 
+  * @param ctx The MtA context (must be initialized with MTA_ROLE_SENDER)
+  * @param pool The sender's random OT pool (MTA_NUM_BITS OTs available)
+  * @param first_index Sequence number of the receiver's first pooled OT
+  * @param flips The receiver's flips (MTA_ROT_FLIPS_LEN bytes)
+  * @param corrections Output corrections for the receiver (MTA_NUM_BITS entries)
+  * @return 0 on success, error code on failure (e.g. pools out of step)
+  */
+ int mta_sender_rot_transfer(mta_context_t *ctx, rot_sender_pool_t *pool, uint64_t first_index,
+                             const uint8_t *flips, uint8_t (*corrections)[32]);
+ 
+ /**
+  * Initialize a compact MtA context for a specific role
+  * 
+  * @param ctx The compact context to initialize
+  * @param role The role in the protocol (sender or receiver)
+  * @param share The multiplicative share (a for sender, b for receiver)
+  * @return 0 on success, error code on failure
+  */
+ int mta_compact_init(mta_compact_t *ctx, mta_role_t role, const bignum256 *share);
+ 
+ /**
+  * Sender (Alice) generates her OT message for a bit
+  * 
+  * @param ctx The compact context (must be initialized with MTA_ROLE_SENDER)
+  * @param bit_index The bit index to process (0 to MTA_NUM_BITS-1)
+  * @param message Output sender's message for this bit
+  * @return 0 on success, error code on failure
+  */
+ int mta_compact_sender_bit_message(mta_compact_t *ctx, int bit_index, OT_SenderMessage *message);
+ 
+ /**
+  * Receiver (Bob) answers the sender's message for a bit and holds the
+  * derived key in a free window slot
+  * 
+  * @param ctx The compact context (must be initialized with MTA_ROLE_RECEIVER)
+  * @param bit_index The bit index to process (0 to MTA_NUM_BITS-1)
+  * @param sender_msg The sender's message for this bit
+  * @param receiver_msg Output receiver's response message for this bit
+  * @return 0 on success, -3 if every window slot is in use, error code otherwise
+  */
+ int mta_compact_receiver_bit_response(mta_compact_t *ctx, int bit_index,
+                                       const OT_SenderMessage *sender_msg,
+                                       OT_ReceiverMessage *receiver_msg);
+ 
+ /**
+  * Sender (Alice) derives the keys of a bit, encrypts m0 = Ui and
+  * m1 = Ui + x(2^i) and folds Ui into her share
+  * 
+  * @param ctx The compact context (must be initialized with MTA_ROLE_SENDER)
+  * @param bit_index The bit index to process (0 to MTA_NUM_BITS-1)
+  * @param receiver_msg The receiver's response for this bit
+  * @param c0 Output encryption of m0 (32 bytes)
+  * @param c1 Output encryption of m1 (32 bytes)
+  * @return 0 on success, error code on failure
+  */
+ int mta_compact_sender_bit_complete(mta_compact_t *ctx, int bit_index,
+                                     const OT_ReceiverMessage *receiver_msg,
+                                     uint8_t *c0, uint8_t *c1);
+ 
+ /**
+  * Receiver (Bob) decrypts the chosen message of a bit, adds it to his
+  * share and frees the window slot
+  * 
+  * @param ctx The compact context (must be initialized with MTA_ROLE_RECEIVER)
+  * @param bit_index The bit index to process (0 to MTA_NUM_BITS-1)
+  * @param c0 The encryption of m0
+  * @param c1 The encryption of m1
+  * @return 0 on success, error code on failure
+  */
+ int mta_compact_receiver_bit_complete(mta_compact_t *ctx, int bit_index,
+                                       const uint8_t *c0, const uint8_t *c1);
+ 
+ /**
+  * Get the resulting additive share once every bit has completed
+  * 
+  * @param ctx The compact context
+  * @param share The output additive share (c for sender, d for receiver)
+  * @return 0 on success, error code on failure (some bits not completed)
+  */
+ int mta_compact_get_additive_share(const mta_compact_t *ctx, bignum256 *share);
+ 
+ /**
+  * Wipe a compact context
+  * 
+  * @param ctx The compact context
+  */
+ void mta_compact_clear(mta_compact_t *ctx);
+ 
+ /**
+  * Initialize a batch of MtA instances, allocating all its state at once
+  * 
+  * @param batch The batch to initialize
+  * @param role The role of every instance (sender or receiver)
+  * @param shares The multiplicative shares, one per instance
+  * @param count The number of instances
+  * @return 0 on success, error code on failure
+  */
+ int mta_batch_init(mta_batch_t *batch, mta_role_t role,
+                    const bignum256 *shares, size_t count);
+ 
+ /**
+  * Receiver (Bob) extends the OT session for every instance of the batch
+  * 
+  * @param batch The batch (must be initialized with MTA_ROLE_RECEIVER)
+  * @param ot The OT extension receiver session (base phase completed)
+  * @param matrix Output packed matrices (MTA_BATCH_MATRIX_LEN(count) bytes)
+  * @return 0 on success, error code on failure
+  */
+ int mta_batch_receiver_choose(mta_batch_t *batch, ot_ext_receiver_t *ot, uint8_t *matrix);
+ 
+ /**
+  * Sender (Alice) computes the corrections of every instance and her additive shares
+  * 
+  * @param batch The batch (must be initialized with MTA_ROLE_SENDER)
+  * @param ot The OT extension sender session (base phase completed)
+  * @param matrix The receiver's packed matrices (MTA_BATCH_MATRIX_LEN(count) bytes)
+  * @param corrections Output packed corrections (MTA_BATCH_CORRECTIONS_LEN(count) bytes)
+  * @return 0 on success, error code on failure
+  */
+ int mta_batch_sender_transfer(mta_batch_t *batch, ot_ext_sender_t *ot,
+                               const uint8_t *matrix, uint8_t *corrections);
+ 
+ /**
+  * Receiver (Bob) applies the corrections and computes his additive shares
+  * 
+  * @param batch The batch (must be initialized with MTA_ROLE_RECEIVER)
+  * @param corrections The sender's packed corrections (MTA_BATCH_CORRECTIONS_LEN(count) bytes)
+  * @return 0 on success, error code on failure
+  */
+ int mta_batch_receiver_complete(mta_batch_t *batch, const uint8_t *corrections);
+ 
+ /**
+  * Get the resulting additive shares of a batch
+  * 
+  * @param batch The batch
+  * @param shares Output additive shares, one per instance
+  * @return 0 on success, error code on failure
+  */
+ int mta_batch_get_additive_shares(const mta_batch_t *batch, bignum256 *shares);
+ 
+ /**
+  * Wipe and release the state of a batch
+  * 
+  * @param batch The batch
+  */
+ void mta_batch_free(mta_batch_t *batch);
+ 
  /**
  * Compute the final additive share after all bits have been processed
  * 
+ * The per-bit values are summed without reduction as they arrive, this
+ * is where the sum is reduced modulo the order.
+ * 
  * @param ctx The MtA context
  * @param bits_used The number of bits that were processed
  * @return 0 on success, error code on failure
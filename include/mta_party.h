@@ -0,0 +1,84 @@
+/*
+  One party of an MtA over a transport
+
+  Each side runs its half of the per-bit protocol and exchanges the three
+  rounds as wire frames over a transport_t:
+    sender   -> receiver: OT sender messages of every bit
+    receiver -> sender:   OT receiver messages of every bit
+    sender   -> receiver: encrypted m0, m1 of every bit
+  The two sides usually run in different threads or processes.
+
+  mta_party_run_* send each round for all bits at once, so one party
+  always waits while the other computes. The pipelined variants cut the
+  rounds into chunks of bits and keep a window of bits in flight: the
+  sender generates the messages of later chunks while the receiver
+  answers earlier ones, and encrypts a chunk as soon as its responses
+  arrive. The latency stays about 3 round trips (one per round, for the
+  first chunk) while the computations of both parties overlap.
+ */
+
+ #ifndef __MTA_PARTY_H__
+ #define __MTA_PARTY_H__
+
+ #include <stdint.h>
+ #include "mta.h"
+ #include "thread_pool.h"
+ #include "transport.h"
+
+ // Largest frame of a per-bit MtA round
+ #define MTA_PARTY_FRAME_LEN (WIRE_HEADER_LEN + MTA_NUM_BITS * 2 * 32)
+
+ /**
+  * Run the sender (Alice) side of one MtA
+  *
+  * @param ctx The MtA context (initialized with MTA_ROLE_SENDER)
+  * @param t Connection to the receiver
+  * @param pool Worker pool for the per-bit phases (NULL runs the mta_*_round functions)
+  * @param instance_id Id of the MtA instance, checked on every frame
+  * @return 0 on success (the additive share is in ctx), error code otherwise
+  */
+ int mta_party_run_sender(mta_context_t *ctx, transport_t *t, thread_pool_t *pool,
+                          uint64_t instance_id);
+
+ /**
+  * Run the receiver (Bob) side of one MtA
+  *
+  * @param ctx The MtA context (initialized with MTA_ROLE_RECEIVER)
+  * @param t Connection to the sender
+  * @param pool Worker pool for the per-bit phases (NULL runs the mta_*_round functions)
+  * @param instance_id Id of the MtA instance, checked on every frame
+  * @return 0 on success (the additive share is in ctx), error code otherwise
+  */
+ int mta_party_run_receiver(mta_context_t *ctx, transport_t *t, thread_pool_t *pool,
+                            uint64_t instance_id);
+
+ /**
+  * Run the sender (Alice) side of one MtA with pipelined rounds
+  *
+  * At most window bits are in flight (messages sent, ciphertexts not yet),
+  * so the data buffered in the connection stays below window * 97 bytes
+  * per direction and both sides can block on send without deadlocking.
+  *
+  * @param ctx The MtA context (initialized with MTA_ROLE_SENDER)
+  * @param t Connection to the receiver
+  * @param instance_id Id of the MtA instance, checked on every frame
+  * @param window Bits in flight, chunk <= window <= MTA_NUM_BITS
+  * @param chunk Bits per frame
+  * @return 0 on success (the additive share is in ctx), error code otherwise
+  */
+ int mta_party_run_sender_pipelined(mta_context_t *ctx, transport_t *t,
+                                    uint64_t instance_id, int window, int chunk);
+
+ /**
+  * Run the receiver (Bob) side of one MtA with pipelined rounds; the
+  * chunks and window are the sender's, frames are answered as they come
+  *
+  * @param ctx The MtA context (initialized with MTA_ROLE_RECEIVER)
+  * @param t Connection to the sender
+  * @param instance_id Id of the MtA instance, checked on every frame
+  * @return 0 on success (the additive share is in ctx), error code otherwise
+  */
+ int mta_party_run_receiver_pipelined(mta_context_t *ctx, transport_t *t,
+                                      uint64_t instance_id);
+
+ #endif /* __MTA_PARTY_H__ */
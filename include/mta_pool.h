@@ -0,0 +1,83 @@
+/*
+  Pool of MtA sessions
+
+  A service running many short MtA instances would otherwise allocate and
+  clear a whole mta_context_t (~85 KB) for each of them. The pool carves
+  a fixed number of contexts out of one arena, each on its own cache
+  lines, and hands them out and back without calling malloc:
+  - mta_session_acquire takes a free context and initializes it, without
+    clearing it first (it is already zero)
+  - mta_session_release wipes only the fields the session has written
+    (mta_clear) and returns the context to the pool
+
+  Acquire and release may be called from any thread; a session itself is
+  used by one thread at a time, like any mta_context_t.
+ */
+
+ #ifndef __MTA_POOL_H__
+ #define __MTA_POOL_H__
+
+ #include <stddef.h>
+ #include <stdint.h>
+ #include <pthread.h>
+ #include "mta.h"
+
+ // Alignment of the contexts in the arena
+ #define MTA_POOL_ALIGN 64
+
+ /**
+  * The session pool, at the start of its arena
+  */
+ typedef struct {
+     pthread_mutex_t lock;               // Protects the free stack and in_use
+     size_t capacity;                    // Number of contexts
+     size_t stride;                      // Bytes from one context to the next
+     uint8_t *contexts;                  // First context, MTA_POOL_ALIGN aligned
+     size_t *free_slots;                 // Stack of free context indices
+     size_t num_free;                    // Entries on the stack
+     uint8_t *in_use;                    // Per context, set while acquired
+ } mta_pool_t;
+
+ /**
+  * Create a pool and zero all its contexts (the only allocation)
+  *
+  * @param capacity Number of sessions that can be open at once
+  * @return The pool, NULL if capacity is 0 or the arena cannot be allocated
+  */
+ mta_pool_t *mta_pool_create(size_t capacity);
+
+ /**
+  * Free a pool, wiping the contexts of sessions still open
+  *
+  * @param pool The pool (may be NULL)
+  */
+ void mta_pool_destroy(mta_pool_t *pool);
+
+ /**
+  * Take a context from the pool and initialize it like mta_init
+  *
+  * @param pool The pool
+  * @param role The role in the protocol (sender or receiver)
+  * @param share The multiplicative share (a for sender, b for receiver)
+  * @return The session, NULL if the pool is exhausted or on invalid parameters
+  */
+ mta_context_t *mta_session_acquire(mta_pool_t *pool, mta_role_t role, const bignum256 *share);
+
+ /**
+  * Wipe a session and return it to its pool
+  *
+  * @param pool The pool the session was acquired from
+  * @param ctx The session
+  * @return 0 on success, error code if ctx is not an open session of pool
+  */
+ int mta_session_release(mta_pool_t *pool, mta_context_t *ctx);
+
+ /**
+  * Number of sessions that can still be acquired
+  *
+  * @param pool The pool
+  * @return Free contexts
+  */
+ size_t mta_pool_available(mta_pool_t *pool);
+
+ #endif /* __MTA_POOL_H__ */
@@ -0,0 +1,131 @@
+/*
+  IKNP-style Oblivious Transfer Extension
+
+  Runs a fixed set of OT_EXT_KAPPA base OTs once per session (through the
+  base_ot_* API, with the roles reversed) and then expands them with the
+  PRG of a kdf backend into as many random OTs as needed:
+  - Extension receiver (Bob) holds seed pairs (k0_j, k1_j) and a choice bit
+    per extended OT; he learns one 32-byte key per OT
+  - Extension sender (Alice) holds a random string s and the seeds k_{s_j};
+    she learns both 32-byte keys of every OT
+
+  After the base phase every extended OT costs only symmetric crypto.
+  Keys are tweaked with a session-wide OT index, so the same session can be
+  extended any number of times (e.g. once per MtA instance). A session
+  keeps the kdf backend selected at its setup (kdf_set_backend).
+ */
+
+#ifndef __OT_EXT_H__
+#define __OT_EXT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "bignum.h"
+#include "base_ot.h"
+#include "kdf.h"
+
+// Number of base OTs (computational security parameter)
+#define OT_EXT_KAPPA 128
+#define OT_EXT_KAPPA_BYTES (OT_EXT_KAPPA / 8)
+
+// Length of base OT seeds and of extended OT keys
+#define OT_EXT_SEED_LEN 32
+#define OT_EXT_KEY_LEN 32
+
+// Bytes per matrix column when extending num_ots OTs
+#define OT_EXT_COLUMN_LEN(num_ots) (((num_ots) + 7) / 8)
+
+// Size of the correction matrix the receiver sends for num_ots OTs
+#define OT_EXT_MATRIX_LEN(num_ots) (OT_EXT_KAPPA * OT_EXT_COLUMN_LEN(num_ots))
+
+/**
+ * Extension sender state (base OT receiver)
+ */
+typedef struct {
+    uint8_t s[OT_EXT_KAPPA_BYTES];                // Base OT choice bits
+    uint8_t seeds[OT_EXT_KAPPA][OT_EXT_SEED_LEN]; // Chosen seed k_{s_j} per base OT
+    uint64_t prg_counter;                         // PRG blocks consumed per column
+    uint64_t ot_counter;                          // OTs extended so far
+    kdf_backend_t kdf;                            // PRG and hash of the session
+    int ready;                                    // Base phase completed
+} ot_ext_sender_t;
+
+/**
+ * Extension receiver state (base OT sender)
+ */
+typedef struct {
+    bignum256 base_keys[OT_EXT_KAPPA];             // Base OT private keys (wiped after setup)
+    uint8_t seeds0[OT_EXT_KAPPA][OT_EXT_SEED_LEN]; // Seed k0_j per base OT
+    uint8_t seeds1[OT_EXT_KAPPA][OT_EXT_SEED_LEN]; // Seed k1_j per base OT
+    uint64_t prg_counter;                          // PRG blocks consumed per column
+    uint64_t ot_counter;                           // OTs extended so far
+    kdf_backend_t kdf;                             // PRG and hash of the session
+    int ready;                                     // Base phase completed
+} ot_ext_receiver_t;
+
+/**
+ * Receiver starts the base phase by acting as base OT sender
+ *
+ * @param rx Receiver state
+ * @param msgs Output base OT sender messages (OT_EXT_KAPPA entries)
+ * @return 0 on success, error code otherwise
+ */
+int ot_ext_receiver_setup(ot_ext_receiver_t *rx, OT_SenderMessage *msgs);
+
+/**
+ * Sender answers the base phase by acting as base OT receiver
+ * with a random choice string s
+ *
+ * @param tx Sender state
+ * @param msgs Receiver's base OT sender messages (OT_EXT_KAPPA entries)
+ * @param responses Output base OT receiver messages (OT_EXT_KAPPA entries)
+ * @return 0 on success, error code otherwise
+ */
+int ot_ext_sender_setup(ot_ext_sender_t *tx, const OT_SenderMessage *msgs,
+                        OT_ReceiverMessage *responses);
+
+/**
+ * Receiver completes the base phase and derives both seeds of every base OT
+ *
+ * @param rx Receiver state
+ * @param responses Sender's base OT receiver messages (OT_EXT_KAPPA entries)
+ * @return 0 on success, error code otherwise
+ */
+int ot_ext_receiver_setup_complete(ot_ext_receiver_t *rx,
+                                   const OT_ReceiverMessage *responses);
+
+/**
+ * Receiver extends the session by num_ots OTs
+ *
+ * @param rx Receiver state (base phase completed)
+ * @param choices Packed choice bits, bit i is (choices[i / 8] >> (i % 8)) & 1
+ * @param num_ots Number of OTs to extend
+ * @param matrix Output correction matrix (OT_EXT_MATRIX_LEN(num_ots) bytes)
+ * @param keys Output key of the chosen message per OT (num_ots entries)
+ * @return 0 on success, error code otherwise
+ */
+int ot_ext_receiver_extend(ot_ext_receiver_t *rx, const uint8_t *choices,
+                           size_t num_ots, uint8_t *matrix,
+                           uint8_t (*keys)[OT_EXT_KEY_LEN]);
+
+/**
+ * Sender extends the session by num_ots OTs using the receiver's matrix
+ *
+ * @param tx Sender state (base phase completed)
+ * @param matrix Receiver's correction matrix (OT_EXT_MATRIX_LEN(num_ots) bytes)
+ * @param num_ots Number of OTs to extend
+ * @param k0 Output key for choice 0 per OT (num_ots entries)
+ * @param k1 Output key for choice 1 per OT (num_ots entries)
+ * @return 0 on success, error code otherwise
+ */
+int ot_ext_sender_extend(ot_ext_sender_t *tx, const uint8_t *matrix,
+                         size_t num_ots, uint8_t (*k0)[OT_EXT_KEY_LEN],
+                         uint8_t (*k1)[OT_EXT_KEY_LEN]);
+
+/**
+ * Wipe all session secrets
+ */
+void ot_ext_sender_clear(ot_ext_sender_t *tx);
+void ot_ext_receiver_clear(ot_ext_receiver_t *rx);
+
+#endif /* __OT_EXT_H__ */
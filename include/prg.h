@@ -0,0 +1,71 @@
+/*
+  Seeded pseudo-random generator
+
+  Expands a 32-byte seed into an arbitrarily long stream with the vendored
+  ChaCha20 DRBG (chacha_drbg). Several independent streams can be drawn
+  from one seed by giving each a different stream id, so that e.g. all the
+  randomness of an MtA instance comes from a single seed and a run can be
+  replayed from it.
+ */
+
+ #ifndef __PRG_H__
+ #define __PRG_H__
+ 
+ #include <stdint.h>
+ #include <stddef.h>
+ #include "bignum.h"
+ #include "chacha_drbg.h"
+ 
+ // Length of a PRG seed
+ #define PRG_SEED_LEN 32
+ 
+ /**
+  * PRG state
+  */
+ typedef struct {
+     CHACHA_DRBG_CTX drbg;               // ChaCha20 DRBG keyed from seed and stream id
+ } prg_t;
+ 
+ /**
+  * Key a PRG from a seed and a stream id
+  * 
+  * @param prg The PRG state to initialize
+  * @param seed The seed (PRG_SEED_LEN bytes)
+  * @param stream Stream id, different ids give independent streams
+  */
+ void prg_init(prg_t *prg, const uint8_t *seed, uint32_t stream);
+ 
+ /**
+  * Fill a buffer with the next bytes of the stream
+  * 
+  * @param prg The PRG state
+  * @param out Output buffer
+  * @param len Number of bytes, any length
+  */
+ void prg_fill(prg_t *prg, uint8_t *out, size_t len);
+ 
+ /**
+  * Draw count scalars modulo the curve order with a single fill
+  * 
+  * @param prg The PRG state
+  * @param out Output scalars (count entries)
+  * @param count Number of scalars
+  */
+ void prg_scalars(prg_t *prg, bignum256 *out, size_t count);
+ 
+ /**
+  * Draw a scalar in the range [1, order-1]
+  * 
+  * @param prg The PRG state
+  * @param out Output scalar
+  */
+ void prg_nonzero_scalar(prg_t *prg, bignum256 *out);
+ 
+ /**
+  * Wipe a PRG state
+  * 
+  * @param prg The PRG state
+  */
+ void prg_clear(prg_t *prg);
+ 
+ #endif /* __PRG_H__ */
@@ -0,0 +1,134 @@
+/*
+  Pools of precomputed random OTs
+
+  The offline phase extends an OT extension session with random choice
+  bits and stores the results:
+  - Receiver pool (Bob): a random bit r and the key k_r per OT
+  - Sender pool (Alice): both keys k0, k1 per OT
+
+  The online phase turns pooled random OTs into OTs on chosen bits with
+  Beaver's derandomization: for a choice bit c Bob sends the flip
+  e = c ^ r, Alice uses (k_e, k_{1-e}) as the keys of choice 0 and 1, and
+  Bob's k_r is the key of his choice c. This costs a few XORs per OT and
+  one bit of communication, no PRG, hash or group operation.
+
+  Both pools consume their OTs in the order they were filled; every OT has
+  a sequence number so that the two parties can check they use the same
+  ones. Every pooled OT is used once and wiped when taken. A pool is not
+  synchronized: fill it between MtAs (idle time), not while taking from it.
+ */
+
+#ifndef __ROT_POOL_H__
+#define __ROT_POOL_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ot_ext.h"
+
+/**
+ * Receiver pool: random choice bits and the keys of the chosen messages
+ */
+typedef struct {
+    size_t capacity;                   // Maximum number of pooled OTs
+    size_t head;                       // First unused OT
+    size_t tail;                       // One past the last pooled OT
+    uint64_t next_index;               // Sequence number of the OT at head
+    uint8_t *choices;                  // Random choice bit r per OT
+    uint8_t (*keys)[OT_EXT_KEY_LEN];   // Key k_r per OT
+} rot_receiver_pool_t;
+
+/**
+ * Sender pool: both keys of every OT
+ */
+typedef struct {
+    size_t capacity;                   // Maximum number of pooled OTs
+    size_t head;                       // First unused OT
+    size_t tail;                       // One past the last pooled OT
+    uint64_t next_index;               // Sequence number of the OT at head
+    uint8_t (*keys0)[OT_EXT_KEY_LEN];  // Key k0 per OT
+    uint8_t (*keys1)[OT_EXT_KEY_LEN];  // Key k1 per OT
+} rot_sender_pool_t;
+
+/**
+ * Allocate an empty pool
+ *
+ * @param pool The pool
+ * @param capacity Maximum number of pooled OTs
+ * @return 0 on success, error code otherwise
+ */
+int rot_receiver_pool_init(rot_receiver_pool_t *pool, size_t capacity);
+int rot_sender_pool_init(rot_sender_pool_t *pool, size_t capacity);
+
+/**
+ * Receiver adds count random OTs to the pool (offline phase)
+ *
+ * @param pool The pool (room for count more OTs)
+ * @param ot Receiver state of an OT extension session (base phase completed)
+ * @param count Number of OTs to add
+ * @param matrix Output correction matrix for the sender (OT_EXT_MATRIX_LEN(count) bytes)
+ * @return 0 on success, error code otherwise
+ */
+int rot_receiver_pool_fill(rot_receiver_pool_t *pool, ot_ext_receiver_t *ot,
+                           size_t count, uint8_t *matrix);
+
+/**
+ * Sender adds count random OTs to the pool (offline phase)
+ *
+ * @param pool The pool (room for count more OTs)
+ * @param ot Sender state of the same OT extension session
+ * @param matrix Receiver's correction matrix (OT_EXT_MATRIX_LEN(count) bytes)
+ * @param count Number of OTs to add
+ * @return 0 on success, error code otherwise
+ */
+int rot_sender_pool_fill(rot_sender_pool_t *pool, ot_ext_sender_t *ot,
+                         const uint8_t *matrix, size_t count);
+
+/**
+ * Number of pooled OTs not used yet
+ *
+ * @param pool The pool
+ * @return Available OTs
+ */
+size_t rot_receiver_pool_available(const rot_receiver_pool_t *pool);
+size_t rot_sender_pool_available(const rot_sender_pool_t *pool);
+
+/**
+ * Receiver takes count OTs from the pool for the given choice bits
+ * (online phase)
+ *
+ * @param pool The pool (at least count OTs available)
+ * @param choices Packed choice bits, bit i is (choices[i / 8] >> (i % 8)) & 1
+ * @param count Number of OTs
+ * @param first_index Output sequence number of the first OT taken
+ * @param flips Output packed flips e = c ^ r for the sender (OT_EXT_COLUMN_LEN(count) bytes)
+ * @param keys Output key of the chosen message per OT (count entries)
+ * @return 0 on success, error code otherwise
+ */
+int rot_receiver_pool_derandomize(rot_receiver_pool_t *pool, const uint8_t *choices,
+                                  size_t count, uint64_t *first_index, uint8_t *flips,
+                                  uint8_t (*keys)[OT_EXT_KEY_LEN]);
+
+/**
+ * Sender takes count OTs from the pool and applies the receiver's flips
+ * (online phase)
+ *
+ * @param pool The pool (at least count OTs available)
+ * @param first_index Sequence number the receiver started at
+ * @param flips Receiver's packed flips (OT_EXT_COLUMN_LEN(count) bytes)
+ * @param count Number of OTs
+ * @param k0 Output key for choice 0 per OT (count entries)
+ * @param k1 Output key for choice 1 per OT (count entries)
+ * @return 0 on success, error code if the pools are out of step or empty
+ */
+int rot_sender_pool_derandomize(rot_sender_pool_t *pool, uint64_t first_index,
+                                const uint8_t *flips, size_t count,
+                                uint8_t (*k0)[OT_EXT_KEY_LEN],
+                                uint8_t (*k1)[OT_EXT_KEY_LEN]);
+
+/**
+ * Wipe and release a pool
+ */
+void rot_receiver_pool_free(rot_receiver_pool_t *pool);
+void rot_sender_pool_free(rot_sender_pool_t *pool);
+
+#endif /* __ROT_POOL_H__ */
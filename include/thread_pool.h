@@ -0,0 +1,81 @@
+/*
+  Fixed-size worker pool for data-parallel loops
+
+  A job is a range of indices [0, count) split into one contiguous shard
+  per thread. The calling thread works on shards too, so a pool of
+  num_threads threads starts num_threads - 1 workers. Jobs are run one at
+  a time and thread_pool_run returns once every shard is done.
+ */
+
+ #ifndef __THREAD_POOL_H__
+ #define __THREAD_POOL_H__
+
+ #include <stddef.h>
+ #include <stdint.h>
+ #include <pthread.h>
+
+ // Upper bound on the number of threads of a pool
+ #define THREAD_POOL_MAX_THREADS 256
+
+ /**
+  * Work function run on the indices [begin, end) of a job
+  *
+  * @param arg The job argument given to thread_pool_run
+  * @param begin First index of the shard
+  * @param end One past the last index of the shard
+  * @return 0 on success, error code otherwise
+  */
+ typedef int (*thread_pool_fn)(void *arg, size_t begin, size_t end);
+
+ /**
+  * The worker pool
+  */
+ typedef struct {
+     int num_threads;                    // Threads working on a job, caller included
+     pthread_t *workers;                 // num_threads - 1 worker threads
+     pthread_mutex_t lock;               // Protects everything below
+     pthread_cond_t work_ready;          // Signalled when a job is posted or on shutdown
+     pthread_cond_t work_done;           // Signalled when the last shard completes
+     thread_pool_fn fn;                  // Current job
+     void *arg;
+     size_t count;                       // Indices of the current job
+     size_t num_shards;                  // Shards of the current job
+     size_t next_shard;                  // Next shard to hand out
+     size_t pending;                     // Shards not completed yet
+     size_t failed_shard;                // Lowest failing shard, num_shards if none
+     int result;                         // Result of failed_shard
+     uint64_t generation;                // Incremented for every job
+     int shutdown;                       // Set when the pool is freed
+ } thread_pool_t;
+
+ /**
+  * Start a pool
+  *
+  * @param pool The pool to initialize
+  * @param num_threads Threads per job including the caller (1 runs jobs inline)
+  * @return 0 on success, error code otherwise
+  */
+ int thread_pool_init(thread_pool_t *pool, int num_threads);
+
+ /**
+  * Run fn over [0, count) on every thread of the pool and wait for it
+  *
+  * Shard s covers [s * count / n, (s + 1) * count / n) with n shards, so the
+  * split only depends on count and the number of threads.
+  *
+  * @param pool The pool
+  * @param count Number of indices
+  * @param fn Work function
+  * @param arg Argument passed to fn
+  * @return 0 on success, otherwise the error of the lowest failing shard
+  */
+ int thread_pool_run(thread_pool_t *pool, size_t count, thread_pool_fn fn, void *arg);
+
+ /**
+  * Stop the workers and release the pool
+  *
+  * @param pool The pool
+  */
+ void thread_pool_free(thread_pool_t *pool);
+
+ #endif /* __THREAD_POOL_H__ */
@@ -0,0 +1,118 @@
+/*
+  Byte transport between the two parties
+
+  A transport_t is a pair of send/recv callbacks over some connection
+  state. Backends:
+  - loopback: an in-process queue, for two threads of one process
+  - socket: any connected stream socket; transport_socketpair and
+    transport_tcp_pair create a connected pair (AF_UNIX or TCP over
+    127.0.0.1), transport_fd wraps a socket connected by the caller
+    (e.g. to another process)
+
+  Whole protocol rounds are exchanged as wire frames (wire.h) with
+  transport_send_frame / transport_recv_frame.
+ */
+
+ #ifndef __TRANSPORT_H__
+ #define __TRANSPORT_H__
+
+ #include <stdint.h>
+ #include <stddef.h>
+ #include "wire.h"
+
+ // Bytes a loopback direction buffers before send blocks
+ #define TRANSPORT_LOOPBACK_CAPACITY (64 * 1024)
+
+ /**
+  * A connection to the other party
+  */
+ typedef struct {
+     int (*send)(void *state, const uint8_t *buf, size_t len);  // Sends all of buf
+     int (*recv)(void *state, uint8_t *buf, size_t len);        // Receives exactly len bytes
+     void (*close)(void *state);                                // Releases state
+     void *state;                        // Backend state
+     uint64_t bytes_sent;                // Counters for the caller's statistics
+     uint64_t bytes_received;
+ } transport_t;
+
+ /**
+  * Create two connected in-process endpoints
+  *
+  * @param a Output first endpoint
+  * @param b Output second endpoint
+  * @return 0 on success, error code otherwise
+  */
+ int transport_loopback_pair(transport_t *a, transport_t *b);
+
+ /**
+  * Create two endpoints connected by a Unix socketpair
+  *
+  * @param a Output first endpoint
+  * @param b Output second endpoint
+  * @return 0 on success, error code otherwise
+  */
+ int transport_socketpair(transport_t *a, transport_t *b);
+
+ /**
+  * Create two endpoints connected over TCP on 127.0.0.1 (Nagle disabled)
+  *
+  * @param a Output first endpoint (connecting side)
+  * @param b Output second endpoint (accepting side)
+  * @return 0 on success, error code otherwise
+  */
+ int transport_tcp_pair(transport_t *a, transport_t *b);
+
+ /**
+  * Use a connected stream socket as transport, closed with the transport
+  *
+  * @param t Output endpoint
+  * @param fd The socket
+  * @return 0 on success, error code otherwise
+  */
+ int transport_fd(transport_t *t, int fd);
+
+ /**
+  * Send len bytes
+  *
+  * @return 0 on success, error code otherwise
+  */
+ int transport_send(transport_t *t, const uint8_t *buf, size_t len);
+
+ /**
+  * Receive exactly len bytes
+  *
+  * @return 0 on success, error code otherwise (also if the peer closed)
+  */
+ int transport_recv(transport_t *t, uint8_t *buf, size_t len);
+
+ /**
+  * Send a frame built with wire_frame_begin
+  *
+  * @param t The transport
+  * @param frame The frame, starting with its header
+  * @return 0 on success, error code otherwise
+  */
+ int transport_send_frame(transport_t *t, const uint8_t *frame);
+
+ /**
+  * Receive one frame into buf and parse it in place
+  *
+  * @param t The transport
+  * @param buf Receive buffer
+  * @param buf_len Size of buf
+  * @param header Output header
+  * @param payload Output pointer to the payload inside buf
+  * @return 0 on success, error code otherwise (also if the frame is
+  *         malformed or larger than buf)
+  */
+ int transport_recv_frame(transport_t *t, uint8_t *buf, size_t buf_len,
+                          wire_header_t *header, const uint8_t **payload);
+
+ /**
+  * Close the connection and release the endpoint
+  *
+  * @param t The transport
+  */
+ void transport_close(transport_t *t);
+
+ #endif /* __TRANSPORT_H__ */
@@ -10,6 +10,20 @@
 #include "sha2.h"
 #include "secp256k1.h"
 
+// Additions a scalar_acc_t takes before it reduces on its own
+#define SCALAR_ACC_MAX_ADDS (1u << 24)
+
+/**
+ * Sum of many scalars modulo the curve order, reduced once at the end
+ * 
+ * The 29-bit limbs of every added value are summed into 64-bit limbs
+ * without carrying, so an addition is BN_LIMBS integer additions.
+ */
+typedef struct {
+    uint64_t val[BN_LIMBS];             // Limb-wise sums, not carried
+    uint32_t count;                     // Values added since the last reduction
+} scalar_acc_t;
+
 /**
  * Generate a random scalar in the range [1, order-1]
  * 
@@ -25,7 +39,7 @@ void generate_random_nonzero_scalar(bignum256 *scalar);
 void generate_random_bignum(bignum256 *num);
 
 /**
- * Derive a key from an elliptic curve point using SHA-256
+ * Derive a key from an elliptic curve point with kdf_hash (SHA-256 by default)
  * 
  * @param point The input elliptic curve point
  * @param key The output key (32 bytes)
@@ -33,11 +47,24 @@ void generate_random_bignum(bignum256 *num);
 void derive_key_from_point(const curve_point *point, uint8_t *key);
 
 /**
- * Encrypt or decrypt data using SHA-256 and XOR
+ * derive_key_from_point for count points, hashed 8 at a time
+ * 
+ * @param points The input points (count entries)
+ * @param count Number of points
+ * @param keys The output keys (count entries)
+ */
+void derive_keys_from_points(const curve_point *points, size_t count, uint8_t (*keys)[32]);
+
+/**
+ * Encrypt or decrypt data using SHA-256 in counter mode and XOR
+ * 
+ * The keystream is SHA-256(key || 0) || SHA-256(key || 1) || ..., with a
+ * 64-bit big-endian counter, so any length can be encrypted under one key
+ * without reusing keystream.
  * 
  * @param data Data to encrypt/decrypt (in-place)
- * @param key Key to use for encryption/decryption
- * @param data_len Length of the data
+ * @param key Key to use for encryption/decryption (32 bytes)
+ * @param data_len Length of the data, any length
  */
 void sha256_xor_crypt(uint8_t *data, const uint8_t *key, size_t data_len);
 
@@ -84,4 +111,27 @@ int get_bit(const bignum256 *num, int bit_index);
  */
 void pow2_bignum(int i, bignum256 *result);
 
+/**
+ * Start an empty sum
+ * 
+ * @param acc The accumulator to initialize
+ */
+void scalar_acc_init(scalar_acc_t *acc);
+
+/**
+ * Add a scalar to the sum without reducing it
+ * 
+ * @param acc The accumulator
+ * @param x Normalized value to add
+ */
+void scalar_acc_add(scalar_acc_t *acc, const bignum256 *x);
+
+/**
+ * Reduce the sum modulo the curve order, the sum itself is kept
+ * 
+ * @param acc The accumulator
+ * @param result Output sum, fully reduced
+ */
+void scalar_acc_get(const scalar_acc_t *acc, bignum256 *result);
+
 #endif /* __UTILS_H__ */
\ No newline at end of file
@@ -0,0 +1,188 @@
+/*
+  Wire format for the messages of one protocol round
+
+  A frame is a fixed header followed by the packed messages of a range of
+  bits, for one or more consecutive MtA instances:
+
+    offset  size  field
+         0     2  magic "MT"
+         2     1  version (WIRE_VERSION)
+         3     1  message type (wire_type_t)
+         4     8  instance id of the first instance
+        12     4  number of instances
+        16     2  first bit
+        18     2  number of bits per instance
+        20     4  payload length
+        24     -  payload
+
+  Integers are big-endian. The payload packs the instances one after the
+  other, with the layout the protocol functions use in memory:
+  - OT sender / receiver messages: num_bits compressed points of 33 bytes
+    per instance
+  - Ciphertexts: the c0 of every bit of every instance (32 bytes each),
+    then the c1 in the same order
+  - OT extension matrix: OT_EXT_MATRIX_LEN(num_bits) bytes per instance
+  - OT extension corrections: num_bits values of 32 bytes per instance
+
+  Nothing is marshalled in between: a sender gets a pointer to the payload
+  inside its buffer and lets the protocol functions write there, and a
+  receiver gets typed pointers into the received buffer.
+ */
+
+ #ifndef __WIRE_H__
+ #define __WIRE_H__
+
+ #include <stdint.h>
+ #include <stddef.h>
+ #include "base_ot.h"
+ #include "ot_ext.h"
+ #include "mta.h"
+
+ #define WIRE_MAGIC 0x4d54
+ #define WIRE_VERSION 1
+ #define WIRE_HEADER_LEN 24
+
+ /**
+  * Message type of a frame
+  */
+ typedef enum {
+     WIRE_OT_SENDER_MSGS = 1,            // OT_SenderMessage per bit
+     WIRE_OT_RECEIVER_MSGS = 2,          // OT_ReceiverMessage per bit
+     WIRE_CIPHERTEXTS = 3,               // Encrypted m0 and m1 per bit
+     WIRE_EXT_MATRIX = 4,                // OT extension correction matrix
+     WIRE_EXT_CORRECTIONS = 5            // MtA corrections over OT extension
+ } wire_type_t;
+
+ /**
+  * Decoded frame header
+  */
+ typedef struct {
+     uint8_t version;                    // Format version
+     wire_type_t type;                   // Message type
+     uint64_t instance_id;               // Id of the first instance
+     uint32_t num_instances;             // Consecutive instances in the frame
+     uint16_t first_bit;                 // First bit of the range
+     uint16_t num_bits;                  // Bits per instance
+     uint32_t payload_len;               // Bytes after the header
+ } wire_header_t;
+
+ /**
+  * Size of the payload for a message type
+  *
+  * @param type Message type
+  * @param num_instances Number of instances
+  * @param num_bits Bits per instance
+  * @return Payload length in bytes, 0 if the type is unknown or the
+  *         payload does not fit in a frame
+  */
+ size_t wire_payload_len(wire_type_t type, uint32_t num_instances, uint16_t num_bits);
+
+ /**
+  * Size of a whole frame (header and payload)
+  */
+ size_t wire_frame_len(wire_type_t type, uint32_t num_instances, uint16_t num_bits);
+
+ /**
+  * Write a frame header and hand out its payload area to be filled in place
+  *
+  * @param buf Output buffer
+  * @param buf_len Size of buf, at least wire_frame_len of the frame
+  * @param type Message type
+  * @param instance_id Id of the first instance
+  * @param num_instances Number of instances (at least 1)
+  * @param first_bit First bit of the range
+  * @param num_bits Bits per instance (first_bit + num_bits <= MTA_NUM_BITS)
+  * @param payload Output pointer to the payload inside buf
+  * @return 0 on success, error code otherwise
+  */
+ int wire_frame_begin(uint8_t *buf, size_t buf_len, wire_type_t type,
+                      uint64_t instance_id, uint32_t num_instances,
+                      uint16_t first_bit, uint16_t num_bits, uint8_t **payload);
+
+ /**
+  * Parse and check a frame header, without copying the payload
+  *
+  * @param buf Received buffer, starting with the frame
+  * @param buf_len Bytes available in buf (may be more than the frame)
+  * @param header Output header
+  * @param payload Output pointer to the payload inside buf
+  * @return 0 on success, -2 if the frame is truncated, other error code
+  *         if it is malformed. When only the payload is missing, header is
+  *         filled before -2 is returned, so a reader can parse the header
+  *         alone to learn the frame length.
+  */
+ int wire_frame_parse(const uint8_t *buf, size_t buf_len, wire_header_t *header,
+                      const uint8_t **payload);
+
+ /**
+  * Encode the OT sender messages of a bit range of one instance
+  *
+  * @param buf Output buffer
+  * @param buf_len Size of buf
+  * @param instance_id Id of the instance
+  * @param first_bit First bit of the range
+  * @param num_bits Number of bits
+  * @param msgs Messages of the range (num_bits entries)
+  * @return 0 on success, error code otherwise
+  */
+ int wire_encode_sender_msgs(uint8_t *buf, size_t buf_len, uint64_t instance_id,
+                             uint16_t first_bit, uint16_t num_bits,
+                             const OT_SenderMessage *msgs);
+
+ /**
+  * Same for the OT receiver messages of a bit range of one instance
+  */
+ int wire_encode_receiver_msgs(uint8_t *buf, size_t buf_len, uint64_t instance_id,
+                               uint16_t first_bit, uint16_t num_bits,
+                               const OT_ReceiverMessage *msgs);
+
+ /**
+  * Encode the ciphertexts of a bit range of one instance
+  *
+  * @param c0 Encrypted m0 per bit (num_bits entries)
+  * @param c1 Encrypted m1 per bit (num_bits entries)
+  * @return 0 on success, error code otherwise
+  */
+ int wire_encode_ciphertexts(uint8_t *buf, size_t buf_len, uint64_t instance_id,
+                             uint16_t first_bit, uint16_t num_bits,
+                             const uint8_t (*c0)[32], const uint8_t (*c1)[32]);
+
+ /**
+  * Decode a frame of OT sender messages
+  *
+  * @param buf Received buffer
+  * @param buf_len Bytes available in buf
+  * @param header Output header
+  * @param msgs Output pointer to the messages inside buf
+  * @return 0 on success, error code otherwise (also for another type)
+  */
+ int wire_decode_sender_msgs(const uint8_t *buf, size_t buf_len, wire_header_t *header,
+                             const OT_SenderMessage **msgs);
+
+ /**
+  * Decode a frame of OT receiver messages
+  */
+ int wire_decode_receiver_msgs(const uint8_t *buf, size_t buf_len, wire_header_t *header,
+                               const OT_ReceiverMessage **msgs);
+
+ /**
+  * Decode a frame of ciphertexts, instance k starts at
+  * k * header->num_bits in both arrays
+  *
+  * @param c0 Output pointer to the c0 block of the first instance
+  * @param c1 Output pointer to the c1 block of the first instance
+  */
+ int wire_decode_ciphertexts(const uint8_t *buf, size_t buf_len, wire_header_t *header,
+                             const uint8_t (**c0)[32], const uint8_t (**c1)[32]);
+
+ /**
+  * Decode a frame of OT extension matrices or MtA corrections, packed
+  * as the mta_batch_* functions expect them
+  *
+  * @param type WIRE_EXT_MATRIX or WIRE_EXT_CORRECTIONS
+  * @param data Output pointer to the packed data inside buf
+  */
+ int wire_decode_ext(const uint8_t *buf, size_t buf_len, wire_type_t type,
+                     wire_header_t *header, const uint8_t **data);
+
+ #endif /* __WIRE_H__ */
@@ -11,12 +11,137 @@ int main() {
     srand(time(NULL));
     random_reseed(rand());
     
-    // Initialize the logger - LOG_INFO for terminal, full debug in file
-    logger_init(LOG_INFO, "activity.log");
+    // Initialize the logger - LOG_INFO for terminal and file. A LOG_DEBUG
+    // file level adds the per-OT lines, at the cost of formatting every one.
+    logger_init(LOG_INFO, "activity.log", LOG_INFO);
+    
+    // Write the log from a background thread, the lines of the protocol
+    // threads would otherwise be written under their stream locks
+    logger_start_async();
     
     // Run the full MtA protocol test
     int result = run_mta_full_test();
     
+    // Run the MtA protocol over an OT extension session
+    if (result == 0) {
+        result = run_mta_ot_ext_test();
+    }
+    
+    // Run a batch of MtA instances over one session
+    if (result == 0) {
+        result = run_mta_batch_test();
+    }
+    
+    // Run one MtA with its bits spread over worker threads
+    if (result == 0) {
+        result = run_mta_parallel_test(4);
+    }
+    
+    // Run one MtA with the compact contexts
+    if (result == 0) {
+        result = run_mta_compact_test();
+    }
+    
+    // Replay an MtA from fixed seeds
+    if (result == 0) {
+        result = run_mta_seeded_test();
+    }
+    
+    // All bits at once in three flows
+    if (result == 0) {
+        result = run_mta_rounds_test();
+    }
+    
+    // One OT sender key for all bits
+    if (result == 0) {
+        result = run_mta_simplest_test();
+    }
+    
+    // Agree on the OT keys over Curve25519
+    if (result == 0) {
+        result = run_base_ot_curve25519_test();
+    }
+    
+    // Carry a vector of scalars in a single base OT
+    if (result == 0) {
+        result = run_base_ot_vector_test();
+    }
+    
+    // Sum scalars with a single reduction
+    if (result == 0) {
+        result = run_scalar_acc_test();
+    }
+    
+    // Build x(2^i) by doubling
+    if (result == 0) {
+        result = run_shifted_shares_test();
+    }
+    
+    // Sum several point multiplications over one doubling chain
+    if (result == 0) {
+        result = run_multi_point_test();
+    }
+    
+    // Compare the variable-base engines with trezor's point_multiply
+    if (result == 0) {
+        result = run_point_multiply_diff_test();
+    }
+    
+    // Compare the comb engine with trezor's scalar_multiply and point_multiply
+    if (result == 0) {
+        result = run_comb_multiply_diff_test();
+    }
+    
+    // Compare the batch conversion with one inversion per point
+    if (result == 0) {
+        result = run_batch_to_affine_diff_test();
+    }
+    
+    // Compare bn_multiply modulo p and n with the generic reduction
+    if (result == 0) {
+        result = run_bn_multiply_diff_test();
+    }
+    
+    // Hash with the CPU's SHA-256 instructions, 8 messages at a time
+    if (result == 0) {
+        result = run_sha256_test();
+    }
+    
+    // Derive the OT keys with BLAKE2s and fixed-key AES as well
+    if (result == 0) {
+        result = run_kdf_test();
+    }
+    
+    // Exchange the rounds as wire frames
+    if (result == 0) {
+        result = run_wire_test();
+    }
+    
+    // Run the parties in two threads over real transports
+    if (result == 0) {
+        result = run_mta_two_party_test();
+    }
+    
+    // Overlap the rounds of both parties
+    if (result == 0) {
+        result = run_mta_pipelined_test();
+    }
+    
+    // Reuse sessions from a pool
+    if (result == 0) {
+        result = run_mta_pool_test();
+    }
+    
+    // Precompute random OTs offline, derandomize them online
+    if (result == 0) {
+        result = run_rot_pool_test();
+    }
+    
+    // Check the async log sink, through a scratch log file
+    if (result == 0) {
+        result = run_logger_async_test();
+    }
+    
     // Close the logger
     logger_close();
     
@@ -6,9 +6,43 @@
 #include <stdlib.h>
 #include <string.h>
 #include "base_ot.h"
+#include "base_ot_25519.h"
 #include "point_ops.h"  
 #include "logger.h"
+#include "memzero.h"
 #include "utils.h"
+#include "kdf.h"
+
+// Lowercase hex of len bytes into out (2 * len + 1 chars), for debug lines
+static void hex_string(const uint8_t *in, size_t len, char *out) {
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < len; i++) {
+        out[2 * i] = digits[in[i] >> 4];
+        out[2 * i + 1] = digits[in[i] & 15];
+    }
+    out[2 * len] = '\0';
+}
+
+static base_ot_backend_t backend = BASE_OT_DEFAULT_BACKEND;
+
+int base_ot_set_backend(base_ot_backend_t new_backend) {
+    if (new_backend != BASE_OT_BACKEND_SECP256K1 && new_backend != BASE_OT_BACKEND_CURVE25519) {
+        LOG_ERROR("Invalid parameters in base_ot_set_backend");
+        return -1;
+    }
+    backend = new_backend;
+    return 0;
+}
+
+base_ot_backend_t base_ot_get_backend(void) {
+    return backend;
+}
+
+// Compressed SEC encoding of an affine point
+static void compress_point(const curve_point *p, uint8_t out[33]) {
+    out[0] = 0x02 | (p->y.val[0] & 1);
+    bn_write_be(&p->x, out + 1);
+}
 
 int base_ot_init_sender(const uint8_t *m0, const uint8_t *m1, 
                         OT_SenderMessage *message, bignum256 *a) {
@@ -20,50 +54,77 @@ int base_ot_init_sender(const uint8_t *m0, const uint8_t *m1,
     // Generate a random private key a
     generate_random_nonzero_scalar(a);
     
-    // Compute A = a·G (public key) using optimized scalar multiplication
-    curve_point A;
-    int res = opt_scalar_multiply(&secp256k1, a, &A);
+    // Compute A = a·G (public key) in the current backend
+    if (base_ot_sender_message(a, message) != 0) {
+        return -2;
+    }
     
-    if (res != 1) {
+    // Debug output, only formatted when someone reads it
+    if (LOG_ENABLED(LOG_DEBUG)) {
+        uint8_t a_bytes[32];
+        char hex_buffer[65];
+        bn_write_be(a, a_bytes);
+        hex_string(a_bytes, 32, hex_buffer);
+        LOG_DEBUG("Alice's secret a: %s", hex_buffer);
+        memzero(a_bytes, sizeof(a_bytes));
+        
+        // Log messages before encryption
+        hex_string(m0, 32, hex_buffer);
+        LOG_DEBUG("Alice's message m0: %s", hex_buffer);
+        hex_string(m1, 32, hex_buffer);
+        LOG_DEBUG("Alice's message m1: %s", hex_buffer);
+    }
+    
+    return 0;
+}
+
+int base_ot_sender_message(const bignum256 *a, OT_SenderMessage *message) {
+    if (!a || !message || bn_is_zero(a)) {
+        LOG_ERROR("Invalid parameters in base_ot_sender_message");
+        return -1;
+    }
+    
+    if (backend == BASE_OT_BACKEND_CURVE25519) {
+        return base_ot_25519_sender_message_batch(1, a, message);
+    }
+    
+    curve_point A;
+    if (opt_scalar_multiply(&secp256k1, a, &A) != 1) {
         LOG_ERROR("Failed to compute A = a·G");
         return -2;
     }
     
-    // Compress point A
-    message->A_compressed[0] = 0x02 | (A.y.val[0] & 1);  // Set prefix based on y parity
-    bn_write_be(&A.x, message->A_compressed + 1);
-    
-    // Debug output
-    uint8_t a_bytes[32];
-    bn_write_be(a, a_bytes);
-    char hex_buffer[65];
-    for (int i = 0; i < 32; i++) {
-        sprintf(hex_buffer + (i * 2), "%02x", a_bytes[i]);
-    }
-    LOG_DEBUG("Alice's secret a: %s", hex_buffer);
-    
-    // Log messages before encryption
-    char hex_buffer_m0[32 * 2 + 1];
-    char hex_buffer_m1[32 * 2 + 1];
-    hex_buffer_m0[0] = '\0';
-    hex_buffer_m1[0] = '\0';
-    for (int i = 0; i < 32; i++) {
-        sprintf(hex_buffer_m0 + (i * 2), "%02x", m0[i]);
-        sprintf(hex_buffer_m1 + (i * 2), "%02x", m1[i]);
-    }
-    LOG_DEBUG("Alice's message m0: %s", hex_buffer_m0);
-    LOG_DEBUG("Alice's message m1: %s", hex_buffer_m1);
+    compress_point(&A, message->A_compressed);
     
     return 0;
 }
 
 int base_ot_receiver_choice(const OT_SenderMessage *sender_msg, int choice_bit,
     OT_ReceiverMessage *receiver_msg, uint8_t *k_c) {
-    if (!sender_msg || !receiver_msg || !k_c || (choice_bit != 0 && choice_bit != 1)) {
+    // Generate random b
+    bignum256 b;
+    generate_random_nonzero_scalar(&b);
+
+    int ret = base_ot_receiver_choice_keyed(sender_msg, choice_bit, &b, receiver_msg, k_c);
+    memzero(&b, sizeof(b));
+
+    return ret;
+}
+
+int base_ot_receiver_choice_keyed(const OT_SenderMessage *sender_msg, int choice_bit,
+    const bignum256 *b, OT_ReceiverMessage *receiver_msg, uint8_t *k_c) {
+    if (!sender_msg || !b || !receiver_msg || !k_c || bn_is_zero(b) ||
+        (choice_bit != 0 && choice_bit != 1)) {
         LOG_ERROR("Invalid parameters in base_ot_receiver_choice");
         return -1;
     }
 
+    // The sender's message selects the group
+    if (sender_msg->A_compressed[0] == BASE_OT_CURVE25519_TAG) {
+        return base_ot_25519_receiver_choice_batch(1, sender_msg, 0, 0, &choice_bit, b,
+                                                   receiver_msg, (uint8_t (*)[32])k_c);
+    }
+
     // Decode point A
     curve_point A;
     if (ecdsa_read_pubkey(&secp256k1, sender_msg->A_compressed, &A) != 1) {
@@ -71,59 +132,55 @@ int base_ot_receiver_choice(const OT_SenderMessage *sender_msg, int choice_bit,
         return -2;
     }
 
-    // Generate random b
-    bignum256 b;
-    generate_random_nonzero_scalar(&b);
-
     // Debug output for b
-    uint8_t b_bytes[32];
-    bn_write_be(&b, b_bytes);
-    char hex_buffer[65];
-    for (int i = 0; i < 32; i++) {
-        sprintf(hex_buffer + (i * 2), "%02x", b_bytes[i]);
+    if (LOG_ENABLED(LOG_DEBUG)) {
+        uint8_t b_bytes[32];
+        char hex_buffer[65];
+        bn_write_be(b, b_bytes);
+        hex_string(b_bytes, 32, hex_buffer);
+        LOG_DEBUG("Bob's secret b: %s", hex_buffer);
+        LOG_DEBUG("Bob's choice bit: %d", choice_bit);
+        memzero(b_bytes, sizeof(b_bytes));
     }
-    LOG_DEBUG("Bob's secret b: %s", hex_buffer);
-    LOG_DEBUG("Bob's choice bit: %d", choice_bit);
 
-    // Compute B = b·G + choice_bit·A
-    curve_point B, bG;
+    // B = b·G + choice_bit·A, selected without branching on the choice bit.
+    // B and b·A stay in Jacobian coordinates and share one inversion.
+    jacobian_curve_point jpoints[2], bGA;
+    curve_point points[2];
 
-    // Calculate b·G using optimized scalar multiplication
-    int res = opt_scalar_multiply(&secp256k1, &b, &bG);
+    int res = opt_scalar_multiply_jacobian(&secp256k1, b, &jpoints[0]);
     if (res != 1) {
         LOG_ERROR("Failed to compute b·G, error code: %d", res);
         return -3;
     }
+    bGA = jpoints[0];
+    point_jacobian_add(&A, &bGA, &secp256k1);
+    bn_cmov(&jpoints[0].x, choice_bit, &bGA.x, &jpoints[0].x);
+    bn_cmov(&jpoints[0].y, choice_bit, &bGA.y, &jpoints[0].y);
+    bn_cmov(&jpoints[0].z, choice_bit, &bGA.z, &jpoints[0].z);
 
-    // Set B = bG initially
-    point_copy(&bG, &B);
-
-    // If choice_bit is 1, add A to B
-    if (choice_bit == 1) {
-        point_add(&secp256k1, &A, &B);
-    }
-
-    // Compress point B
-    receiver_msg->B_compressed[0] = 0x02 | (B.y.val[0] & 1);
-    bn_write_be(&B.x, receiver_msg->B_compressed + 1);
-
-    // Compute the receiver's key using optimized point multiplication
-    curve_point bA;
-    res = opt_point_multiply(&secp256k1, &b, &A, &bA);
+    // Compute the receiver's key point b·A
+    res = opt_point_multiply_ct_jacobian(&secp256k1, b, &A, &jpoints[1]);
     if (res != 1) {
         LOG_ERROR("Failed to compute b·A, error code: %d", res);
         return -4;
     }
 
+    jacobian_batch_to_affine(jpoints, points, 2, &secp256k1.prime);
+    compress_point(&points[0], receiver_msg->B_compressed);
+
     // Derive the key from bA using SHA-256
-    derive_key_from_point(&bA, k_c);
+    derive_key_from_point(&points[1], k_c);
+    memzero(jpoints, sizeof(jpoints));
+    memzero(&bGA, sizeof(bGA));
+    memzero(points, sizeof(points));
 
     // DEBUG: Print final derived key
-    char hex_buffer_k_c[65];
-    for (int i = 0; i < 32; i++) {
-        sprintf(hex_buffer_k_c + (i * 2), "%02x", k_c[i]);
+    if (LOG_ENABLED(LOG_DEBUG)) {
+        char hex_buffer_k_c[65];
+        hex_string(k_c, 32, hex_buffer_k_c);
+        LOG_DEBUG("Bob derived k_c: %s", hex_buffer_k_c);
     }
-    LOG_DEBUG("Bob derived k_c: %s", hex_buffer_k_c);
 
     return 0;
 }
@@ -135,6 +192,11 @@ int base_ot_sender_keys(const bignum256 *a, const OT_ReceiverMessage *receiver_m
         return -1;
     }
     
+    if (backend == BASE_OT_BACKEND_CURVE25519) {
+        return base_ot_25519_sender_keys_batch(1, a, NULL, 0, receiver_msg,
+                                               (uint8_t (*)[32])k0, (uint8_t (*)[32])k1);
+    }
+    
     // Decode point B
     curve_point B;
     if (ecdsa_read_pubkey(&secp256k1, receiver_msg->B_compressed, &B) != 1) {
@@ -142,64 +204,496 @@ int base_ot_sender_keys(const bignum256 *a, const OT_ReceiverMessage *receiver_m
         return -2;
     }
     
-    // Compute A = a·G (sender's public key) using optimized scalar multiplication
-    curve_point A;
-    if (opt_scalar_multiply(&secp256k1, a, &A) != 1) {
-        LOG_ERROR("Failed to compute A = a·G");
-        return -3;
-    }
-    
-    // Compute a·B using optimized point multiplication
-    curve_point aB;
-    if (opt_point_multiply(&secp256k1, a, &B, &aB) != 1) {
+    // Compute a·B, the only variable-base multiplication
+    jacobian_curve_point jkeys[2];
+    if (opt_point_multiply_ct_jacobian(&secp256k1, a, &B, &jkeys[0]) != 1) {
         LOG_ERROR("Failed to compute a·B");
         return -4;
     }
     
-    // Compute a·(B-A)
-    
-    // First, we need B-A = B + (-A)
-    curve_point B_minus_A;
-    
-    // Copy B to B_minus_A
-    point_copy(&B, &B_minus_A);
-    
-    // Negate A (flip the y-coordinate)
-    curve_point A_neg;
-    point_copy(&A, &A_neg);
-    bn_subtract(&secp256k1.prime, &A_neg.y, &A_neg.y);
-    
-    // Add -A to B_minus_A
-    point_add(&secp256k1, &A_neg, &B_minus_A);
-    
-    // Compute a·(B-A) using optimized point multiplication
-    curve_point a_B_minus_A;
-    if (opt_point_multiply(&secp256k1, a, &B_minus_A, &a_B_minus_A) != 1) {
-        LOG_ERROR("Failed to compute a·(B-A)");
-        return -5;
+    // a·(B-A) = a·B - a·A, where a·A = (a^2 mod n)·G is a fixed-base
+    // multiplication: A itself is never recomputed
+    bignum256 a2;
+    curve_point aA;
+    bn_copy(a, &a2);
+    bn_multiply(a, &a2, &secp256k1.order);
+    bn_mod(&a2, &secp256k1.order);
+    int ok = opt_scalar_multiply(&secp256k1, &a2, &aA) == 1;
+    memzero(&a2, sizeof(a2));
+    if (!ok) {
+        LOG_ERROR("Failed to compute a·A");
+        return -3;
     }
+    bn_subtract(&secp256k1.prime, &aA.y, &aA.y);
+    jkeys[1] = jkeys[0];
+    point_jacobian_add(&aA, &jkeys[1], &secp256k1);
     
     // For choice bit 0, the receiver uses a·B
     // For choice bit 1, the receiver uses a·(B-A)
-    derive_key_from_point(&aB, k0);  // Key for choice bit 0
-    derive_key_from_point(&a_B_minus_A, k1);  // Key for choice bit 1
+    curve_point keys[2];
+    jacobian_batch_to_affine(jkeys, keys, 2, &secp256k1.prime);
+    derive_key_from_point(&keys[0], k0);  // Key for choice bit 0
+    derive_key_from_point(&keys[1], k1);  // Key for choice bit 1
+    memzero(jkeys, sizeof(jkeys));
+    memzero(keys, sizeof(keys));
+    memzero(&aA, sizeof(aA));
     
     // Debug output
-    char hex_buffer_k0[65];
-    for (int i = 0; i < 32; i++) {
-        sprintf(hex_buffer_k0 + (i * 2), "%02x", k0[i]);
+    if (LOG_ENABLED(LOG_DEBUG)) {
+        char hex_buffer[65];
+        hex_string(k0, 32, hex_buffer);
+        LOG_DEBUG("Alice's key for bit 0: %s", hex_buffer);
+        hex_string(k1, 32, hex_buffer);
+        LOG_DEBUG("Alice's key for bit 1: %s", hex_buffer);
     }
-    LOG_DEBUG("Alice's key for bit 0: %s", hex_buffer_k0);
     
-    char hex_buffer_k1[65];
-    for (int i = 0; i < 32; i++) {
-        sprintf(hex_buffer_k1 + (i * 2), "%02x", k1[i]);
+    return 0;
+}
+
+int base_ot_init_sender_batch(size_t count, OT_SenderMessage *messages, bignum256 *a) {
+    if (!messages || !a || count == 0) {
+        LOG_ERROR("Invalid parameters in base_ot_init_sender_batch");
+        return -1;
     }
-    LOG_DEBUG("Alice's key for bit 1: %s", hex_buffer_k1);
-    
+
+    for (size_t i = 0; i < count; i++) {
+        generate_random_nonzero_scalar(&a[i]);
+    }
+
+    return base_ot_sender_message_batch(count, a, messages);
+}
+
+int base_ot_sender_message_batch(size_t count, const bignum256 *a, OT_SenderMessage *messages) {
+    if (!a || !messages || count == 0) {
+        LOG_ERROR("Invalid parameters in base_ot_sender_message_batch");
+        return -1;
+    }
+
+    if (backend == BASE_OT_BACKEND_CURVE25519) {
+        return base_ot_25519_sender_message_batch(count, a, messages);
+    }
+
+    jacobian_curve_point jA[BASE_OT_BATCH_CHUNK];
+    curve_point A[BASE_OT_BATCH_CHUNK];
+
+    for (size_t base = 0; base < count; base += BASE_OT_BATCH_CHUNK) {
+        size_t n = count - base < BASE_OT_BATCH_CHUNK ? count - base : BASE_OT_BATCH_CHUNK;
+
+        // A_i = a_i·G, left in Jacobian coordinates
+        for (size_t i = 0; i < n; i++) {
+            if (bn_is_zero(&a[base + i])) {
+                LOG_ERROR("Zero private key for base OT %zu", base + i);
+                return -1;
+            }
+            if (opt_scalar_multiply_jacobian(&secp256k1, &a[base + i], &jA[i]) != 1) {
+                LOG_ERROR("Failed to compute A = a·G for base OT %zu", base + i);
+                return -2;
+            }
+        }
+
+        jacobian_batch_to_affine(jA, A, n, &secp256k1.prime);
+        for (size_t i = 0; i < n; i++) {
+            compress_point(&A[i], messages[base + i].A_compressed);
+        }
+    }
+
+    LOG_DEBUG("Alice computed the messages of %zu base OTs", count);
+
     return 0;
 }
 
+int base_ot_receiver_choice_batch(size_t count, const OT_SenderMessage *sender_msgs,
+                                  const int *choice_bits, OT_ReceiverMessage *receiver_msgs,
+                                  uint8_t (*k_c)[32]) {
+    return base_ot_receiver_choice_batch_keyed(count, sender_msgs, choice_bits, NULL,
+                                               receiver_msgs, k_c);
+}
+
+int base_ot_receiver_choice_batch_keyed(size_t count, const OT_SenderMessage *sender_msgs,
+                                        const int *choice_bits, const bignum256 *secrets,
+                                        OT_ReceiverMessage *receiver_msgs,
+                                        uint8_t (*k_c)[32]) {
+    if (!sender_msgs || !choice_bits || !receiver_msgs || !k_c || count == 0) {
+        LOG_ERROR("Invalid parameters in base_ot_receiver_choice_batch");
+        return -1;
+    }
+
+    if (sender_msgs[0].A_compressed[0] == BASE_OT_CURVE25519_TAG) {
+        return base_ot_25519_receiver_choice_batch(count, sender_msgs, 0, 0, choice_bits,
+                                                   secrets, receiver_msgs, k_c);
+    }
+
+    // First half holds B_i, second half b_i·A_i
+    jacobian_curve_point jpoints[2 * BASE_OT_BATCH_CHUNK];
+    curve_point points[2 * BASE_OT_BATCH_CHUNK];
+    jacobian_curve_point bGA;
+    curve_point A;
+    bignum256 b;
+    int ret = 0;
+
+    for (size_t base = 0; base < count && ret == 0; base += BASE_OT_BATCH_CHUNK) {
+        size_t n = count - base < BASE_OT_BATCH_CHUNK ? count - base : BASE_OT_BATCH_CHUNK;
+
+        for (size_t i = 0; i < n; i++) {
+            int c = choice_bits[base + i];
+            if (c != 0 && c != 1) {
+                LOG_ERROR("Invalid choice bit for base OT %zu", base + i);
+                ret = -1;
+                break;
+            }
+
+            if (ecdsa_read_pubkey(&secp256k1, sender_msgs[base + i].A_compressed, &A) != 1) {
+                LOG_ERROR("Failed to decompress sender's public key A for base OT %zu", base + i);
+                ret = -2;
+                break;
+            }
+
+            if (secrets) {
+                if (bn_is_zero(&secrets[base + i])) {
+                    LOG_ERROR("Zero secret for base OT %zu", base + i);
+                    ret = -1;
+                    break;
+                }
+                b = secrets[base + i];
+            } else {
+                generate_random_nonzero_scalar(&b);
+            }
+
+            // B = b·G + c·A, selected without branching on c
+            if (opt_scalar_multiply_jacobian(&secp256k1, &b, &jpoints[i]) != 1) {
+                LOG_ERROR("Failed to compute b·G for base OT %zu", base + i);
+                ret = -3;
+                break;
+            }
+            bGA = jpoints[i];
+            point_jacobian_add(&A, &bGA, &secp256k1);
+            bn_cmov(&jpoints[i].x, c, &bGA.x, &jpoints[i].x);
+            bn_cmov(&jpoints[i].y, c, &bGA.y, &jpoints[i].y);
+            bn_cmov(&jpoints[i].z, c, &bGA.z, &jpoints[i].z);
+
+            if (opt_point_multiply_ct_jacobian(&secp256k1, &b, &A, &jpoints[n + i]) != 1) {
+                LOG_ERROR("Failed to compute b·A for base OT %zu", base + i);
+                ret = -4;
+                break;
+            }
+        }
+        if (ret != 0) {
+            break;
+        }
+
+        jacobian_batch_to_affine(jpoints, points, 2 * n, &secp256k1.prime);
+        for (size_t i = 0; i < n; i++) {
+            compress_point(&points[i], receiver_msgs[base + i].B_compressed);
+        }
+        derive_keys_from_points(&points[n], n, k_c + base);
+    }
+
+    memzero(&b, sizeof(b));
+    memzero(&bGA, sizeof(bGA));
+    memzero(jpoints, sizeof(jpoints));
+    memzero(points, sizeof(points));
+
+    if (ret == 0) {
+        LOG_DEBUG("Bob answered %zu base OTs", count);
+    }
+    return ret;
+}
+
+int base_ot_sender_keys_batch(size_t count, const bignum256 *a,
+                              const OT_ReceiverMessage *receiver_msgs,
+                              uint8_t (*k0)[32], uint8_t (*k1)[32]) {
+    if (!a || !receiver_msgs || !k0 || !k1 || count == 0) {
+        LOG_ERROR("Invalid parameters in base_ot_sender_keys_batch");
+        return -1;
+    }
+
+    if (backend == BASE_OT_BACKEND_CURVE25519) {
+        return base_ot_25519_sender_keys_batch(count, a, NULL, 0, receiver_msgs, k0, k1);
+    }
+
+    jacobian_curve_point jaB[BASE_OT_BATCH_CHUNK];
+    jacobian_curve_point jaA[BASE_OT_BATCH_CHUNK];
+    curve_point aA[BASE_OT_BATCH_CHUNK];
+    curve_point keys[2 * BASE_OT_BATCH_CHUNK];
+    jacobian_curve_point jkeys[2 * BASE_OT_BATCH_CHUNK];
+    curve_point B;
+    bignum256 a2;
+    int ret = 0;
+
+    for (size_t base = 0; base < count && ret == 0; base += BASE_OT_BATCH_CHUNK) {
+        size_t n = count - base < BASE_OT_BATCH_CHUNK ? count - base : BASE_OT_BATCH_CHUNK;
+
+        for (size_t i = 0; i < n; i++) {
+            if (ecdsa_read_pubkey(&secp256k1, receiver_msgs[base + i].B_compressed, &B) != 1) {
+                LOG_ERROR("Failed to decompress receiver's public key B for base OT %zu", base + i);
+                ret = -2;
+                break;
+            }
+
+            if (opt_point_multiply_ct_jacobian(&secp256k1, &a[base + i], &B, &jaB[i]) != 1) {
+                LOG_ERROR("Failed to compute a·B for base OT %zu", base + i);
+                ret = -4;
+                break;
+            }
+
+            // a·A = (a^2 mod n)·G, a fixed-base multiplication
+            a2 = a[base + i];
+            bn_multiply(&a[base + i], &a2, &secp256k1.order);
+            bn_mod(&a2, &secp256k1.order);
+            if (opt_scalar_multiply_jacobian(&secp256k1, &a2, &jaA[i]) != 1) {
+                LOG_ERROR("Failed to compute a·A for base OT %zu", base + i);
+                ret = -3;
+                break;
+            }
+        }
+        if (ret != 0) {
+            break;
+        }
+
+        // a·(B-A) = a·B - a·A needs a·A in affine form for the mixed addition
+        jacobian_batch_to_affine(jaA, aA, n, &secp256k1.prime);
+        for (size_t i = 0; i < n; i++) {
+            jkeys[i] = jaB[i];
+            jkeys[n + i] = jaB[i];
+            bn_subtract(&secp256k1.prime, &aA[i].y, &aA[i].y);
+            point_jacobian_add(&aA[i], &jkeys[n + i], &secp256k1);
+        }
+
+        jacobian_batch_to_affine(jkeys, keys, 2 * n, &secp256k1.prime);
+        derive_keys_from_points(keys, n, k0 + base);
+        derive_keys_from_points(&keys[n], n, k1 + base);
+    }
+
+    memzero(&a2, sizeof(a2));
+    memzero(jaB, sizeof(jaB));
+    memzero(jaA, sizeof(jaA));
+    memzero(aA, sizeof(aA));
+    memzero(jkeys, sizeof(jkeys));
+    memzero(keys, sizeof(keys));
+
+    if (ret == 0) {
+        LOG_DEBUG("Alice derived keys for %zu base OTs", count);
+    }
+    return ret;
+}
+
+// Simplest OT key of OT index: H(A || B || index || P). Hashing the index
+// and the transcript keeps the keys of OTs sharing A independent.
+static void simplest_derive_key(const uint8_t *A_compressed, const uint8_t *B_compressed,
+                                uint32_t index, const curve_point *P, uint8_t *key) {
+    uint8_t buf[33 + 33 + 4 + 64];
+    memcpy(buf, A_compressed, 33);
+    memcpy(buf + 33, B_compressed, 33);
+    buf[66] = index >> 24;
+    buf[67] = index >> 16;
+    buf[68] = index >> 8;
+    buf[69] = index;
+    bn_write_be(&P->x, buf + 70);
+    bn_write_be(&P->y, buf + 102);
+    kdf_hash(kdf_get_backend(), buf, sizeof(buf), key);
+    memzero(buf, sizeof(buf));
+}
+
+int base_ot_simplest_sender_init(base_ot_simplest_sender_t *sender, const bignum256 *a) {
+    if (!sender || (a && bn_is_zero(a))) {
+        LOG_ERROR("Invalid parameters in base_ot_simplest_sender_init");
+        return -1;
+    }
+
+    if (a) {
+        bn_copy(a, &sender->a);
+    } else {
+        generate_random_nonzero_scalar(&sender->a);
+    }
+    sender->backend = backend;
+
+    // Curve25519 keeps only a and the message, a·A is recomputed per batch
+    if (backend == BASE_OT_BACKEND_CURVE25519) {
+        if (base_ot_25519_sender_message_batch(1, &sender->a, &sender->message) != 0) {
+            base_ot_simplest_sender_clear(sender);
+            return -2;
+        }
+        return 0;
+    }
+
+    // A = a·G and a·A = (a^2 mod n)·G, both fixed-base, once per sender
+    bignum256 a2 = sender->a;
+    bn_multiply(&sender->a, &a2, &secp256k1.order);
+    bn_mod(&a2, &secp256k1.order);
+    int ok = opt_scalar_multiply(&secp256k1, &sender->a, &sender->A) == 1 &&
+             opt_scalar_multiply(&secp256k1, &a2, &sender->neg_aA) == 1;
+    memzero(&a2, sizeof(a2));
+    if (!ok) {
+        LOG_ERROR("Failed to compute the Simplest OT sender key");
+        base_ot_simplest_sender_clear(sender);
+        return -2;
+    }
+
+    bn_subtract(&secp256k1.prime, &sender->neg_aA.y, &sender->neg_aA.y);
+    compress_point(&sender->A, sender->message.A_compressed);
+
+    return 0;
+}
+
+void base_ot_simplest_sender_clear(base_ot_simplest_sender_t *sender) {
+    if (sender) {
+        memzero(sender, sizeof(*sender));
+    }
+}
+
+int base_ot_simplest_receiver_choice_batch(size_t count, uint32_t first_index,
+                                           const OT_SenderMessage *sender_msg,
+                                           const int *choice_bits, const bignum256 *secrets,
+                                           OT_ReceiverMessage *receiver_msgs,
+                                           uint8_t (*k_c)[32]) {
+    if (!sender_msg || !choice_bits || !receiver_msgs || !k_c || count == 0 ||
+        count > UINT32_MAX - first_index) {
+        LOG_ERROR("Invalid parameters in base_ot_simplest_receiver_choice_batch");
+        return -1;
+    }
+
+    if (sender_msg->A_compressed[0] == BASE_OT_CURVE25519_TAG) {
+        return base_ot_25519_receiver_choice_batch(count, sender_msg, 1, first_index,
+                                                   choice_bits, secrets, receiver_msgs, k_c);
+    }
+
+    // The same A for every OT, decompressed once
+    curve_point A;
+    if (ecdsa_read_pubkey(&secp256k1, sender_msg->A_compressed, &A) != 1) {
+        LOG_ERROR("Failed to decompress sender's public key A");
+        return -2;
+    }
+
+    // First half holds B_i, second half b_i·A
+    jacobian_curve_point jpoints[2 * BASE_OT_BATCH_CHUNK];
+    curve_point points[2 * BASE_OT_BATCH_CHUNK];
+    jacobian_curve_point bGA;
+    bignum256 b;
+    int ret = 0;
+
+    for (size_t base = 0; base < count && ret == 0; base += BASE_OT_BATCH_CHUNK) {
+        size_t n = count - base < BASE_OT_BATCH_CHUNK ? count - base : BASE_OT_BATCH_CHUNK;
+
+        for (size_t i = 0; i < n; i++) {
+            int c = choice_bits[base + i];
+            if ((c != 0 && c != 1) || (secrets && bn_is_zero(&secrets[base + i]))) {
+                LOG_ERROR("Invalid choice bit or secret for base OT %zu", base + i);
+                ret = -1;
+                break;
+            }
+            if (secrets) {
+                b = secrets[base + i];
+            } else {
+                generate_random_nonzero_scalar(&b);
+            }
+
+            // B = b·G + c·A, selected without branching on c
+            if (opt_scalar_multiply_jacobian(&secp256k1, &b, &jpoints[i]) != 1) {
+                LOG_ERROR("Failed to compute b·G for base OT %zu", base + i);
+                ret = -3;
+                break;
+            }
+            bGA = jpoints[i];
+            point_jacobian_add(&A, &bGA, &secp256k1);
+            bn_cmov(&jpoints[i].x, c, &bGA.x, &jpoints[i].x);
+            bn_cmov(&jpoints[i].y, c, &bGA.y, &jpoints[i].y);
+            bn_cmov(&jpoints[i].z, c, &bGA.z, &jpoints[i].z);
+
+            if (opt_point_multiply_ct_jacobian(&secp256k1, &b, &A, &jpoints[n + i]) != 1) {
+                LOG_ERROR("Failed to compute b·A for base OT %zu", base + i);
+                ret = -4;
+                break;
+            }
+        }
+        if (ret != 0) {
+            break;
+        }
+
+        jacobian_batch_to_affine(jpoints, points, 2 * n, &secp256k1.prime);
+        for (size_t i = 0; i < n; i++) {
+            compress_point(&points[i], receiver_msgs[base + i].B_compressed);
+            simplest_derive_key(sender_msg->A_compressed, receiver_msgs[base + i].B_compressed,
+                                first_index + (uint32_t)(base + i), &points[n + i],
+                                k_c[base + i]);
+        }
+    }
+
+    memzero(&b, sizeof(b));
+    memzero(&bGA, sizeof(bGA));
+    memzero(jpoints, sizeof(jpoints));
+    memzero(points, sizeof(points));
+
+    if (ret == 0) {
+        LOG_DEBUG("Bob answered %zu Simplest OTs", count);
+    }
+    return ret;
+}
+
+int base_ot_simplest_sender_keys_batch(const base_ot_simplest_sender_t *sender,
+                                       size_t count, uint32_t first_index,
+                                       const OT_ReceiverMessage *receiver_msgs,
+                                       uint8_t (*k0)[32], uint8_t (*k1)[32]) {
+    if (!sender || !receiver_msgs || !k0 || !k1 || count == 0 ||
+        count > UINT32_MAX - first_index) {
+        LOG_ERROR("Invalid parameters in base_ot_simplest_sender_keys_batch");
+        return -1;
+    }
+
+    if (sender->backend == BASE_OT_BACKEND_CURVE25519) {
+        return base_ot_25519_sender_keys_batch(count, &sender->a, &sender->message,
+                                               first_index, receiver_msgs, k0, k1);
+    }
+
+    // First half holds a·B_i, second half a·B_i - a·A
+    jacobian_curve_point jkeys[2 * BASE_OT_BATCH_CHUNK];
+    curve_point keys[2 * BASE_OT_BATCH_CHUNK];
+    curve_point B;
+    int ret = 0;
+
+    for (size_t base = 0; base < count && ret == 0; base += BASE_OT_BATCH_CHUNK) {
+        size_t n = count - base < BASE_OT_BATCH_CHUNK ? count - base : BASE_OT_BATCH_CHUNK;
+
+        for (size_t i = 0; i < n; i++) {
+            if (ecdsa_read_pubkey(&secp256k1, receiver_msgs[base + i].B_compressed, &B) != 1) {
+                LOG_ERROR("Failed to decompress receiver's public key B for base OT %zu", base + i);
+                ret = -2;
+                break;
+            }
+
+            // The only multiplication per OT: a·A is cached in the sender
+            if (opt_point_multiply_ct_jacobian(&secp256k1, &sender->a, &B, &jkeys[i]) != 1) {
+                LOG_ERROR("Failed to compute a·B for base OT %zu", base + i);
+                ret = -4;
+                break;
+            }
+            jkeys[n + i] = jkeys[i];
+            point_jacobian_add(&sender->neg_aA, &jkeys[n + i], &secp256k1);
+        }
+        if (ret != 0) {
+            break;
+        }
+
+        jacobian_batch_to_affine(jkeys, keys, 2 * n, &secp256k1.prime);
+        for (size_t i = 0; i < n; i++) {
+            uint32_t index = first_index + (uint32_t)(base + i);
+            simplest_derive_key(sender->message.A_compressed,
+                                receiver_msgs[base + i].B_compressed, index,
+                                &keys[i], k0[base + i]);
+            simplest_derive_key(sender->message.A_compressed,
+                                receiver_msgs[base + i].B_compressed, index,
+                                &keys[n + i], k1[base + i]);
+        }
+    }
+
+    memzero(jkeys, sizeof(jkeys));
+    memzero(keys, sizeof(keys));
+
+    if (ret == 0) {
+        LOG_DEBUG("Alice derived keys for %zu Simplest OTs", count);
+    }
+    return ret;
+}
+
 int base_ot_encrypt_messages(const uint8_t *m0, const uint8_t *m1,
                              const uint8_t *k0, const uint8_t *k1,
                              uint8_t *c0, uint8_t *c1, size_t msg_len) {
@@ -213,8 +707,8 @@ int base_ot_encrypt_messages(const uint8_t *m0, const uint8_t *m1,
     memcpy(c1, m1, msg_len);
     
     // Encrypt each message with its corresponding key
-    sha256_xor_crypt(c0, k0, msg_len);
-    sha256_xor_crypt(c1, k1, msg_len);
+    kdf_xor_crypt(kdf_get_backend(), c0, k0, msg_len);
+    kdf_xor_crypt(kdf_get_backend(), c1, k1, msg_len);
     
     return 0;
 }
@@ -235,14 +729,15 @@ int base_ot_receive_message(int choice_bit, const uint8_t *k_c,
     memcpy(output, chosen_ciphertext, msg_len);
     
     // Decrypt the message
-    sha256_xor_crypt(output, k_c, msg_len);
+    kdf_xor_crypt(kdf_get_backend(), output, k_c, msg_len);
     
-    // Print decrypted message
-    char hex_buffer_output[msg_len * 2 + 1];
-    for (int i = 0; i < msg_len; i++) {
-        sprintf(hex_buffer_output + (i * 2), "%02x", output[i]);
+    // Print decrypted message, long payloads only by their start
+    if (LOG_ENABLED(LOG_DEBUG)) {
+        char hex_buffer_output[64 * 2 + 1];
+        hex_string(output, msg_len < 64 ? msg_len : 64, hex_buffer_output);
+        LOG_DEBUG("Bob decrypted message m%d: %s%s", choice_bit, hex_buffer_output,
+                  msg_len > 64 ? "..." : "");
     }
-    LOG_DEBUG("Bob decrypted message m%d: %s", choice_bit, hex_buffer_output);
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,219 @@
+/*
+  Curve25519 backend of the base OT, on the ed25519-donna group code
+ */
+#include <string.h>
+#include "base_ot_25519.h"
+#include "ed25519-donna.h"
+#include "utils.h"
+#include "kdf.h"
+#include "logger.h"
+#include "memzero.h"
+
+// Reduces a caller's scalar mod l, 0 if it vanishes
+static int scalar_from_bn(const bignum256 *in, bignum256modm out) {
+    uint8_t bytes[32];
+    bn_write_le(in, bytes);
+    expand256_modm(out, bytes, 32);
+    memzero(bytes, sizeof(bytes));
+    return !iszero256_modm(out);
+}
+
+static void encode_point(const ge25519 *p, uint8_t out[33]) {
+    out[0] = BASE_OT_CURVE25519_TAG;
+    ge25519_pack(out + 1, p);
+}
+
+// Decodes a tagged point, 0 if it is not one of this backend or not on the curve
+static int decode_point(const uint8_t in[33], ge25519 *p) {
+    return in[0] == BASE_OT_CURVE25519_TAG && ge25519_unpack_vartime(p, in + 1);
+}
+
+// Key of one OT: H(B || P), or H(A || B || index || P) for Simplest OT
+static void derive_key(const uint8_t *A, const uint8_t *B, uint32_t index,
+                       const ge25519 *P, uint8_t *key) {
+    uint8_t buf[33 + 33 + 4 + 32];
+    size_t len = 0;
+
+    if (A) {
+        memcpy(buf, A, 33);
+        len = 33;
+    }
+    memcpy(buf + len, B, 33);
+    len += 33;
+    if (A) {
+        buf[len] = index >> 24;
+        buf[len + 1] = index >> 16;
+        buf[len + 2] = index >> 8;
+        buf[len + 3] = index;
+        len += 4;
+    }
+    ge25519_pack(buf + len, P);
+    len += 32;
+
+    kdf_hash(kdf_get_backend(), buf, len, key);
+    memzero(buf, sizeof(buf));
+}
+
+int base_ot_25519_sender_message_batch(size_t count, const bignum256 *a,
+                                       OT_SenderMessage *messages) {
+    if (!a || !messages || count == 0) {
+        LOG_ERROR("Invalid parameters in base_ot_25519_sender_message_batch");
+        return -1;
+    }
+
+    bignum256modm s;
+    ge25519 A;
+    int ret = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!scalar_from_bn(&a[i], s)) {
+            LOG_ERROR("Zero private key for base OT %zu", i);
+            ret = -1;
+            break;
+        }
+        ge25519_scalarmult_base_wrapper(&A, s);
+        encode_point(&A, messages[i].A_compressed);
+    }
+
+    memzero(s, sizeof(s));
+    memzero(&A, sizeof(A));
+
+    if (ret == 0) {
+        LOG_DEBUG("Alice computed the messages of %zu Curve25519 base OTs", count);
+    }
+    return ret;
+}
+
+int base_ot_25519_receiver_choice_batch(size_t count, const OT_SenderMessage *sender_msgs,
+                                        int simplest, uint32_t first_index,
+                                        const int *choice_bits, const bignum256 *secrets,
+                                        OT_ReceiverMessage *receiver_msgs,
+                                        uint8_t (*k_c)[32]) {
+    if (!sender_msgs || !choice_bits || !receiver_msgs || !k_c || count == 0 ||
+        (simplest && count > UINT32_MAX - first_index)) {
+        LOG_ERROR("Invalid parameters in base_ot_25519_receiver_choice_batch");
+        return -1;
+    }
+
+    bignum256 b_bn;
+    bignum256modm b;
+    ge25519 A8, B, bGA, bA;
+    int ret = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        int c = choice_bits[i];
+        if (c != 0 && c != 1) {
+            LOG_ERROR("Invalid choice bit for base OT %zu", i);
+            ret = -1;
+            break;
+        }
+
+        // 8·A, so that B carries no small-order part the sender could
+        // read c from. Simplest OT decodes its single A once.
+        if (!simplest || i == 0) {
+            if (!decode_point(sender_msgs[simplest ? 0 : i].A_compressed, &A8)) {
+                LOG_ERROR("Failed to decode sender's public key A for base OT %zu", i);
+                ret = -2;
+                break;
+            }
+            ge25519_mul8(&A8, &A8);
+        }
+
+        if (secrets) {
+            b_bn = secrets[i];
+        } else {
+            generate_random_nonzero_scalar(&b_bn);
+        }
+        if (!scalar_from_bn(&b_bn, b)) {
+            LOG_ERROR("Zero secret for base OT %zu", i);
+            ret = -1;
+            break;
+        }
+
+        // B = b·G + c·8·A, selected without branching on c
+        ge25519_scalarmult_base_wrapper(&B, b);
+        ge25519_add(&bGA, &B, &A8, 0);
+        curve25519_swap_conditional(B.x, bGA.x, (uint32_t)c);
+        curve25519_swap_conditional(B.y, bGA.y, (uint32_t)c);
+        curve25519_swap_conditional(B.z, bGA.z, (uint32_t)c);
+        curve25519_swap_conditional(B.t, bGA.t, (uint32_t)c);
+        encode_point(&B, receiver_msgs[i].B_compressed);
+
+        // The receiver's key point b·8·A
+        ge25519_scalarmult(&bA, &A8, b);
+        derive_key(simplest ? sender_msgs[0].A_compressed : NULL,
+                   receiver_msgs[i].B_compressed, first_index + (uint32_t)i, &bA, k_c[i]);
+    }
+
+    memzero(&b_bn, sizeof(b_bn));
+    memzero(b, sizeof(b));
+    memzero(&B, sizeof(B));
+    memzero(&bGA, sizeof(bGA));
+    memzero(&bA, sizeof(bA));
+
+    if (ret == 0) {
+        LOG_DEBUG("Bob answered %zu Curve25519 base OTs", count);
+    }
+    return ret;
+}
+
+int base_ot_25519_sender_keys_batch(size_t count, const bignum256 *a,
+                                    const OT_SenderMessage *simplest_msg, uint32_t first_index,
+                                    const OT_ReceiverMessage *receiver_msgs,
+                                    uint8_t (*k0)[32], uint8_t (*k1)[32]) {
+    if (!a || !receiver_msgs || !k0 || !k1 || count == 0 ||
+        (simplest_msg && count > UINT32_MAX - first_index)) {
+        LOG_ERROR("Invalid parameters in base_ot_25519_sender_keys_batch");
+        return -1;
+    }
+
+    bignum256modm s, s2;
+    ge25519 B, aA8, keys[2];
+    int ret = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!decode_point(receiver_msgs[i].B_compressed, &B)) {
+            LOG_ERROR("Failed to decode receiver's public key B for base OT %zu", i);
+            ret = -2;
+            break;
+        }
+
+        // a·8·A = (8·a^2 mod l)·G, a fixed-base multiplication that
+        // Simplest OT does once for all OTs
+        if (!simplest_msg || i == 0) {
+            if (!scalar_from_bn(&a[i], s)) {
+                LOG_ERROR("Zero private key for base OT %zu", i);
+                ret = -1;
+                break;
+            }
+            mul256_modm(s2, s, s);
+            add256_modm(s2, s2, s2);
+            add256_modm(s2, s2, s2);
+            add256_modm(s2, s2, s2);
+            ge25519_scalarmult_base_wrapper(&aA8, s2);
+        }
+
+        // 8·a·B for choice bit 0 and 8·(a·B - a·8·A) for choice bit 1;
+        // the factor 8 drops any small-order part of B
+        ge25519_scalarmult(&keys[0], &B, s);
+        ge25519_add(&keys[1], &keys[0], &aA8, 1);
+        ge25519_mul8(&keys[0], &keys[0]);
+        ge25519_mul8(&keys[1], &keys[1]);
+
+        const uint8_t *A = simplest_msg ? simplest_msg->A_compressed : NULL;
+        derive_key(A, receiver_msgs[i].B_compressed, first_index + (uint32_t)i,
+                   &keys[0], k0[i]);
+        derive_key(A, receiver_msgs[i].B_compressed, first_index + (uint32_t)i,
+                   &keys[1], k1[i]);
+    }
+
+    memzero(s, sizeof(s));
+    memzero(s2, sizeof(s2));
+    memzero(&aA8, sizeof(aA8));
+    memzero(keys, sizeof(keys));
+
+    if (ret == 0) {
+        LOG_DEBUG("Alice derived keys for %zu Curve25519 base OTs", count);
+    }
+    return ret;
+}
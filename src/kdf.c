@@ -0,0 +1,389 @@
+/*
+  Implementation of the hash / KDF backends
+ */
+#include <string.h>
+#include "kdf.h"
+#include "options.h"
+#include "sha2.h"
+#include "blake2s.h"
+#include "aes/aes.h"
+#include "utils.h"
+#include "logger.h"
+#include "memzero.h"
+#if USE_AES_NI
+#include <immintrin.h>
+#endif
+
+static kdf_backend_t backend = KDF_DEFAULT_BACKEND;
+static int aes_ni_enabled = 1;
+
+int kdf_set_backend(kdf_backend_t new_backend) {
+    if (new_backend != KDF_BACKEND_SHA256 && new_backend != KDF_BACKEND_BLAKE2S &&
+        new_backend != KDF_BACKEND_AES) {
+        LOG_ERROR("Invalid parameters in kdf_set_backend");
+        return -1;
+    }
+    backend = new_backend;
+    return 0;
+}
+
+kdf_backend_t kdf_get_backend(void) {
+    return backend;
+}
+
+const char *kdf_backend_name(kdf_backend_t b) {
+    switch (b) {
+        case KDF_BACKEND_SHA256:
+            return "sha256";
+        case KDF_BACKEND_BLAKE2S:
+            return "blake2s";
+        case KDF_BACKEND_AES:
+            return "aes";
+        default:
+            return "unknown";
+    }
+}
+
+static int aes_ni_active(void) {
+#if USE_AES_NI
+    return aes_ni_enabled && __builtin_cpu_supports("aes") && __builtin_cpu_supports("sse2");
+#else
+    return 0;
+#endif
+}
+
+int kdf_use_aes_ni(int enable) {
+    aes_ni_enabled = enable != 0;
+    return aes_ni_active();
+}
+
+static void write_u64_be(uint8_t *out, uint64_t v) {
+    for (int i = 7; i >= 0; i--) {
+        out[i] = v & 0xff;
+        v >>= 8;
+    }
+}
+
+static void write_u64_le(uint8_t *out, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = v & 0xff;
+        v >>= 8;
+    }
+}
+
+/* ---- AES-128, with AES-NI or the portable code ---- */
+
+// Expanded AES-128 key; only the schedule of the active code is set
+typedef struct {
+#if USE_AES_NI
+    __m128i rk[11];
+#endif
+    aes_encrypt_ctx ctx;
+    int ni;
+} aes128_key_t;
+
+// Key of the fixed-key permutation: the first digits of pi
+static const uint8_t fixed_key[16] = {
+    0x24, 0x3f, 0x6a, 0x88, 0x85, 0xa3, 0x08, 0xd3,
+    0x13, 0x19, 0x8a, 0x2e, 0x03, 0x70, 0x73, 0x44
+};
+
+#if USE_AES_NI
+__attribute__((target("aes,sse2")))
+static inline __m128i aesni_expand_step(__m128i k, __m128i t) {
+    t = _mm_shuffle_epi32(t, 0xff);
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    return _mm_xor_si128(k, t);
+}
+
+// The round constant of _mm_aeskeygenassist_si128 must be an immediate
+#define AESNI_EXPAND(rk, i, rcon) \
+    rk[i] = aesni_expand_step(rk[i - 1], _mm_aeskeygenassist_si128(rk[i - 1], rcon))
+
+__attribute__((target("aes,sse2")))
+static void aesni_key_expand(const uint8_t key[16], __m128i rk[11]) {
+    rk[0] = _mm_loadu_si128((const __m128i *)key);
+    AESNI_EXPAND(rk, 1, 0x01);
+    AESNI_EXPAND(rk, 2, 0x02);
+    AESNI_EXPAND(rk, 3, 0x04);
+    AESNI_EXPAND(rk, 4, 0x08);
+    AESNI_EXPAND(rk, 5, 0x10);
+    AESNI_EXPAND(rk, 6, 0x20);
+    AESNI_EXPAND(rk, 7, 0x40);
+    AESNI_EXPAND(rk, 8, 0x80);
+    AESNI_EXPAND(rk, 9, 0x1b);
+    AESNI_EXPAND(rk, 10, 0x36);
+}
+
+// Encrypts n blocks in place, 8 in flight to fill the AES pipeline
+__attribute__((target("aes,sse2")))
+static void aesni_encrypt(const __m128i rk[11], uint8_t (*blocks)[16], size_t n) {
+    __m128i b[8];
+
+    for (size_t base = 0; base < n; base += 8) {
+        size_t m = n - base < 8 ? n - base : 8;
+        for (size_t i = 0; i < m; i++) {
+            b[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)blocks[base + i]), rk[0]);
+        }
+        for (int r = 1; r < 10; r++) {
+            for (size_t i = 0; i < m; i++) {
+                b[i] = _mm_aesenc_si128(b[i], rk[r]);
+            }
+        }
+        for (size_t i = 0; i < m; i++) {
+            b[i] = _mm_aesenclast_si128(b[i], rk[10]);
+            _mm_storeu_si128((__m128i *)blocks[base + i], b[i]);
+        }
+    }
+
+    memzero(b, sizeof(b));
+}
+#endif /* USE_AES_NI */
+
+static void aes128_init(aes128_key_t *key, const uint8_t bytes[16]) {
+    key->ni = aes_ni_active();
+#if USE_AES_NI
+    if (key->ni) {
+        aesni_key_expand(bytes, key->rk);
+        return;
+    }
+#endif
+    aes_encrypt_key128(bytes, &key->ctx);
+}
+
+static void aes128_encrypt(const aes128_key_t *key, uint8_t (*blocks)[16], size_t n) {
+#if USE_AES_NI
+    if (key->ni) {
+        aesni_encrypt(key->rk, blocks, n);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) {
+        aes_encrypt(blocks[i], blocks[i], &key->ctx);
+    }
+}
+
+#if USE_AES_NI
+// aes_crh_rows on AES-NI, the tweaks built in registers
+__attribute__((target("aes,sse2")))
+static void aesni_crh_rows(const __m128i rk[11], uint64_t first_index,
+                           const uint8_t (*rows)[KDF_CRH_INPUT_LEN], size_t count,
+                           uint8_t (*out)[KDF_BLOCK_LEN]) {
+    __m128i p[8], t[16];
+
+    for (size_t base = 0; base < count; base += 8) {
+        size_t n = count - base < 8 ? count - base : 8;
+
+        for (size_t i = 0; i < n; i++) {
+            p[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)rows[base + i]), rk[0]);
+        }
+        for (int r = 1; r < 10; r++) {
+            for (size_t i = 0; i < n; i++) {
+                p[i] = _mm_aesenc_si128(p[i], rk[r]);
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            p[i] = _mm_aesenclast_si128(p[i], rk[10]);
+            __m128i tweak = _mm_set_epi64x(0, (long long)(first_index + base + i));
+            t[2 * i] = _mm_xor_si128(_mm_xor_si128(p[i], tweak), rk[0]);
+            t[2 * i + 1] = _mm_xor_si128(_mm_xor_si128(p[i], _mm_set_epi64x(1, 0)),
+                                         _mm_xor_si128(tweak, rk[0]));
+        }
+        for (int r = 1; r < 10; r++) {
+            for (size_t i = 0; i < 2 * n; i++) {
+                t[i] = _mm_aesenc_si128(t[i], rk[r]);
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            __m128i lo = _mm_aesenclast_si128(t[2 * i], rk[10]);
+            __m128i hi = _mm_aesenclast_si128(t[2 * i + 1], rk[10]);
+            _mm_storeu_si128((__m128i *)out[base + i], _mm_xor_si128(lo, p[i]));
+            _mm_storeu_si128((__m128i *)(out[base + i] + 16), _mm_xor_si128(hi, p[i]));
+        }
+    }
+
+    memzero(p, sizeof(p));
+    memzero(t, sizeof(t));
+}
+#endif /* USE_AES_NI */
+
+// TMMO with 32-byte outputs, 8 rows at a time:
+// out = pi(p ^ T(i, 0)) ^ p || pi(p ^ T(i, 1)) ^ p with p = pi(row)
+static void aes_crh_rows(uint64_t first_index, const uint8_t (*rows)[KDF_CRH_INPUT_LEN],
+                         size_t count, uint8_t (*out)[KDF_BLOCK_LEN]) {
+    aes128_key_t key;
+    uint8_t p[8][16];
+    uint8_t t[16][16];
+
+    aes128_init(&key, fixed_key);
+#if USE_AES_NI
+    if (key.ni) {
+        aesni_crh_rows(key.rk, first_index, rows, count, out);
+        return;
+    }
+#endif
+
+    for (size_t base = 0; base < count; base += 8) {
+        size_t n = count - base < 8 ? count - base : 8;
+
+        memcpy(p, rows[base], n * 16);
+        aes128_encrypt(&key, p, n);
+
+        // T(i, h) is i as 64-bit little endian, then h
+        for (size_t i = 0; i < n; i++) {
+            for (int h = 0; h < 2; h++) {
+                uint8_t *block = t[2 * i + h];
+                memset(block, 0, 16);
+                write_u64_le(block, first_index + base + i);
+                block[8] = h;
+                xor_buffers(block, block, p[i], 16);
+            }
+        }
+        aes128_encrypt(&key, t, 2 * n);
+
+        for (size_t i = 0; i < n; i++) {
+            xor_buffers(out[base + i], t[2 * i], p[i], 16);
+            xor_buffers(out[base + i] + 16, t[2 * i + 1], p[i], 16);
+        }
+    }
+
+    memzero(p, sizeof(p));
+    memzero(t, sizeof(t));
+    memzero(&key, sizeof(key));
+}
+
+// AES-128 in counter mode under the first 16 bytes of each seed; block j
+// of the PRG is the encryption of the counters 2j and 2j + 1
+static void aes_prg(const uint8_t (*seeds)[32], size_t count, uint64_t first_block,
+                    size_t num_blocks, uint8_t *out, size_t stride) {
+    aes128_key_t key;
+
+    for (size_t j = 0; j < count; j++) {
+        uint8_t (*stream)[16] = (uint8_t (*)[16])(out + j * stride);
+
+        aes128_init(&key, seeds[j]);
+        for (size_t b = 0; b < 2 * num_blocks; b++) {
+            memset(stream[b], 0, 16);
+            write_u64_le(stream[b], 2 * first_block + b);
+        }
+        aes128_encrypt(&key, stream, 2 * num_blocks);
+    }
+
+    memzero(&key, sizeof(key));
+}
+
+/* ---- Backend dispatch ---- */
+
+void kdf_hash(kdf_backend_t b, const uint8_t *data, size_t len, uint8_t *out) {
+    if (b == KDF_BACKEND_BLAKE2S) {
+        blake2s(data, len, out, BLAKE2S_DIGEST_LENGTH);
+    } else {
+        sha256_Raw(data, len, out);
+    }
+}
+
+void kdf_hash_batch(kdf_backend_t b, size_t count, const uint8_t *const *data,
+                    size_t len, uint8_t (*out)[KDF_BLOCK_LEN]) {
+    if (b == KDF_BACKEND_BLAKE2S) {
+        for (size_t i = 0; i < count; i++) {
+            blake2s(data[i], len, out[i], BLAKE2S_DIGEST_LENGTH);
+        }
+    } else {
+        sha256_Raw_batch(count, data, len, out);
+    }
+}
+
+void kdf_xor_crypt(kdf_backend_t b, uint8_t *data, const uint8_t *key, size_t len) {
+    if (b != KDF_BACKEND_BLAKE2S) {
+        sha256_xor_crypt(data, key, len);
+        return;
+    }
+
+    // Keystream block j is BLAKE2s_key(j), j as a 64-bit big-endian counter
+    uint8_t counter[8];
+    uint8_t keystream[BLAKE2S_DIGEST_LENGTH];
+
+    for (uint64_t j = 0; len > 0; j++) {
+        size_t take = len < sizeof(keystream) ? len : sizeof(keystream);
+        write_u64_be(counter, j);
+        blake2s_Key(counter, sizeof(counter), key, 32, keystream, sizeof(keystream));
+        xor_buffers(data, data, keystream, take);
+        data += take;
+        len -= take;
+    }
+
+    memzero(keystream, sizeof(keystream));
+}
+
+void kdf_crh_rows(kdf_backend_t b, uint64_t first_index,
+                  const uint8_t (*rows)[KDF_CRH_INPUT_LEN], size_t count,
+                  uint8_t (*out)[KDF_BLOCK_LEN]) {
+    if (b == KDF_BACKEND_AES) {
+        aes_crh_rows(first_index, rows, count, out);
+        return;
+    }
+
+    // H(index || row), 8 rows at a time
+    uint8_t inputs[8][8 + KDF_CRH_INPUT_LEN];
+    const uint8_t *ptrs[8];
+
+    for (size_t base = 0; base < count; base += 8) {
+        size_t n = count - base < 8 ? count - base : 8;
+        for (size_t i = 0; i < n; i++) {
+            write_u64_be(inputs[i], first_index + base + i);
+            memcpy(inputs[i] + 8, rows[base + i], KDF_CRH_INPUT_LEN);
+            ptrs[i] = inputs[i];
+        }
+        kdf_hash_batch(b, n, ptrs, sizeof(inputs[0]), out + base);
+    }
+
+    memzero(inputs, sizeof(inputs));
+}
+
+void kdf_prg(kdf_backend_t b, const uint8_t (*seeds)[32], size_t count,
+             uint64_t first_block, size_t num_blocks, uint8_t *out, size_t stride) {
+    if (b == KDF_BACKEND_AES) {
+        aes_prg(seeds, count, first_block, num_blocks, out, stride);
+        return;
+    }
+
+    if (b == KDF_BACKEND_BLAKE2S) {
+        // Block j is BLAKE2s keyed with the seed of j, 64-bit big endian
+        uint8_t counter[8];
+        for (size_t j = 0; j < count; j++) {
+            for (size_t k = 0; k < num_blocks; k++) {
+                write_u64_be(counter, first_block + k);
+                blake2s_Key(counter, sizeof(counter), seeds[j], 32,
+                            out + j * stride + k * KDF_BLOCK_LEN, KDF_BLOCK_LEN);
+            }
+        }
+        return;
+    }
+
+    // Block j is SHA-256(seed || j), 8 seeds at a time
+    uint8_t inputs[8][32 + 8];
+    uint8_t blocks[8][SHA256_DIGEST_LENGTH];
+    const uint8_t *ptrs[8];
+
+    for (size_t base = 0; base < count; base += 8) {
+        size_t n = count - base < 8 ? count - base : 8;
+        for (size_t i = 0; i < n; i++) {
+            memcpy(inputs[i], seeds[base + i], 32);
+            ptrs[i] = inputs[i];
+        }
+        for (size_t k = 0; k < num_blocks; k++) {
+            for (size_t i = 0; i < n; i++) {
+                write_u64_be(inputs[i] + 32, first_block + k);
+            }
+            sha256_Raw_batch(n, ptrs, sizeof(inputs[0]), blocks);
+            for (size_t i = 0; i < n; i++) {
+                memcpy(out + (base + i) * stride + k * KDF_BLOCK_LEN, blocks[i], KDF_BLOCK_LEN);
+            }
+        }
+    }
+
+    memzero(blocks, sizeof(blocks));
+    memzero(inputs, sizeof(inputs));
+}
@@ -6,103 +6,346 @@
  #include <stdlib.h>
  #include <stdarg.h>
  #include <string.h>
+ #include <stdatomic.h>
+ #include <pthread.h>
+ #include <sched.h>
+ #include <time.h>
  #include "logger.h"
  
+ _Static_assert((LOGGER_ASYNC_SLOTS & (LOGGER_ASYNC_SLOTS - 1)) == 0,
+                "LOGGER_ASYNC_SLOTS must be a power of two");
+ 
+ // One line of the async ring. seq tells who owns the slot: pos when free
+ // for the producer claiming position pos, pos + 1 once the line is written.
+ typedef struct {
+     atomic_size_t seq;
+     log_level_t level;
+     char text[LOGGER_LINE_MAX];
+ } log_slot_t;
+ 
  // Global logger state
  static struct {
-     log_level_t level;
+     log_level_t level;                  // Most verbose level on the terminal
+     log_level_t file_level;             // Most verbose level in the logfile
      FILE *logfile;
      int logfile_open;
+     char logfile_path[LOGGER_PATH_MAX]; // Path of the open logfile
  } logger = {
      .level = LOG_NONE,
+     .file_level = LOG_NONE,
      .logfile = NULL,
      .logfile_open = 0
  };
  
- int logger_init(log_level_t level, const char *logfile) {
-     logger.level = level;
+ // Async sink: many producers, the drain thread is the only consumer
+ static struct {
+     log_slot_t slots[LOGGER_ASYNC_SLOTS];
+     atomic_size_t head;                 // Next position to claim
+     size_t tail;                        // Next position to drain
+     atomic_int enabled;                 // log_message goes through the ring
+     atomic_int producers;               // log_message calls that may be pushing
+     atomic_int stopping;
+     atomic_uint_least64_t dropped;
+     pthread_t thread;
+ } async_sink;
+ 
+ // Whether the logfile takes lines of this level
+ static int file_accepts(log_level_t level) {
+     return logger.logfile_open && logger.logfile != NULL && level <= logger.file_level;
+ }
+ 
+ // Prefix of the lines of each level
+ static const char *level_prefix(log_level_t level) {
+     switch (level) {
+         case LOG_ERROR:
+             return "[ERROR] ";
+         case LOG_INFO:
+             return "[INFO] ";
+         case LOG_DEBUG:
+             return "[DEBUG] ";
+         default:
+             return "";
+     }
+ }
+ 
+ // Writes a formatted line to the sinks of its level
+ static void write_line(log_level_t level, const char *text) {
+     const char *prefix = level_prefix(level);
      
-     // Close previous logfile if open
+     if (level == LOG_ERROR && logger.level >= LOG_ERROR) {
+         fprintf(stderr, "%s%s\n", prefix, text);
+     }
+     if (level == LOG_INFO && logger.level >= LOG_INFO) {
+         printf("%s%s\n", prefix, text);
+     }
+     if (file_accepts(level)) {
+         fprintf(logger.logfile, "%s%s\n", prefix, text);
+     }
+ }
+ 
+ // Closes the current logfile and opens path with mode (NULL for none)
+ static int open_logfile(const char *path, const char *mode) {
      if (logger.logfile_open && logger.logfile != NULL) {
          fclose(logger.logfile);
          logger.logfile = NULL;
          logger.logfile_open = 0;
      }
+     logger.logfile_path[0] = '\0';
      
-     // Open new logfile if specified
-     if (logfile != NULL) {
-         logger.logfile = fopen(logfile, "w");
-         if (logger.logfile == NULL) {
-             fprintf(stderr, "Error: Failed to open log file '%s'\n", logfile);
-             return -1;
-         }
-         logger.logfile_open = 1;
+     if (path == NULL) {
+         return 0;
+     }
+     if (strlen(path) >= LOGGER_PATH_MAX) {
+         fprintf(stderr, "Error: Log file path too long '%s'\n", path);
+         return -1;
+     }
+     logger.logfile = fopen(path, mode);
+     if (logger.logfile == NULL) {
+         fprintf(stderr, "Error: Failed to open log file '%s'\n", path);
+         return -1;
      }
+     logger.logfile_open = 1;
+     strcpy(logger.logfile_path, path);
      
      return 0;
  }
  
- void logger_close(void) {
-     if (logger.logfile_open && logger.logfile != NULL) {
-         fclose(logger.logfile);
-         logger.logfile = NULL;
-         logger.logfile_open = 0;
+ int logger_init(log_level_t level, const char *logfile, log_level_t file_level) {
+     logger.level = level;
+     logger.file_level = file_level;
+     
+     // Replace the previous logfile, if any, with a new one
+     return open_logfile(logfile, "w");
+ }
+ 
+ void logger_get_config(logger_config_t *config) {
+     config->level = logger.level;
+     config->file_level = logger.file_level;
+     strcpy(config->logfile, logger.logfile_path);
+     config->async = atomic_load(&async_sink.enabled);
+ }
+ 
+ int logger_set_config(const logger_config_t *config) {
+     logger_stop_async();
+     logger.level = config->level;
+     logger.file_level = config->file_level;
+     
+     // The logfile is continued, not truncated
+     int ret = open_logfile(config->logfile[0] ? config->logfile : NULL, "a");
+     if (ret == 0 && config->async) {
+         ret = logger_start_async();
      }
+     
+     return ret;
+ }
+ 
+ void logger_close(void) {
+     logger_stop_async();
+     
+     open_logfile(NULL, NULL);
  }
  
  void logger_set_level(log_level_t level) {
      logger.level = level;
  }
  
- void log_message(log_level_t level, const char *format, ...) {
-     // Skip if log level is too low
-     if (level < logger.level) {
+ int logger_is_enabled(log_level_t level) {
+     if (level == LOG_NONE || level > LOG_MAX_LEVEL) {
+         return 0;
+     }
+     
+     // The most verbose level of the terminal and the open logfile
+     return level <= logger.level || (logger.logfile_open && level <= logger.file_level);
+ }
+ 
+ // Takes the next line off the ring, 0 if it is empty
+ static int async_pop(log_level_t *level, char *text) {
+     log_slot_t *slot = &async_sink.slots[async_sink.tail & (LOGGER_ASYNC_SLOTS - 1)];
+     size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+     if (seq != async_sink.tail + 1) {
+         return 0;
+     }
+     
+     *level = slot->level;
+     memcpy(text, slot->text, LOGGER_LINE_MAX);
+     
+     // Hand the slot to the producer one lap later
+     atomic_store_explicit(&slot->seq, async_sink.tail + LOGGER_ASYNC_SLOTS,
+                           memory_order_release);
+     async_sink.tail++;
+     return 1;
+ }
+ 
+ static void *async_drain_main(void *arg) {
+     (void)arg;
+     char text[LOGGER_LINE_MAX];
+     log_level_t level;
+     const struct timespec idle = { 0, 1000000 };
+     
+     for (;;) {
+         int wrote = 0;
+         while (async_pop(&level, text)) {
+             write_line(level, text);
+             wrote = 1;
+         }
+         if (wrote) {
+             fflush(stdout);
+             if (logger.logfile_open && logger.logfile != NULL) {
+                 fflush(logger.logfile);
+             }
+         }
+     
+         // No producer is left once stopping is set, so one more pass
+         // picks up every line
+         if (atomic_load(&async_sink.stopping)) {
+             while (async_pop(&level, text)) {
+                 write_line(level, text);
+             }
+             break;
+         }
+         nanosleep(&idle, NULL);
+     }
+     
+     return NULL;
+ }
+ 
+ int logger_start_async(void) {
+     if (atomic_load(&async_sink.enabled)) {
+         return 0;
+     }
+     
+     for (size_t i = 0; i < LOGGER_ASYNC_SLOTS; i++) {
+         atomic_init(&async_sink.slots[i].seq, i);
+     }
+     atomic_init(&async_sink.head, 0);
+     async_sink.tail = 0;
+     atomic_init(&async_sink.stopping, 0);
+     atomic_init(&async_sink.dropped, 0);
+     
+     if (pthread_create(&async_sink.thread, NULL, async_drain_main, NULL) != 0) {
+         fprintf(stderr, "Error: Failed to start the log thread\n");
+         return -1;
+     }
+     atomic_store(&async_sink.enabled, 1);
+     
+     return 0;
+ }
+ 
+ void logger_stop_async(void) {
+     if (!atomic_load(&async_sink.enabled)) {
          return;
      }
      
+     // Lines logged from here on are written directly again; wait for the
+     // calls that saw the ring enabled to finish their line
+     atomic_store(&async_sink.enabled, 0);
+     while (atomic_load(&async_sink.producers) > 0) {
+         sched_yield();
+     }
+     atomic_store(&async_sink.stopping, 1);
+     pthread_join(async_sink.thread, NULL);
+     
+     uint64_t dropped = atomic_load(&async_sink.dropped);
+     if (dropped > 0) {
+         char text[64];
+         snprintf(text, sizeof(text), "Async log sink dropped %llu lines",
+                  (unsigned long long)dropped);
+         write_line(LOG_ERROR, text);
+     }
+     fflush(stdout);
+ }
+ 
+ uint64_t logger_dropped_lines(void) {
+     return atomic_load(&async_sink.dropped);
+ }
+ 
+ // Formats a line into the next free slot of the ring, or drops it
+ static void async_push(log_level_t level, const char *format, va_list args) {
+     size_t pos = atomic_load_explicit(&async_sink.head, memory_order_relaxed);
+     log_slot_t *slot;
+     
+     for (;;) {
+         slot = &async_sink.slots[pos & (LOGGER_ASYNC_SLOTS - 1)];
+         size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+         intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+     
+         if (diff == 0) {
+             if (atomic_compare_exchange_weak_explicit(&async_sink.head, &pos, pos + 1,
+                                                       memory_order_relaxed,
+                                                       memory_order_relaxed)) {
+                 break;
+             }
+         } else if (diff < 0) {
+             // The drain thread is a full lap behind
+             atomic_fetch_add(&async_sink.dropped, 1);
+             return;
+         } else {
+             pos = atomic_load_explicit(&async_sink.head, memory_order_relaxed);
+         }
+     }
+     
+     slot->level = level;
+     vsnprintf(slot->text, LOGGER_LINE_MAX, format, args);
+     atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+ }
+ 
+ void log_message(log_level_t level, const char *format, ...) {
      va_list args;
      
-     // Get the prefix based on log level
-     const char *prefix;
-     switch (level) {
-         case LOG_ERROR:
-             prefix = "[ERROR] ";
-             break;
-         case LOG_INFO:
-             prefix = "[INFO] ";
-             break;
-         case LOG_DEBUG:
-             prefix = "[DEBUG] ";
-             break;
-         default:
-             prefix = "";
-             break;
+     if (!logger_is_enabled(level)) {
+         return;
+     }
+     
+     // Registered as a producer before looking at enabled, so that
+     // logger_stop_async can wait for the line
+     atomic_fetch_add(&async_sink.producers, 1);
+     if (atomic_load(&async_sink.enabled)) {
+         va_start(args, format);
+         async_push(level, format, args);
+         va_end(args);
+         atomic_fetch_sub(&async_sink.producers, 1);
+         return;
      }
+     atomic_fetch_sub(&async_sink.producers, 1);
+     
+     // Get the prefix based on log level
+     const char *prefix = level_prefix(level);
+     
+     // Each line is written under the stream lock, so lines logged from
+     // several threads do not interleave
+     
+     // Each sink has its own level
      
      // Write to stderr for ERROR level
-     if (level == LOG_ERROR) {
+     if (level == LOG_ERROR && logger.level >= LOG_ERROR) {
          va_start(args, format);
+         flockfile(stderr);
          fprintf(stderr, "%s", prefix);
          vfprintf(stderr, format, args);
          fprintf(stderr, "\n");
+         funlockfile(stderr);
          va_end(args);
      }
      
      // Write to stdout for INFO level
-     if (level == LOG_INFO && logger.level <= LOG_INFO) {
+     if (level == LOG_INFO && logger.level >= LOG_INFO) {
          va_start(args, format);
+         flockfile(stdout);
          printf("%s", prefix);
          vprintf(format, args);
          printf("\n");
+         funlockfile(stdout);
          va_end(args);
      }
      
-     // Write to logfile if open
-     if (logger.logfile_open && logger.logfile != NULL) {
+     // Write to logfile if open and at its level
+     if (file_accepts(level)) {
          va_start(args, format);
+         flockfile(logger.logfile);
          fprintf(logger.logfile, "%s", prefix);
          vfprintf(logger.logfile, format, args);
          fprintf(logger.logfile, "\n");
+         funlockfile(logger.logfile);
          va_end(args);
      }
- }
\ No newline at end of file
+ }
@@ -5,40 +5,137 @@
 
  #include <stdio.h>
  #include <stdlib.h>
+ #include <stddef.h>
  #include <string.h>
  #include "logger.h"
+ #include "memzero.h"
  #include "mta.h"
  #include "utils.h"
   
+ // PRG streams drawn from the seed of an instance
+ #define MTA_STREAM_UI 0
+ #define MTA_STREAM_SENDER_KEYS 1
+ #define MTA_STREAM_RECEIVER_KEY(bit_index) (0x100 + (bit_index))
+  
  int mta_init(mta_context_t *ctx, mta_role_t role, const bignum256 *share) {
-     if (!ctx || !share) {
-         return -1;
-     }
+     uint8_t seed[PRG_SEED_LEN];
+     random_buffer(seed, sizeof(seed));
      
-     // Initialize the context
-     memset(ctx, 0, sizeof(mta_context_t));
+     int ret = mta_init_seeded(ctx, role, share, seed);
+     memzero(seed, sizeof(seed));
+     
+     return ret;
+ }
+  
+ // Fills a zeroed context
+ static void init_context(mta_context_t *ctx, mta_role_t role, const bignum256 *share,
+                          const uint8_t *seed) {
      ctx->role = role;
      bn_copy(share, &ctx->share);
      bn_zero(&ctx->additive_share);
+     scalar_acc_init(&ctx->additive_acc);
+     memcpy(ctx->seed, seed, PRG_SEED_LEN);
      
-     // For the sender, generate all random values upfront
+     // For the sender, generate all random values and OT keys upfront
      if (role == MTA_ROLE_SENDER) {
+         prg_t prg;
+         prg_init(&prg, seed, MTA_STREAM_UI);
+         prg_scalars(&prg, ctx->random_values, MTA_NUM_BITS);
+         
+         prg_init(&prg, seed, MTA_STREAM_SENDER_KEYS);
+         prg_scalars(&prg, ctx->sender_private_keys, MTA_NUM_BITS);
          for (int i = 0; i < MTA_NUM_BITS; i++) {
-             generate_random_bignum(&ctx->random_values[i]);
+             if (bn_is_zero(&ctx->sender_private_keys[i])) {
+                 prg_nonzero_scalar(&prg, &ctx->sender_private_keys[i]);
+             }
          }
+         prg_clear(&prg);
+         
+         mta_precompute_shifted_shares(share, ctx->shifted_shares);
+         ctx->dirty |= MTA_DIRTY_SENDER_SECRETS;
+     }
+ }
+  
+ int mta_init_seeded(mta_context_t *ctx, mta_role_t role, const bignum256 *share,
+                     const uint8_t *seed) {
+     if (!ctx || !share || !seed) {
+         return -1;
      }
      
+     memset(ctx, 0, sizeof(mta_context_t));
+     init_context(ctx, role, share, seed);
+     
      return 0;
  }
   
- int mta_sender_bit_message(mta_context_t *ctx, int bit_index, OT_SenderMessage *message) {
-     if (!ctx || !message || ctx->role != MTA_ROLE_SENDER || 
-         bit_index < 0 || bit_index >= MTA_NUM_BITS) {
+ int mta_init_wiped(mta_context_t *ctx, mta_role_t role, const bignum256 *share) {
+     if (!ctx || !share) {
          return -1;
      }
      
-     LOG_DEBUG("=== MtA Bit %d (Alice) ===", bit_index);
+     uint8_t seed[PRG_SEED_LEN];
+     random_buffer(seed, sizeof(seed));
+     init_context(ctx, role, share, seed);
+     memzero(seed, sizeof(seed));
      
+     return 0;
+ }
+  
+ void mta_clear(mta_context_t *ctx) {
+     if (!ctx) {
+         return;
+     }
+     
+     uint32_t dirty = ctx->dirty;
+     if (dirty & MTA_DIRTY_SENDER_SECRETS) {
+         memzero(ctx->random_values, sizeof(ctx->random_values));
+         memzero(ctx->shifted_shares, sizeof(ctx->shifted_shares));
+         memzero(ctx->sender_private_keys, sizeof(ctx->sender_private_keys));
+     }
+     if (dirty & MTA_DIRTY_OT_MSGS) {
+         memzero(ctx->sender_msgs, sizeof(ctx->sender_msgs));
+         memzero(ctx->receiver_msgs, sizeof(ctx->receiver_msgs));
+     }
+     if (dirty & MTA_DIRTY_RECEIVER_KEYS) {
+         memzero(ctx->receiver_keys, sizeof(ctx->receiver_keys));
+         memzero(ctx->choice_bits, sizeof(ctx->choice_bits));
+     }
+     if (dirty & MTA_DIRTY_PAYLOADS) {
+         memzero(ctx->m0_values, sizeof(ctx->m0_values));
+         memzero(ctx->m1_values, sizeof(ctx->m1_values));
+     }
+     if (dirty & MTA_DIRTY_SENDER_KEYS) {
+         memzero(ctx->k0_values, sizeof(ctx->k0_values));
+         memzero(ctx->k1_values, sizeof(ctx->k1_values));
+     }
+     if (dirty & MTA_DIRTY_SIMPLEST) {
+         memzero(&ctx->simplest_ot, sizeof(ctx->simplest_ot));
+     }
+     
+     // The fields before the per-bit arrays, written by every context
+     memzero(ctx, offsetof(mta_context_t, random_values));
+     ctx->dirty = 0;
+ }
+  
+ int mta_precompute_shifted_shares(const bignum256 *x, bignum256 *shifted) {
+     if (!x || !shifted) {
+         return -1;
+     }
+     
+     // x(2^(i+1)) = 2 * x(2^i), the doubled value is below 2 * order
+     bn_copy(x, &shifted[0]);
+     bn_mod(&shifted[0], &secp256k1.order);
+     for (int i = 1; i < MTA_NUM_BITS; i++) {
+         bn_copy(&shifted[i - 1], &shifted[i]);
+         bn_lshift(&shifted[i]);
+         bn_mod(&shifted[i], &secp256k1.order);
+     }
+     
+     return 0;
+ }
+  
+ // Sets the OT messages m0 = Ui and m1 = Ui + x(2^i) of one bit
+ static void sender_bit_values(mta_context_t *ctx, int bit_index) {
      // Generate random Ui for this bit
      bignum256 *Ui = &ctx->random_values[bit_index];
      
@@ -46,18 +143,10 @@
      uint8_t m0[32];
      bignum_to_bytes(Ui, m0);
      
-     // Calculate m1 = Ui + x(2^i)
+     // Calculate m1 = Ui + x(2^i), x(2^i) was precomputed in mta_init
      bignum256 m1_bn;
      bn_copy(Ui, &m1_bn);
-     
-     // Calculate x(2^i)
-     bignum256 power2i, x_times_2i;
-     pow2_bignum(bit_index, &power2i);
-     bn_copy(&ctx->share, &x_times_2i);
-     bn_multiply(&power2i, &x_times_2i, &secp256k1.order);
-     
-     // Add to Ui
-     bn_add(&m1_bn, &x_times_2i);
+     bn_add(&m1_bn, &ctx->shifted_shares[bit_index]);
      bn_mod(&m1_bn, &secp256k1.order);
      
      uint8_t m1[32];
@@ -66,9 +155,25 @@
      // Store the key bits for later verification
      memcpy(ctx->m0_values[bit_index], m0, 32);
      memcpy(ctx->m1_values[bit_index], m1, 32);
+ }
+  
+ // Draws the receiver's OT secret of one bit from its own stream of the seed
+ static void receiver_bit_secret(const mta_context_t *ctx, int bit_index, bignum256 *b) {
+     prg_t prg;
+     prg_init(&prg, ctx->seed, MTA_STREAM_RECEIVER_KEY(bit_index));
+     prg_nonzero_scalar(&prg, b);
+     prg_clear(&prg);
+ }
+  
+ // The per-bit steps below leave the dirty mask to their callers, so that
+ // the shards of the parallel phases do not all write it
+ static int sender_bit_message(mta_context_t *ctx, int bit_index, OT_SenderMessage *message) {
+     LOG_DEBUG("=== MtA Bit %d (Alice) ===", bit_index);
+     
+     sender_bit_values(ctx, bit_index);
      
-     // Initialize the OT sender with these messages
-     int ret = base_ot_init_sender(m0, m1, message, &ctx->sender_private_keys[bit_index]);
+     // The OT sender key of this bit was drawn in mta_init
+     int ret = base_ot_sender_message(&ctx->sender_private_keys[bit_index], message);
      if (ret != 0) {
          return ret;
      }
@@ -79,14 +184,19 @@
      return 0;
  }
   
- int mta_receiver_bit_response(mta_context_t *ctx, int bit_index, 
-                               const OT_SenderMessage *sender_msg,
-                               OT_ReceiverMessage *receiver_msg) {
-     if (!ctx || !sender_msg || !receiver_msg || ctx->role != MTA_ROLE_RECEIVER ||
+ int mta_sender_bit_message(mta_context_t *ctx, int bit_index, OT_SenderMessage *message) {
+     if (!ctx || !message || ctx->role != MTA_ROLE_SENDER || 
          bit_index < 0 || bit_index >= MTA_NUM_BITS) {
          return -1;
      }
      
+     ctx->dirty |= MTA_DIRTY_PAYLOADS | MTA_DIRTY_OT_MSGS;
+     return sender_bit_message(ctx, bit_index, message);
+ }
+  
+ static int receiver_bit_response(mta_context_t *ctx, int bit_index,
+                                  const OT_SenderMessage *sender_msg,
+                                  OT_ReceiverMessage *receiver_msg) {
      LOG_DEBUG("=== MtA Bit %d (Bob) ===", bit_index);
      
      // Store the sender's message
@@ -96,13 +206,19 @@
      int choice_bit = get_bit(&ctx->share, bit_index);
      ctx->choice_bits[bit_index] = choice_bit; // Store for later use
      
+     // The OT secret of this bit comes from its own stream of the seed
+     bignum256 b;
+     receiver_bit_secret(ctx, bit_index, &b);
+     
      // Process the sender's message and generate our response
-     int ret = base_ot_receiver_choice(
+     int ret = base_ot_receiver_choice_keyed(
          &ctx->sender_msgs[bit_index],
          choice_bit,
+         &b,
          receiver_msg,
          ctx->receiver_keys[bit_index]
      );
+     memzero(&b, sizeof(b));
      if (ret != 0) {
          return ret;
      }
@@ -113,13 +229,20 @@
      return 0;
  }
   
- int mta_sender_bit_complete(mta_context_t *ctx, int bit_index, 
-                             const OT_ReceiverMessage *receiver_msg) {
-     if (!ctx || !receiver_msg || ctx->role != MTA_ROLE_SENDER ||
+ int mta_receiver_bit_response(mta_context_t *ctx, int bit_index, 
+                               const OT_SenderMessage *sender_msg,
+                               OT_ReceiverMessage *receiver_msg) {
+     if (!ctx || !sender_msg || !receiver_msg || ctx->role != MTA_ROLE_RECEIVER ||
          bit_index < 0 || bit_index >= MTA_NUM_BITS) {
          return -1;
      }
      
+     ctx->dirty |= MTA_DIRTY_OT_MSGS | MTA_DIRTY_RECEIVER_KEYS;
+     return receiver_bit_response(ctx, bit_index, sender_msg, receiver_msg);
+ }
+  
+ static int sender_bit_complete(mta_context_t *ctx, int bit_index,
+                                const OT_ReceiverMessage *receiver_msg) {
      // Store the receiver's message
      memcpy(&ctx->receiver_msgs[bit_index], receiver_msg, sizeof(OT_ReceiverMessage));
      
@@ -141,13 +264,22 @@
      return 0;
  }
   
- int mta_receiver_bit_complete(mta_context_t *ctx, int bit_index, 
-                               const uint8_t *m0, const uint8_t *m1) {
-     if (!ctx || !m0 || !m1 || ctx->role != MTA_ROLE_RECEIVER ||
+ int mta_sender_bit_complete(mta_context_t *ctx, int bit_index, 
+                             const OT_ReceiverMessage *receiver_msg) {
+     if (!ctx || !receiver_msg || ctx->role != MTA_ROLE_SENDER ||
          bit_index < 0 || bit_index >= MTA_NUM_BITS) {
          return -1;
      }
      
+     ctx->dirty |= MTA_DIRTY_OT_MSGS | MTA_DIRTY_SENDER_KEYS;
+     return sender_bit_complete(ctx, bit_index, receiver_msg);
+ }
+  
+ // Decrypts the chosen message of one bit into received, without
+ // touching the additive share (callers accumulate in bit order)
+ static int receiver_bit_decrypt(mta_context_t *ctx, int bit_index,
+                                 const uint8_t *m0, const uint8_t *m1,
+                                 bignum256 *received_bn) {
      // Get the choice bit for this position
      int choice_bit = ctx->choice_bits[bit_index];
      
@@ -169,16 +301,873 @@
      }
      
      // Convert the received message to a bignum
+     bytes_to_bignum(received, received_bn);
+     memzero(received, sizeof(received));
+     
+     return 0;
+ }
+  
+ int mta_receiver_bit_complete(mta_context_t *ctx, int bit_index, 
+                               const uint8_t *m0, const uint8_t *m1) {
+     if (!ctx || !m0 || !m1 || ctx->role != MTA_ROLE_RECEIVER ||
+         bit_index < 0 || bit_index >= MTA_NUM_BITS) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_PAYLOADS;
      bignum256 received_bn;
-     bytes_to_bignum(received, &received_bn);
+     int ret = receiver_bit_decrypt(ctx, bit_index, m0, m1, &received_bn);
+     if (ret != 0) {
+         return ret;
+     }
+     
+     // Add to the accumulating additive share, reduced in mta_compute_additive_share
+     scalar_acc_add(&ctx->additive_acc, &received_bn);
+     memzero(&received_bn, sizeof(received_bn));
+     
+     return 0;
+ }
+  
+ int mta_sender_bit_encrypt(mta_context_t *ctx, int bit_index, uint8_t *c0, uint8_t *c1) {
+     if (!ctx || !c0 || !c1 || ctx->role != MTA_ROLE_SENDER ||
+         bit_index < 0 || bit_index >= MTA_NUM_BITS) {
+         return -1;
+     }
+     
+     return base_ot_encrypt_messages(ctx->m0_values[bit_index], ctx->m1_values[bit_index],
+                                     ctx->k0_values[bit_index], ctx->k1_values[bit_index],
+                                     c0, c1, 32);
+ }
+  
+ // Arguments of one parallel phase: every bit only touches its own slots
+ // of the context and of the message arrays
+ typedef struct {
+     mta_context_t *ctx;
+     const OT_SenderMessage *sender_msgs;
+     const OT_ReceiverMessage *receiver_msgs;
+     OT_SenderMessage *sender_out;
+     OT_ReceiverMessage *receiver_out;
+     const uint8_t (*c0_in)[32];
+     const uint8_t (*c1_in)[32];
+     uint8_t (*c0_out)[32];
+     uint8_t (*c1_out)[32];
+     bignum256 *received;
+ } mta_parallel_job_t;
+  
+ static int sender_messages_shard(void *arg, size_t begin, size_t end) {
+     mta_parallel_job_t *job = (mta_parallel_job_t *)arg;
+     for (size_t i = begin; i < end; i++) {
+         int ret = sender_bit_message(job->ctx, (int)i, &job->sender_out[i]);
+         if (ret != 0) {
+             return ret;
+         }
+     }
+     return 0;
+ }
+  
+ static int receiver_responses_shard(void *arg, size_t begin, size_t end) {
+     mta_parallel_job_t *job = (mta_parallel_job_t *)arg;
+     for (size_t i = begin; i < end; i++) {
+         int ret = receiver_bit_response(job->ctx, (int)i, &job->sender_msgs[i],
+                                         &job->receiver_out[i]);
+         if (ret != 0) {
+             return ret;
+         }
+     }
+     return 0;
+ }
+  
+ static int sender_complete_shard(void *arg, size_t begin, size_t end) {
+     mta_parallel_job_t *job = (mta_parallel_job_t *)arg;
+     for (size_t i = begin; i < end; i++) {
+         int ret = sender_bit_complete(job->ctx, (int)i, &job->receiver_msgs[i]);
+         if (ret == 0) {
+             ret = mta_sender_bit_encrypt(job->ctx, (int)i, job->c0_out[i], job->c1_out[i]);
+         }
+         if (ret != 0) {
+             return ret;
+         }
+     }
+     return 0;
+ }
+  
+ static int receiver_complete_shard(void *arg, size_t begin, size_t end) {
+     mta_parallel_job_t *job = (mta_parallel_job_t *)arg;
+     for (size_t i = begin; i < end; i++) {
+         int ret = receiver_bit_decrypt(job->ctx, (int)i, job->c0_in[i], job->c1_in[i],
+                                        &job->received[i]);
+         if (ret != 0) {
+             return ret;
+         }
+     }
+     return 0;
+ }
+  
+ // Runs fn over all bits on the pool, or inline when there is no pool
+ static int run_bits(thread_pool_t *pool, thread_pool_fn fn, mta_parallel_job_t *job) {
+     if (!pool) {
+         return fn(job, 0, MTA_NUM_BITS);
+     }
+     return thread_pool_run(pool, MTA_NUM_BITS, fn, job);
+ }
+  
+ int mta_sender_messages_parallel(mta_context_t *ctx, thread_pool_t *pool,
+                                  OT_SenderMessage *messages) {
+     if (!ctx || !messages || ctx->role != MTA_ROLE_SENDER) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_PAYLOADS | MTA_DIRTY_OT_MSGS;
+     mta_parallel_job_t job = { .ctx = ctx, .sender_out = messages };
+     return run_bits(pool, sender_messages_shard, &job);
+ }
+  
+ int mta_receiver_responses_parallel(mta_context_t *ctx, thread_pool_t *pool,
+                                     const OT_SenderMessage *sender_msgs,
+                                     OT_ReceiverMessage *receiver_msgs) {
+     if (!ctx || !sender_msgs || !receiver_msgs || ctx->role != MTA_ROLE_RECEIVER) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_OT_MSGS | MTA_DIRTY_RECEIVER_KEYS;
+     mta_parallel_job_t job = { .ctx = ctx, .sender_msgs = sender_msgs,
+                                .receiver_out = receiver_msgs };
+     return run_bits(pool, receiver_responses_shard, &job);
+ }
+  
+ int mta_sender_complete_parallel(mta_context_t *ctx, thread_pool_t *pool,
+                                  const OT_ReceiverMessage *receiver_msgs,
+                                  uint8_t (*c0)[32], uint8_t (*c1)[32]) {
+     if (!ctx || !receiver_msgs || !c0 || !c1 || ctx->role != MTA_ROLE_SENDER) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_OT_MSGS | MTA_DIRTY_SENDER_KEYS;
+     mta_parallel_job_t job = { .ctx = ctx, .receiver_msgs = receiver_msgs,
+                                .c0_out = c0, .c1_out = c1 };
+     int ret = run_bits(pool, sender_complete_shard, &job);
+     if (ret != 0) {
+         return ret;
+     }
+     
+     return mta_compute_additive_share(ctx);
+ }
+  
+ int mta_receiver_complete_parallel(mta_context_t *ctx, thread_pool_t *pool,
+                                    const uint8_t (*c0)[32], const uint8_t (*c1)[32]) {
+     if (!ctx || !c0 || !c1 || ctx->role != MTA_ROLE_RECEIVER) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_PAYLOADS;
+     bignum256 received[MTA_NUM_BITS];
+     mta_parallel_job_t job = { .ctx = ctx, .c0_in = c0, .c1_in = c1,
+                                .received = received };
+     int ret = run_bits(pool, receiver_complete_shard, &job);
+     
+     // The sum is exact until the single reduction, so the result does not
+     // depend on how the bits were sharded
+     if (ret == 0) {
+         for (int i = 0; i < MTA_NUM_BITS; i++) {
+             scalar_acc_add(&ctx->additive_acc, &received[i]);
+         }
+         scalar_acc_get(&ctx->additive_acc, &ctx->additive_share);
+     }
+     memzero(received, sizeof(received));
+     
+     return ret;
+ }
+  
+ int mta_sender_round1(mta_context_t *ctx, OT_SenderMessage *sender_msgs) {
+     if (!ctx || !sender_msgs || ctx->role != MTA_ROLE_SENDER) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_PAYLOADS | MTA_DIRTY_OT_MSGS;
+     for (int i = 0; i < MTA_NUM_BITS; i++) {
+         sender_bit_values(ctx, i);
+     }
+     
+     int ret = base_ot_sender_message_batch(MTA_NUM_BITS, ctx->sender_private_keys,
+                                            sender_msgs);
+     if (ret != 0) {
+         return ret;
+     }
+     memcpy(ctx->sender_msgs, sender_msgs, sizeof(ctx->sender_msgs));
+     
+     return 0;
+ }
+  
+ int mta_receiver_round1(mta_context_t *ctx, const OT_SenderMessage *sender_msgs,
+                         OT_ReceiverMessage *receiver_msgs) {
+     if (!ctx || !sender_msgs || !receiver_msgs || ctx->role != MTA_ROLE_RECEIVER) {
+         return -1;
+     }
+     
+     // Same choice bits and secrets as the per-bit responses
+     ctx->dirty |= MTA_DIRTY_OT_MSGS | MTA_DIRTY_RECEIVER_KEYS;
+     bignum256 secrets[MTA_NUM_BITS];
+     memcpy(ctx->sender_msgs, sender_msgs, sizeof(ctx->sender_msgs));
+     for (int i = 0; i < MTA_NUM_BITS; i++) {
+         ctx->choice_bits[i] = get_bit(&ctx->share, i);
+         receiver_bit_secret(ctx, i, &secrets[i]);
+     }
+     
+     int ret = base_ot_receiver_choice_batch_keyed(MTA_NUM_BITS, ctx->sender_msgs,
+                                                   ctx->choice_bits, secrets,
+                                                   receiver_msgs, ctx->receiver_keys);
+     memzero(secrets, sizeof(secrets));
+     if (ret != 0) {
+         return ret;
+     }
+     memcpy(ctx->receiver_msgs, receiver_msgs, sizeof(ctx->receiver_msgs));
+     
+     return 0;
+ }
+  
+ int mta_sender_round2(mta_context_t *ctx, const OT_ReceiverMessage *receiver_msgs,
+                       uint8_t (*c0)[32], uint8_t (*c1)[32]) {
+     if (!ctx || !receiver_msgs || !c0 || !c1 || ctx->role != MTA_ROLE_SENDER) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_OT_MSGS | MTA_DIRTY_SENDER_KEYS;
+     memcpy(ctx->receiver_msgs, receiver_msgs, sizeof(ctx->receiver_msgs));
+     int ret = base_ot_sender_keys_batch(MTA_NUM_BITS, ctx->sender_private_keys,
+                                         ctx->receiver_msgs, ctx->k0_values, ctx->k1_values);
+     for (int i = 0; ret == 0 && i < MTA_NUM_BITS; i++) {
+         ret = mta_sender_bit_encrypt(ctx, i, c0[i], c1[i]);
+     }
+     if (ret != 0) {
+         return ret;
+     }
+     
+     return mta_compute_additive_share(ctx);
+ }
+  
+ int mta_receiver_round2(mta_context_t *ctx, const uint8_t (*c0)[32], const uint8_t (*c1)[32]) {
+     if (!ctx || !c0 || !c1 || ctx->role != MTA_ROLE_RECEIVER) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_PAYLOADS;
+     bignum256 received;
+     for (int i = 0; i < MTA_NUM_BITS; i++) {
+         int ret = receiver_bit_decrypt(ctx, i, c0[i], c1[i], &received);
+         if (ret != 0) {
+             memzero(&received, sizeof(received));
+             return ret;
+         }
+         scalar_acc_add(&ctx->additive_acc, &received);
+     }
+     memzero(&received, sizeof(received));
+     
+     return mta_compute_additive_share(ctx);
+ }
+  
+ int mta_sender_round1_simplest(mta_context_t *ctx, OT_SenderMessage *sender_msg) {
+     if (!ctx || !sender_msg || ctx->role != MTA_ROLE_SENDER) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_PAYLOADS | MTA_DIRTY_SIMPLEST;
+     for (int i = 0; i < MTA_NUM_BITS; i++) {
+         sender_bit_values(ctx, i);
+     }
+     
+     // The first seeded key serves every bit, its indices are the bit indices
+     int ret = base_ot_simplest_sender_init(&ctx->simplest_ot, &ctx->sender_private_keys[0]);
+     if (ret != 0) {
+         return ret;
+     }
+     memcpy(sender_msg, &ctx->simplest_ot.message, sizeof(OT_SenderMessage));
+     
+     return 0;
+ }
+  
+ int mta_receiver_round1_simplest(mta_context_t *ctx, const OT_SenderMessage *sender_msg,
+                                  OT_ReceiverMessage *receiver_msgs) {
+     if (!ctx || !sender_msg || !receiver_msgs || ctx->role != MTA_ROLE_RECEIVER) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_OT_MSGS | MTA_DIRTY_RECEIVER_KEYS;
+     bignum256 secrets[MTA_NUM_BITS];
+     for (int i = 0; i < MTA_NUM_BITS; i++) {
+         memcpy(&ctx->sender_msgs[i], sender_msg, sizeof(OT_SenderMessage));
+         ctx->choice_bits[i] = get_bit(&ctx->share, i);
+         receiver_bit_secret(ctx, i, &secrets[i]);
+     }
+     
+     int ret = base_ot_simplest_receiver_choice_batch(MTA_NUM_BITS, 0, sender_msg,
+                                                      ctx->choice_bits, secrets,
+                                                      receiver_msgs, ctx->receiver_keys);
+     memzero(secrets, sizeof(secrets));
+     if (ret != 0) {
+         return ret;
+     }
+     memcpy(ctx->receiver_msgs, receiver_msgs, sizeof(ctx->receiver_msgs));
+     
+     return 0;
+ }
+  
+ int mta_sender_round2_simplest(mta_context_t *ctx, const OT_ReceiverMessage *receiver_msgs,
+                                uint8_t (*c0)[32], uint8_t (*c1)[32]) {
+     if (!ctx || !receiver_msgs || !c0 || !c1 || ctx->role != MTA_ROLE_SENDER ||
+         bn_is_zero(&ctx->simplest_ot.a)) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_OT_MSGS | MTA_DIRTY_SENDER_KEYS;
+     memcpy(ctx->receiver_msgs, receiver_msgs, sizeof(ctx->receiver_msgs));
+     int ret = base_ot_simplest_sender_keys_batch(&ctx->simplest_ot, MTA_NUM_BITS, 0,
+                                                  ctx->receiver_msgs,
+                                                  ctx->k0_values, ctx->k1_values);
+     for (int i = 0; ret == 0 && i < MTA_NUM_BITS; i++) {
+         ret = mta_sender_bit_encrypt(ctx, i, c0[i], c1[i]);
+     }
+     
+     // The key pair is bound to this instance's indices, never reuse it
+     base_ot_simplest_sender_clear(&ctx->simplest_ot);
+     if (ret != 0) {
+         return ret;
+     }
+     
+     return mta_compute_additive_share(ctx);
+ }
+  
+ // Sender side of one MtA over extended OTs: Ui is the key for choice 0, and
+ // the correction m1 - k1 makes the key for choice 1 open to m1 = Ui + x(2^i).
+ // shifted holds x(2^i) per bit (mta_precompute_shifted_shares).
+ // Stores Ui in random_values when given, and returns ΣUi in sum_Ui.
+ static void ext_sender_corrections(const bignum256 *shifted,
+                                    const uint8_t (*k0)[32], const uint8_t (*k1)[32],
+                                    bignum256 *random_values, bignum256 *sum_Ui,
+                                    uint8_t (*corrections)[32]) {
+     scalar_acc_t acc;
+     scalar_acc_init(&acc);
+     
+     for (int i = 0; i < MTA_NUM_BITS; i++) {
+         bignum256 Ui;
+         bytes_to_bignum(k0[i], &Ui);
+         if (random_values) {
+             bn_copy(&Ui, &random_values[i]);
+         }
+         scalar_acc_add(&acc, &Ui);
+         
+         // m1 = Ui + x(2^i)
+         bignum256 m1_bn;
+         bn_copy(&Ui, &m1_bn);
+         bn_add(&m1_bn, &shifted[i]);
+         bn_mod(&m1_bn, &secp256k1.order);
+         
+         // Correction = m1 - k1
+         bignum256 k1_bn, correction;
+         bytes_to_bignum(k1[i], &k1_bn);
+         bn_subtractmod(&m1_bn, &k1_bn, &correction, &secp256k1.order);
+         bn_fast_mod(&correction, &secp256k1.order);
+         bn_mod(&correction, &secp256k1.order);
+         bignum_to_bytes(&correction, corrections[i]);
+     }
+     
+     scalar_acc_get(&acc, sum_Ui);
+     memzero(&acc, sizeof(acc));
+ }
+  
+ // Receiver side of one MtA over extended OTs: adds the received value of
+ // every bit of y to acc, applying the correction where the choice bit is 1
+ static void ext_receiver_accumulate(const bignum256 *y, const uint8_t (*keys)[32],
+                                     const uint8_t (*corrections)[32], scalar_acc_t *acc) {
+     for (int i = 0; i < MTA_NUM_BITS; i++) {
+         bignum256 received_bn;
+         bytes_to_bignum(keys[i], &received_bn);
+         scalar_acc_add(acc, &received_bn);
+         
+         // key + correction = m1, the sum is reduced only once at the end
+         if (bn_testbit(y, i)) {
+             bytes_to_bignum(corrections[i], &received_bn);
+             scalar_acc_add(acc, &received_bn);
+         }
+         
+         memzero(&received_bn, sizeof(received_bn));
+     }
+ }
+  
+ int mta_receiver_ext_choose(mta_context_t *ctx, ot_ext_receiver_t *ot, uint8_t *matrix) {
+     if (!ctx || !ot || !matrix || ctx->role != MTA_ROLE_RECEIVER) {
+         return -1;
+     }
+     
+     // The choice bits are the bits of y, least significant first
+     ctx->dirty |= MTA_DIRTY_RECEIVER_KEYS;
+     uint8_t choices[32];
+     bn_write_le(&ctx->share, choices);
+     
+     for (int i = 0; i < MTA_NUM_BITS; i++) {
+         ctx->choice_bits[i] = get_bit(&ctx->share, i);
+     }
+     
+     // The key of the chosen message is kept until the corrections arrive
+     int ret = ot_ext_receiver_extend(ot, choices, MTA_NUM_BITS, matrix, ctx->receiver_keys);
+     memzero(choices, sizeof(choices));
+     
+     return ret;
+ }
+  
+ int mta_sender_ext_transfer(mta_context_t *ctx, ot_ext_sender_t *ot,
+                             const uint8_t *matrix, uint8_t (*corrections)[32]) {
+     if (!ctx || !ot || !matrix || !corrections || ctx->role != MTA_ROLE_SENDER) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_SENDER_KEYS;
+     int ret = ot_ext_sender_extend(ot, matrix, MTA_NUM_BITS, ctx->k0_values, ctx->k1_values);
+     if (ret != 0) {
+         return ret;
+     }
+     
+     // The sender's additive share is -ΣUi
+     bignum256 sum_Ui;
+     ext_sender_corrections(ctx->shifted_shares,
+                            (const uint8_t (*)[32])ctx->k0_values,
+                            (const uint8_t (*)[32])ctx->k1_values,
+                            ctx->random_values, &sum_Ui, corrections);
+     bn_subtract(&secp256k1.order, &sum_Ui, &ctx->additive_share);
+     bn_mod(&ctx->additive_share, &secp256k1.order);
+     memzero(&sum_Ui, sizeof(sum_Ui));
+     
+     return 0;
+ }
+  
+ int mta_receiver_ext_complete(mta_context_t *ctx, const uint8_t (*corrections)[32]) {
+     if (!ctx || !corrections || ctx->role != MTA_ROLE_RECEIVER) {
+         return -1;
+     }
+     
+     ext_receiver_accumulate(&ctx->share, (const uint8_t (*)[32])ctx->receiver_keys,
+                             corrections, &ctx->additive_acc);
+     scalar_acc_get(&ctx->additive_acc, &ctx->additive_share);
+     
+     return 0;
+ }
+  
+ int mta_receiver_rot_choose(mta_context_t *ctx, rot_receiver_pool_t *pool,
+                             uint64_t *first_index, uint8_t *flips) {
+     if (!ctx || !pool || !first_index || !flips || ctx->role != MTA_ROLE_RECEIVER) {
+         return -1;
+     }
+     
+     // The choice bits are the bits of y, least significant first
+     ctx->dirty |= MTA_DIRTY_RECEIVER_KEYS;
+     uint8_t choices[32];
+     bn_write_le(&ctx->share, choices);
+     
+     for (int i = 0; i < MTA_NUM_BITS; i++) {
+         ctx->choice_bits[i] = get_bit(&ctx->share, i);
+     }
+     
+     int ret = rot_receiver_pool_derandomize(pool, choices, MTA_NUM_BITS, first_index,
+                                             flips, ctx->receiver_keys);
+     memzero(choices, sizeof(choices));
+     
+     return ret;
+ }
+  
+ int mta_sender_rot_transfer(mta_context_t *ctx, rot_sender_pool_t *pool, uint64_t first_index,
+                             const uint8_t *flips, uint8_t (*corrections)[32]) {
+     if (!ctx || !pool || !flips || !corrections || ctx->role != MTA_ROLE_SENDER) {
+         return -1;
+     }
+     
+     ctx->dirty |= MTA_DIRTY_SENDER_KEYS;
+     int ret = rot_sender_pool_derandomize(pool, first_index, flips, MTA_NUM_BITS,
+                                           ctx->k0_values, ctx->k1_values);
+     if (ret != 0) {
+         return ret;
+     }
      
-     // Add to the accumulating additive share
-     bn_add(&ctx->additive_share, &received_bn);
+     // The sender's additive share is -ΣUi
+     bignum256 sum_Ui;
+     ext_sender_corrections(ctx->shifted_shares,
+                            (const uint8_t (*)[32])ctx->k0_values,
+                            (const uint8_t (*)[32])ctx->k1_values,
+                            ctx->random_values, &sum_Ui, corrections);
+     bn_subtract(&secp256k1.order, &sum_Ui, &ctx->additive_share);
      bn_mod(&ctx->additive_share, &secp256k1.order);
+     memzero(&sum_Ui, sizeof(sum_Ui));
+     
+     return 0;
+ }
+  
+ // Labels of the values a compact sender derives from its seed
+ #define COMPACT_LABEL_U 'U'
+ #define COMPACT_LABEL_A 'A'
+  
+ // out = SHA-256(seed || label || bit_index || counter) mod order; the
+ // counter is only bumped when a non-zero value is required and the
+ // digest reduces to zero
+ static void compact_derive(const uint8_t *seed, uint8_t label, int bit_index,
+                            int nonzero, bignum256 *out) {
+     uint8_t input[32 + 4];
+     uint8_t digest[SHA256_DIGEST_LENGTH];
+     
+     memcpy(input, seed, 32);
+     input[32] = label;
+     input[33] = (bit_index >> 8) & 0xff;
+     input[34] = bit_index & 0xff;
+     input[35] = 0;
+     
+     do {
+         sha256_Raw(input, sizeof(input), digest);
+         bytes_to_bignum(digest, out);
+         input[35]++;
+     } while (nonzero && bn_is_zero(out));
+     
+     memzero(digest, sizeof(digest));
+     memzero(input, sizeof(input));
+ }
+  
+ static int compact_is_done(const mta_compact_t *ctx, int bit_index) {
+     return (ctx->done[bit_index >> 3] >> (bit_index & 7)) & 1;
+ }
+  
+ static void compact_set_done(mta_compact_t *ctx, int bit_index) {
+     ctx->done[bit_index >> 3] |= 1 << (bit_index & 7);
+ }
+  
+ int mta_compact_init(mta_compact_t *ctx, mta_role_t role, const bignum256 *share) {
+     if (!ctx || !share) {
+         return -1;
+     }
+     
+     memset(ctx, 0, sizeof(mta_compact_t));
+     ctx->role = role;
+     bn_copy(share, &ctx->share);
+     scalar_acc_init(&ctx->additive_acc);
+     for (int s = 0; s < MTA_COMPACT_WINDOW; s++) {
+         ctx->pending_bits[s] = -1;
+     }
+     
+     // Everything the sender needs per bit is derived from this seed
+     if (role == MTA_ROLE_SENDER) {
+         random_buffer(ctx->seed, sizeof(ctx->seed));
+         bn_copy(share, &ctx->shifted_share);
+         bn_mod(&ctx->shifted_share, &secp256k1.order);
+         ctx->shifted_bit = 0;
+     }
+     
+     return 0;
+ }
+  
+ // Moves the sender's x(2^i) to bit_index: one modular doubling when bits
+ // complete in order, a multiplication by 2^i otherwise
+ static void compact_shift_to(mta_compact_t *ctx, int bit_index) {
+     if (bit_index == ctx->shifted_bit + 1) {
+         bn_lshift(&ctx->shifted_share);
+         bn_mod(&ctx->shifted_share, &secp256k1.order);
+     } else if (bit_index != ctx->shifted_bit) {
+         bignum256 power2i;
+         pow2_bignum(bit_index, &power2i);
+         bn_copy(&ctx->share, &ctx->shifted_share);
+         bn_multiply(&power2i, &ctx->shifted_share, &secp256k1.order);
+         bn_mod(&ctx->shifted_share, &secp256k1.order);
+     }
+     ctx->shifted_bit = bit_index;
+ }
+  
+ int mta_compact_sender_bit_message(mta_compact_t *ctx, int bit_index, OT_SenderMessage *message) {
+     if (!ctx || !message || ctx->role != MTA_ROLE_SENDER ||
+         bit_index < 0 || bit_index >= MTA_NUM_BITS) {
+         return -1;
+     }
+     
+     bignum256 a;
+     compact_derive(ctx->seed, COMPACT_LABEL_A, bit_index, 1, &a);
+     int ret = base_ot_sender_message(&a, message);
+     memzero(&a, sizeof(a));
+     
+     return ret;
+ }
+  
+ int mta_compact_receiver_bit_response(mta_compact_t *ctx, int bit_index,
+                                       const OT_SenderMessage *sender_msg,
+                                       OT_ReceiverMessage *receiver_msg) {
+     if (!ctx || !sender_msg || !receiver_msg || ctx->role != MTA_ROLE_RECEIVER ||
+         bit_index < 0 || bit_index >= MTA_NUM_BITS || compact_is_done(ctx, bit_index)) {
+         return -1;
+     }
+     
+     // Find a free slot, the bit must not already be in flight
+     int slot = -1;
+     for (int s = 0; s < MTA_COMPACT_WINDOW; s++) {
+         if (ctx->pending_bits[s] == bit_index) {
+             return -1;
+         }
+         if (slot < 0 && ctx->pending_bits[s] < 0) {
+             slot = s;
+         }
+     }
+     if (slot < 0) {
+         LOG_ERROR("No free slot for bit %d, complete pending bits first", bit_index);
+         return -3;
+     }
+     
+     int ret = base_ot_receiver_choice(sender_msg, get_bit(&ctx->share, bit_index),
+                                       receiver_msg, ctx->pending_keys[slot]);
+     if (ret != 0) {
+         return ret;
+     }
+     
+     ctx->pending_bits[slot] = bit_index;
+     return 0;
+ }
+  
+ int mta_compact_sender_bit_complete(mta_compact_t *ctx, int bit_index,
+                                     const OT_ReceiverMessage *receiver_msg,
+                                     uint8_t *c0, uint8_t *c1) {
+     if (!ctx || !receiver_msg || !c0 || !c1 || ctx->role != MTA_ROLE_SENDER ||
+         bit_index < 0 || bit_index >= MTA_NUM_BITS || compact_is_done(ctx, bit_index)) {
+         return -1;
+     }
+     
+     bignum256 a, Ui, m1_bn;
+     uint8_t k0[32], k1[32], m0[32], m1[32];
+     
+     compact_derive(ctx->seed, COMPACT_LABEL_A, bit_index, 1, &a);
+     int ret = base_ot_sender_keys(&a, receiver_msg, k0, k1);
+     memzero(&a, sizeof(a));
+     
+     if (ret == 0) {
+         // m0 = Ui, m1 = Ui + x(2^i)
+         compact_derive(ctx->seed, COMPACT_LABEL_U, bit_index, 0, &Ui);
+         compact_shift_to(ctx, bit_index);
+         bn_copy(&Ui, &m1_bn);
+         bn_add(&m1_bn, &ctx->shifted_share);
+         bn_mod(&m1_bn, &secp256k1.order);
+         
+         bignum_to_bytes(&Ui, m0);
+         bignum_to_bytes(&m1_bn, m1);
+         ret = base_ot_encrypt_messages(m0, m1, k0, k1, c0, c1, 32);
+     }
+     
+     // The sender's additive share is -ΣUi, negated when it is requested
+     if (ret == 0) {
+         scalar_acc_add(&ctx->additive_acc, &Ui);
+         compact_set_done(ctx, bit_index);
+     }
+     
+     memzero(&Ui, sizeof(Ui));
+     memzero(&m1_bn, sizeof(m1_bn));
+     memzero(k0, sizeof(k0));
+     memzero(k1, sizeof(k1));
+     memzero(m0, sizeof(m0));
+     memzero(m1, sizeof(m1));
+     
+     return ret;
+ }
+  
+ int mta_compact_receiver_bit_complete(mta_compact_t *ctx, int bit_index,
+                                       const uint8_t *c0, const uint8_t *c1) {
+     if (!ctx || !c0 || !c1 || ctx->role != MTA_ROLE_RECEIVER ||
+         bit_index < 0 || bit_index >= MTA_NUM_BITS) {
+         return -1;
+     }
+     
+     int slot = -1;
+     for (int s = 0; s < MTA_COMPACT_WINDOW; s++) {
+         if (ctx->pending_bits[s] == bit_index) {
+             slot = s;
+         }
+     }
+     if (slot < 0) {
+         LOG_ERROR("Bit %d has no pending response", bit_index);
+         return -1;
+     }
+     
+     uint8_t received[32];
+     int ret = base_ot_receive_message(get_bit(&ctx->share, bit_index),
+                                       ctx->pending_keys[slot], c0, c1,
+                                       received, 32);
+     if (ret == 0) {
+         bignum256 received_bn;
+         bytes_to_bignum(received, &received_bn);
+         scalar_acc_add(&ctx->additive_acc, &received_bn);
+         memzero(&received_bn, sizeof(received_bn));
+         compact_set_done(ctx, bit_index);
+     }
+     
+     // The key is used once, the slot is free again
+     memzero(ctx->pending_keys[slot], 32);
+     ctx->pending_bits[slot] = -1;
+     memzero(received, sizeof(received));
+     
+     return ret;
+ }
+  
+ int mta_compact_get_additive_share(const mta_compact_t *ctx, bignum256 *share) {
+     if (!ctx || !share) {
+         return -1;
+     }
+     
+     for (int i = 0; i < MTA_NUM_BITS / 8; i++) {
+         if (ctx->done[i] != 0xff) {
+             LOG_ERROR("MtA share requested before all bits completed");
+             return -2;
+         }
+     }
+     
+     scalar_acc_get(&ctx->additive_acc, share);
+     if (ctx->role == MTA_ROLE_SENDER) {
+         bignum256 sum_Ui;
+         bn_copy(share, &sum_Ui);
+         bn_subtract(&secp256k1.order, &sum_Ui, share);
+         bn_mod(share, &secp256k1.order);
+         memzero(&sum_Ui, sizeof(sum_Ui));
+     }
+     return 0;
+ }
+  
+ void mta_compact_clear(mta_compact_t *ctx) {
+     if (ctx) {
+         memzero(ctx, sizeof(mta_compact_t));
+     }
+ }
+  
+ int mta_batch_init(mta_batch_t *batch, mta_role_t role,
+                    const bignum256 *shares, size_t count) {
+     if (!batch || !shares || count == 0 ||
+         (role != MTA_ROLE_SENDER && role != MTA_ROLE_RECEIVER) ||
+         count > SIZE_MAX / (2 * sizeof(bignum256) + MTA_NUM_BITS * 32)) {
+         return -1;
+     }
+     
+     memset(batch, 0, sizeof(mta_batch_t));
+     
+     // One allocation holds inputs, outputs and the receiver's pending keys
+     size_t keys_len = role == MTA_ROLE_RECEIVER ? count * MTA_NUM_BITS * 32 : 0;
+     size_t total = 2 * count * sizeof(bignum256) + keys_len;
+     uint8_t *memory = calloc(1, total);
+     if (!memory) {
+         LOG_ERROR("Failed to allocate MtA batch of %zu instances", count);
+         return -2;
+     }
+     
+     batch->role = role;
+     batch->count = count;
+     batch->shares = (bignum256 *)memory;
+     batch->additive_shares = batch->shares + count;
+     batch->keys = keys_len ? (uint8_t (*)[32])(batch->additive_shares + count) : NULL;
+     batch->memory_len = total;
+     
+     memcpy(batch->shares, shares, count * sizeof(bignum256));
+     
+     return 0;
+ }
+  
+ int mta_batch_receiver_choose(mta_batch_t *batch, ot_ext_receiver_t *ot, uint8_t *matrix) {
+     if (!batch || !ot || !matrix || batch->role != MTA_ROLE_RECEIVER || !batch->keys) {
+         return -1;
+     }
+     
+     LOG_DEBUG("MtA batch (Bob): choosing for %zu instances", batch->count);
+     
+     uint8_t choices[32];
+     for (size_t k = 0; k < batch->count; k++) {
+         bn_write_le(&batch->shares[k], choices);
+         
+         int ret = ot_ext_receiver_extend(ot, choices, MTA_NUM_BITS,
+                                          matrix + k * MTA_EXT_MATRIX_LEN,
+                                          batch->keys + k * MTA_NUM_BITS);
+         if (ret != 0) {
+             memzero(choices, sizeof(choices));
+             return ret;
+         }
+     }
+     memzero(choices, sizeof(choices));
      
      return 0;
  }
   
+ int mta_batch_sender_transfer(mta_batch_t *batch, ot_ext_sender_t *ot,
+                               const uint8_t *matrix, uint8_t *corrections) {
+     if (!batch || !ot || !matrix || !corrections || batch->role != MTA_ROLE_SENDER) {
+         return -1;
+     }
+     
+     LOG_DEBUG("MtA batch (Alice): transferring for %zu instances", batch->count);
+     
+     // Keys and shifted shares are only needed while the corrections of one
+     // instance are computed
+     uint8_t k0[MTA_NUM_BITS][32], k1[MTA_NUM_BITS][32];
+     bignum256 shifted[MTA_NUM_BITS];
+     int ret = 0;
+     
+     for (size_t k = 0; k < batch->count; k++) {
+         ret = ot_ext_sender_extend(ot, matrix + k * MTA_EXT_MATRIX_LEN, MTA_NUM_BITS, k0, k1);
+         if (ret != 0) {
+             break;
+         }
+         
+         // The sender's additive share is -ΣUi
+         bignum256 sum_Ui;
+         mta_precompute_shifted_shares(&batch->shares[k], shifted);
+         ext_sender_corrections(shifted,
+                                (const uint8_t (*)[32])k0, (const uint8_t (*)[32])k1,
+                                NULL, &sum_Ui,
+                                (uint8_t (*)[32])(corrections + k * MTA_NUM_BITS * 32));
+         bn_subtract(&secp256k1.order, &sum_Ui, &batch->additive_shares[k]);
+         bn_mod(&batch->additive_shares[k], &secp256k1.order);
+         memzero(&sum_Ui, sizeof(sum_Ui));
+     }
+     
+     memzero(k0, sizeof(k0));
+     memzero(k1, sizeof(k1));
+     memzero(shifted, sizeof(shifted));
+     
+     return ret;
+ }
+  
+ int mta_batch_receiver_complete(mta_batch_t *batch, const uint8_t *corrections) {
+     if (!batch || !corrections || batch->role != MTA_ROLE_RECEIVER || !batch->keys) {
+         return -1;
+     }
+     
+     for (size_t k = 0; k < batch->count; k++) {
+         scalar_acc_t acc;
+         scalar_acc_init(&acc);
+         ext_receiver_accumulate(&batch->shares[k],
+                                 (const uint8_t (*)[32])(batch->keys + k * MTA_NUM_BITS),
+                                 (const uint8_t (*)[32])(corrections + k * MTA_NUM_BITS * 32),
+                                 &acc);
+         scalar_acc_get(&acc, &batch->additive_shares[k]);
+         memzero(&acc, sizeof(acc));
+     }
+     
+     // The pending keys are consumed
+     memzero(batch->keys, batch->count * MTA_NUM_BITS * 32);
+     
+     return 0;
+ }
+  
+ int mta_batch_get_additive_shares(const mta_batch_t *batch, bignum256 *shares) {
+     if (!batch || !shares || !batch->additive_shares) {
+         return -1;
+     }
+     
+     memcpy(shares, batch->additive_shares, batch->count * sizeof(bignum256));
+     return 0;
+ }
+  
+ void mta_batch_free(mta_batch_t *batch) {
+     if (!batch || !batch->shares) {
+         return;
+     }
+     
+     memzero(batch->shares, batch->memory_len);
+     free(batch->shares);
+     memset(batch, 0, sizeof(mta_batch_t));
+ }
+  
  int mta_compute_additive_share(mta_context_t *ctx) {
      if (!ctx) {
          return -1;
@@ -187,20 +1176,23 @@
      if (ctx->role == MTA_ROLE_SENDER) {
          // For the sender (Alice), the additive share is -ΣUi
          bignum256 sum_Ui;
-         bn_zero(&sum_Ui);
+         scalar_acc_t acc;
+         scalar_acc_init(&acc);
          
-         // Sum all random values Ui for all bits
+         // Sum all random values Ui for all bits, reduced once
          for (int i = 0; i < MTA_NUM_BITS; i++) {
-             bn_add(&sum_Ui, &ctx->random_values[i]);
-             bn_mod(&sum_Ui, &secp256k1.order);
+             scalar_acc_add(&acc, &ctx->random_values[i]);
          }
+         scalar_acc_get(&acc, &sum_Ui);
+         memzero(&acc, sizeof(acc));
          
          // Negate the sum: -sum_Ui = order - sum_Ui
          bn_subtract(&secp256k1.order, &sum_Ui, &ctx->additive_share);
          bn_mod(&ctx->additive_share, &secp256k1.order);
      } else {
-         // For the receiver (Bob), the additive share has already been accumulated in mta_receiver_bit_complete
-         bn_mod(&ctx->additive_share, &secp256k1.order);
+         // For the receiver (Bob), the received values have already been summed in
+         // mta_receiver_bit_complete (or by the parallel and extension paths)
+         scalar_acc_get(&ctx->additive_acc, &ctx->additive_share);
      }
      
      return 0;
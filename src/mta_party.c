@@ -0,0 +1,310 @@
+/*
+  Implementation of the MtA parties
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mta_party.h"
+#include "logger.h"
+#include "memzero.h"
+
+// Checks that a received frame belongs to this instance and covers all bits
+static int check_frame(const wire_header_t *header, uint64_t instance_id) {
+    if (header->instance_id != instance_id || header->num_instances != 1 ||
+        header->first_bit != 0 || header->num_bits != MTA_NUM_BITS) {
+        LOG_ERROR("Unexpected frame for instance %llu (bits %u+%u)",
+                  (unsigned long long)header->instance_id,
+                  header->first_bit, header->num_bits);
+        return -4;
+    }
+    return 0;
+}
+
+int mta_party_run_sender(mta_context_t *ctx, transport_t *t, thread_pool_t *pool,
+                         uint64_t instance_id) {
+    if (!ctx || !t || ctx->role != MTA_ROLE_SENDER) {
+        LOG_ERROR("Invalid parameters in mta_party_run_sender");
+        return -1;
+    }
+
+    uint8_t *buf = malloc(MTA_PARTY_FRAME_LEN);
+    uint8_t *reply = malloc(MTA_PARTY_FRAME_LEN);
+    if (!buf || !reply) {
+        free(buf);
+        free(reply);
+        return -3;
+    }
+
+    uint8_t *out;
+    const uint8_t *in;
+    wire_header_t header;
+
+    // Round 1: OT sender messages, written in place
+    int ret = wire_frame_begin(buf, MTA_PARTY_FRAME_LEN, WIRE_OT_SENDER_MSGS,
+                               instance_id, 1, 0, MTA_NUM_BITS, &out);
+    if (ret == 0 && pool) {
+        ret = mta_sender_messages_parallel(ctx, pool, (OT_SenderMessage *)out);
+    } else if (ret == 0) {
+        ret = mta_sender_round1(ctx, (OT_SenderMessage *)out);
+    }
+    if (ret == 0) {
+        ret = transport_send_frame(t, buf);
+    }
+
+    // Round 2: the receiver's responses
+    if (ret == 0) {
+        ret = transport_recv_frame(t, buf, MTA_PARTY_FRAME_LEN, &header, &in);
+    }
+    if (ret == 0 && header.type != WIRE_OT_RECEIVER_MSGS) {
+        LOG_ERROR("Expected OT receiver messages, got frame type %d", header.type);
+        ret = -4;
+    }
+    if (ret == 0) {
+        ret = check_frame(&header, instance_id);
+    }
+
+    // Round 3: the ciphertexts, computed from the responses still in buf
+    if (ret == 0) {
+        ret = wire_frame_begin(reply, MTA_PARTY_FRAME_LEN, WIRE_CIPHERTEXTS,
+                               instance_id, 1, 0, MTA_NUM_BITS, &out);
+    }
+    if (ret == 0 && pool) {
+        ret = mta_sender_complete_parallel(ctx, pool, (const OT_ReceiverMessage *)in,
+                                           (uint8_t (*)[32])out,
+                                           (uint8_t (*)[32])(out + MTA_NUM_BITS * 32));
+    } else if (ret == 0) {
+        ret = mta_sender_round2(ctx, (const OT_ReceiverMessage *)in, (uint8_t (*)[32])out,
+                                (uint8_t (*)[32])(out + MTA_NUM_BITS * 32));
+    }
+    if (ret == 0) {
+        ret = transport_send_frame(t, reply);
+    }
+
+    free(reply);
+    free(buf);
+
+    return ret;
+}
+
+int mta_party_run_receiver(mta_context_t *ctx, transport_t *t, thread_pool_t *pool,
+                           uint64_t instance_id) {
+    if (!ctx || !t || ctx->role != MTA_ROLE_RECEIVER) {
+        LOG_ERROR("Invalid parameters in mta_party_run_receiver");
+        return -1;
+    }
+
+    uint8_t *buf = malloc(MTA_PARTY_FRAME_LEN);
+    uint8_t *reply = malloc(MTA_PARTY_FRAME_LEN);
+    if (!buf || !reply) {
+        free(buf);
+        free(reply);
+        return -3;
+    }
+
+    uint8_t *out;
+    const uint8_t *in;
+    const uint8_t (*c0)[32], (*c1)[32];
+    wire_header_t header;
+
+    // Round 1: the sender's OT messages
+    int ret = transport_recv_frame(t, buf, MTA_PARTY_FRAME_LEN, &header, &in);
+    if (ret == 0 && header.type != WIRE_OT_SENDER_MSGS) {
+        LOG_ERROR("Expected OT sender messages, got frame type %d", header.type);
+        ret = -4;
+    }
+    if (ret == 0) {
+        ret = check_frame(&header, instance_id);
+    }
+
+    // Round 2: responses, written in place
+    if (ret == 0) {
+        ret = wire_frame_begin(reply, MTA_PARTY_FRAME_LEN, WIRE_OT_RECEIVER_MSGS,
+                               instance_id, 1, 0, MTA_NUM_BITS, &out);
+    }
+    if (ret == 0 && pool) {
+        ret = mta_receiver_responses_parallel(ctx, pool, (const OT_SenderMessage *)in,
+                                              (OT_ReceiverMessage *)out);
+    } else if (ret == 0) {
+        ret = mta_receiver_round1(ctx, (const OT_SenderMessage *)in, (OT_ReceiverMessage *)out);
+    }
+    if (ret == 0) {
+        ret = transport_send_frame(t, reply);
+    }
+
+    // Round 3: decrypt the chosen messages straight from the frame
+    if (ret == 0) {
+        ret = transport_recv_frame(t, buf, MTA_PARTY_FRAME_LEN, &header, &in);
+    }
+    if (ret == 0) {
+        ret = wire_decode_ciphertexts(buf, MTA_PARTY_FRAME_LEN, &header, &c0, &c1);
+    }
+    if (ret == 0) {
+        ret = check_frame(&header, instance_id);
+    }
+    if (ret == 0 && pool) {
+        ret = mta_receiver_complete_parallel(ctx, pool, c0, c1);
+    } else if (ret == 0) {
+        ret = mta_receiver_round2(ctx, c0, c1);
+    }
+
+    memzero(buf, MTA_PARTY_FRAME_LEN);
+    free(buf);
+    free(reply);
+
+    return ret;
+}
+
+int mta_party_run_sender_pipelined(mta_context_t *ctx, transport_t *t,
+                                   uint64_t instance_id, int window, int chunk) {
+    if (!ctx || !t || ctx->role != MTA_ROLE_SENDER || chunk < 1 ||
+        window < chunk || window > MTA_NUM_BITS) {
+        LOG_ERROR("Invalid parameters in mta_party_run_sender_pipelined");
+        return -1;
+    }
+
+    uint8_t *buf = malloc(MTA_PARTY_FRAME_LEN);
+    uint8_t *reply = malloc(MTA_PARTY_FRAME_LEN);
+    if (!buf || !reply) {
+        free(buf);
+        free(reply);
+        return -3;
+    }
+
+    // Bits [done, next) have messages out and no ciphertexts yet
+    int next = 0, done = 0;
+    int ret = 0;
+
+    while (ret == 0 && done < MTA_NUM_BITS) {
+        // Keep the window full
+        while (ret == 0 && next < MTA_NUM_BITS) {
+            int count = MTA_NUM_BITS - next < chunk ? MTA_NUM_BITS - next : chunk;
+            if (next - done + count > window) {
+                break;
+            }
+
+            uint8_t *out;
+            ret = wire_frame_begin(reply, MTA_PARTY_FRAME_LEN, WIRE_OT_SENDER_MSGS,
+                                   instance_id, 1, next, count, &out);
+            for (int j = 0; ret == 0 && j < count; j++) {
+                ret = mta_sender_bit_message(ctx, next + j, (OT_SenderMessage *)out + j);
+            }
+            if (ret == 0) {
+                ret = transport_send_frame(t, reply);
+            }
+            next += count;
+        }
+
+        // Responses come back in order, the oldest chunk first
+        wire_header_t header;
+        const OT_ReceiverMessage *responses;
+        if (ret == 0) {
+            ret = transport_recv_frame(t, buf, MTA_PARTY_FRAME_LEN, &header,
+                                       (const uint8_t **)&responses);
+        }
+        if (ret == 0 && (header.type != WIRE_OT_RECEIVER_MSGS ||
+                         header.instance_id != instance_id || header.num_instances != 1 ||
+                         header.first_bit != done || done + header.num_bits > next)) {
+            LOG_ERROR("Unexpected frame (type %d, bits %u+%u) with bits %d..%d in flight",
+                      header.type, header.first_bit, header.num_bits, done, next - 1);
+            ret = -4;
+        }
+
+        uint8_t *out;
+        if (ret == 0) {
+            ret = wire_frame_begin(reply, MTA_PARTY_FRAME_LEN, WIRE_CIPHERTEXTS,
+                                   instance_id, 1, done, header.num_bits, &out);
+        }
+        for (int j = 0; ret == 0 && j < header.num_bits; j++) {
+            ret = mta_sender_bit_complete(ctx, done + j, &responses[j]);
+            if (ret == 0) {
+                ret = mta_sender_bit_encrypt(ctx, done + j, out + j * 32,
+                                             out + (header.num_bits + j) * 32);
+            }
+        }
+        if (ret == 0) {
+            ret = transport_send_frame(t, reply);
+            done += header.num_bits;
+        }
+    }
+
+    if (ret == 0) {
+        ret = mta_compute_additive_share(ctx);
+    }
+
+    free(reply);
+    free(buf);
+
+    return ret;
+}
+
+int mta_party_run_receiver_pipelined(mta_context_t *ctx, transport_t *t,
+                                     uint64_t instance_id) {
+    if (!ctx || !t || ctx->role != MTA_ROLE_RECEIVER) {
+        LOG_ERROR("Invalid parameters in mta_party_run_receiver_pipelined");
+        return -1;
+    }
+
+    uint8_t *buf = malloc(MTA_PARTY_FRAME_LEN);
+    uint8_t *reply = malloc(MTA_PARTY_FRAME_LEN);
+    if (!buf || !reply) {
+        free(buf);
+        free(reply);
+        return -3;
+    }
+
+    // Bits below responded have been answered, bits below completed decrypted;
+    // each round must continue exactly where the previous frame stopped
+    int responded = 0, completed = 0;
+    int ret = 0;
+
+    while (ret == 0 && completed < MTA_NUM_BITS) {
+        wire_header_t header;
+        const uint8_t *in;
+        ret = transport_recv_frame(t, buf, MTA_PARTY_FRAME_LEN, &header, &in);
+        if (ret == 0 && (header.instance_id != instance_id || header.num_instances != 1)) {
+            LOG_ERROR("Frame for instance %llu in instance %llu",
+                      (unsigned long long)header.instance_id,
+                      (unsigned long long)instance_id);
+            ret = -4;
+        }
+        if (ret != 0) {
+            break;
+        }
+
+        if (header.type == WIRE_OT_SENDER_MSGS && header.first_bit == responded) {
+            const OT_SenderMessage *msgs = (const OT_SenderMessage *)in;
+            uint8_t *out;
+            ret = wire_frame_begin(reply, MTA_PARTY_FRAME_LEN, WIRE_OT_RECEIVER_MSGS,
+                                   instance_id, 1, header.first_bit, header.num_bits, &out);
+            for (int j = 0; ret == 0 && j < header.num_bits; j++) {
+                ret = mta_receiver_bit_response(ctx, responded + j, &msgs[j],
+                                                (OT_ReceiverMessage *)out + j);
+            }
+            if (ret == 0) {
+                ret = transport_send_frame(t, reply);
+                responded += header.num_bits;
+            }
+        } else if (header.type == WIRE_CIPHERTEXTS && header.first_bit == completed &&
+                   completed + header.num_bits <= responded) {
+            for (int j = 0; ret == 0 && j < header.num_bits; j++) {
+                ret = mta_receiver_bit_complete(ctx, completed + j, in + j * 32,
+                                                in + (header.num_bits + j) * 32);
+            }
+            completed += header.num_bits;
+        } else {
+            LOG_ERROR("Unexpected frame (type %d, bits %u+%u) after %d responses, %d completions",
+                      header.type, header.first_bit, header.num_bits, responded, completed);
+            ret = -4;
+        }
+    }
+
+    if (ret == 0) {
+        ret = mta_compute_additive_share(ctx);
+    }
+
+    memzero(buf, MTA_PARTY_FRAME_LEN);
+    free(buf);
+    free(reply);
+
+    return ret;
+}
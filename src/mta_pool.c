@@ -0,0 +1,140 @@
+/*
+  Implementation of the MtA session pool
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "mta_pool.h"
+#include "logger.h"
+#include "memzero.h"
+
+// Rounds len up to a multiple of MTA_POOL_ALIGN
+static size_t align_up(size_t len) {
+    return (len + MTA_POOL_ALIGN - 1) & ~(size_t)(MTA_POOL_ALIGN - 1);
+}
+
+mta_pool_t *mta_pool_create(size_t capacity) {
+    size_t stride = align_up(sizeof(mta_context_t));
+    if (capacity == 0 || capacity > (SIZE_MAX / 2) / stride) {
+        LOG_ERROR("Invalid parameters in mta_pool_create");
+        return NULL;
+    }
+
+    // Arena: the pool, the free stack and in_use flags, then the contexts
+    size_t header_len = align_up(sizeof(mta_pool_t));
+    size_t slots_len = align_up(capacity * sizeof(size_t) + capacity);
+    size_t total = header_len + slots_len + capacity * stride;
+
+    void *arena = NULL;
+    if (posix_memalign(&arena, MTA_POOL_ALIGN, total) != 0) {
+        LOG_ERROR("Failed to allocate a pool of %zu MtA sessions", capacity);
+        return NULL;
+    }
+    memset(arena, 0, total);
+
+    mta_pool_t *pool = (mta_pool_t *)arena;
+    if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+        free(arena);
+        return NULL;
+    }
+    pool->capacity = capacity;
+    pool->stride = stride;
+    pool->free_slots = (size_t *)((uint8_t *)arena + header_len);
+    pool->in_use = (uint8_t *)(pool->free_slots + capacity);
+    pool->contexts = (uint8_t *)arena + header_len + slots_len;
+
+    // The lowest contexts come out first
+    for (size_t i = 0; i < capacity; i++) {
+        pool->free_slots[i] = capacity - 1 - i;
+    }
+    pool->num_free = capacity;
+
+    return pool;
+}
+
+void mta_pool_destroy(mta_pool_t *pool) {
+    if (!pool) {
+        return;
+    }
+
+    for (size_t i = 0; i < pool->capacity; i++) {
+        if (pool->in_use[i]) {
+            mta_clear((mta_context_t *)(pool->contexts + i * pool->stride));
+        }
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    memzero(pool, sizeof(mta_pool_t));
+    free(pool);
+}
+
+mta_context_t *mta_session_acquire(mta_pool_t *pool, mta_role_t role, const bignum256 *share) {
+    if (!pool || !share) {
+        LOG_ERROR("Invalid parameters in mta_session_acquire");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->num_free == 0) {
+        pthread_mutex_unlock(&pool->lock);
+        LOG_DEBUG("MtA session pool exhausted (%zu sessions)", pool->capacity);
+        return NULL;
+    }
+    size_t slot = pool->free_slots[--pool->num_free];
+    pool->in_use[slot] = 1;
+    pthread_mutex_unlock(&pool->lock);
+
+    // Released contexts are all zero, initialization only writes fields
+    mta_context_t *ctx = (mta_context_t *)(pool->contexts + slot * pool->stride);
+    if (mta_init_wiped(ctx, role, share) != 0) {
+        mta_session_release(pool, ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+int mta_session_release(mta_pool_t *pool, mta_context_t *ctx) {
+    if (!pool || !ctx) {
+        LOG_ERROR("Invalid parameters in mta_session_release");
+        return -1;
+    }
+
+    // ctx must be the start of one of the pool's contexts
+    uint8_t *p = (uint8_t *)ctx;
+    if (p < pool->contexts || p >= pool->contexts + pool->capacity * pool->stride ||
+        (size_t)(p - pool->contexts) % pool->stride != 0) {
+        LOG_ERROR("MtA session does not belong to the pool");
+        return -1;
+    }
+    size_t slot = (size_t)(p - pool->contexts) / pool->stride;
+
+    pthread_mutex_lock(&pool->lock);
+    int open = pool->in_use[slot];
+    pool->in_use[slot] = 0;
+    pthread_mutex_unlock(&pool->lock);
+    if (!open) {
+        LOG_ERROR("MtA session %zu released twice", slot);
+        return -2;
+    }
+
+    // Wiped outside the lock, and only then handed out again
+    mta_clear(ctx);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->free_slots[pool->num_free++] = slot;
+    pthread_mutex_unlock(&pool->lock);
+
+    return 0;
+}
+
+size_t mta_pool_available(mta_pool_t *pool) {
+    if (!pool) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    size_t available = pool->num_free;
+    pthread_mutex_unlock(&pool->lock);
+
+    return available;
+}
@@ -0,0 +1,253 @@
+/*
+  Implementation of IKNP-style OT extension
+  The PRG and the correlation-robust hash H(index, row) are those of the
+  session's kdf backend
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ot_ext.h"
+#include "logger.h"
+#include "memzero.h"
+#include "rand.h"
+#include "kdf.h"
+
+// Rows processed per chunk; keeps the column buffers on the stack
+#define OT_EXT_CHUNK_ROWS 512
+#define OT_EXT_CHUNK_BYTES (OT_EXT_CHUNK_ROWS / 8)
+
+_Static_assert(OT_EXT_CHUNK_BYTES % KDF_BLOCK_LEN == 0,
+               "OT extension chunks must be whole PRG blocks");
+_Static_assert(OT_EXT_KAPPA_BYTES == KDF_CRH_INPUT_LEN,
+               "A matrix row must be one correlation-robust hash input");
+
+static inline int test_bit(const uint8_t *buf, size_t i) {
+    return (buf[i >> 3] >> (i & 7)) & 1;
+}
+
+// Expand len bytes of the column streams of count seeds into out[j],
+// starting at byte offset within the PRG blocks that begin at block_base
+static void prg_expand_columns(kdf_backend_t kdf, const uint8_t (*seeds)[OT_EXT_SEED_LEN],
+                               int count, uint64_t block_base, size_t offset,
+                               uint8_t (*out)[OT_EXT_CHUNK_BYTES], size_t len) {
+    // Chunks start on a block, and a row of out has room for the last partial one
+    kdf_prg(kdf, seeds, count, block_base + offset / KDF_BLOCK_LEN,
+            (len + KDF_BLOCK_LEN - 1) / KDF_BLOCK_LEN, out[0], OT_EXT_CHUNK_BYTES);
+}
+
+// Transpose rows [0, num_rows) of a KAPPA x chunk column block into rows
+static void transpose_chunk(uint8_t columns[OT_EXT_KAPPA][OT_EXT_CHUNK_BYTES],
+                            size_t num_rows,
+                            uint8_t rows[OT_EXT_CHUNK_ROWS][OT_EXT_KAPPA_BYTES]) {
+    memset(rows, 0, num_rows * OT_EXT_KAPPA_BYTES);
+
+    for (int j = 0; j < OT_EXT_KAPPA; j++) {
+        uint8_t mask = 1 << (j & 7);
+        for (size_t i = 0; i < num_rows; i++) {
+            if (test_bit(columns[j], i)) {
+                rows[i][j >> 3] |= mask;
+            }
+        }
+    }
+}
+
+int ot_ext_receiver_setup(ot_ext_receiver_t *rx, OT_SenderMessage *msgs) {
+    if (!rx || !msgs) {
+        LOG_ERROR("Invalid parameters in ot_ext_receiver_setup");
+        return -1;
+    }
+
+    memset(rx, 0, sizeof(ot_ext_receiver_t));
+    rx->kdf = kdf_get_backend();
+
+    // The base OT messages are never transferred, only the derived keys are used
+    int ret = base_ot_init_sender_batch(OT_EXT_KAPPA, msgs, rx->base_keys);
+    if (ret != 0) {
+        LOG_ERROR("Base OTs failed in ot_ext_receiver_setup");
+        ot_ext_receiver_clear(rx);
+        return ret;
+    }
+
+    return 0;
+}
+
+int ot_ext_sender_setup(ot_ext_sender_t *tx, const OT_SenderMessage *msgs,
+                        OT_ReceiverMessage *responses) {
+    if (!tx || !msgs || !responses) {
+        LOG_ERROR("Invalid parameters in ot_ext_sender_setup");
+        return -1;
+    }
+
+    memset(tx, 0, sizeof(ot_ext_sender_t));
+    tx->kdf = kdf_get_backend();
+
+    // Random choice string s, the global correlation of the extension
+    random_buffer(tx->s, sizeof(tx->s));
+
+    int choice_bits[OT_EXT_KAPPA];
+    for (int j = 0; j < OT_EXT_KAPPA; j++) {
+        choice_bits[j] = test_bit(tx->s, j);
+    }
+
+    int ret = base_ot_receiver_choice_batch(OT_EXT_KAPPA, msgs, choice_bits,
+                                            responses, tx->seeds);
+    memzero(choice_bits, sizeof(choice_bits));
+    if (ret != 0) {
+        LOG_ERROR("Base OTs failed in ot_ext_sender_setup");
+        ot_ext_sender_clear(tx);
+        return ret;
+    }
+
+    tx->ready = 1;
+    LOG_INFO("OT extension sender ready (%d base OTs)", OT_EXT_KAPPA);
+
+    return 0;
+}
+
+int ot_ext_receiver_setup_complete(ot_ext_receiver_t *rx,
+                                   const OT_ReceiverMessage *responses) {
+    if (!rx || !responses) {
+        LOG_ERROR("Invalid parameters in ot_ext_receiver_setup_complete");
+        return -1;
+    }
+
+    int ret = base_ot_sender_keys_batch(OT_EXT_KAPPA, rx->base_keys, responses,
+                                        rx->seeds0, rx->seeds1);
+    if (ret != 0) {
+        LOG_ERROR("Base OTs failed in ot_ext_receiver_setup_complete");
+        ot_ext_receiver_clear(rx);
+        return ret;
+    }
+
+    // The base OT private keys are not needed anymore
+    memzero(rx->base_keys, sizeof(rx->base_keys));
+
+    rx->ready = 1;
+    LOG_INFO("OT extension receiver ready (%d base OTs)", OT_EXT_KAPPA);
+
+    return 0;
+}
+
+int ot_ext_receiver_extend(ot_ext_receiver_t *rx, const uint8_t *choices,
+                           size_t num_ots, uint8_t *matrix,
+                           uint8_t (*keys)[OT_EXT_KEY_LEN]) {
+    if (!rx || !choices || !matrix || !keys || num_ots == 0 || !rx->ready) {
+        LOG_ERROR("Invalid parameters in ot_ext_receiver_extend");
+        return -1;
+    }
+
+    size_t column_len = OT_EXT_COLUMN_LEN(num_ots);
+    uint8_t t[OT_EXT_KAPPA][OT_EXT_CHUNK_BYTES];
+    uint8_t g1[OT_EXT_KAPPA][OT_EXT_CHUNK_BYTES];
+    uint8_t rows[OT_EXT_CHUNK_ROWS][OT_EXT_KAPPA_BYTES];
+
+    for (size_t offset = 0; offset < column_len; offset += OT_EXT_CHUNK_BYTES) {
+        size_t chunk_len = column_len - offset < OT_EXT_CHUNK_BYTES ?
+                           column_len - offset : OT_EXT_CHUNK_BYTES;
+        size_t first_row = offset * 8;
+        size_t chunk_rows = num_ots - first_row < OT_EXT_CHUNK_ROWS ?
+                            num_ots - first_row : OT_EXT_CHUNK_ROWS;
+
+        // Choice bits of this chunk, with the padding bits of the last byte cleared
+        uint8_t r[OT_EXT_CHUNK_BYTES];
+        memcpy(r, choices + offset, chunk_len);
+        if (chunk_rows % 8 != 0) {
+            r[chunk_len - 1] &= (1 << (chunk_rows % 8)) - 1;
+        }
+
+        // t_j = G(k0_j), u_j = t_j ^ G(k1_j) ^ r
+        prg_expand_columns(rx->kdf, (const uint8_t (*)[OT_EXT_SEED_LEN])rx->seeds0,
+                           OT_EXT_KAPPA, rx->prg_counter, offset, t, chunk_len);
+        prg_expand_columns(rx->kdf, (const uint8_t (*)[OT_EXT_SEED_LEN])rx->seeds1,
+                           OT_EXT_KAPPA, rx->prg_counter, offset, g1, chunk_len);
+        for (int j = 0; j < OT_EXT_KAPPA; j++) {
+            uint8_t *u = matrix + j * column_len + offset;
+
+            for (size_t b = 0; b < chunk_len; b++) {
+                u[b] = t[j][b] ^ g1[j][b] ^ r[b];
+            }
+        }
+
+        // Receiver's key for OT i is H(i, t_i) where t_i is row i of T
+        transpose_chunk(t, chunk_rows, rows);
+        kdf_crh_rows(rx->kdf, rx->ot_counter + first_row,
+                     (const uint8_t (*)[OT_EXT_KAPPA_BYTES])rows, chunk_rows, keys + first_row);
+
+        memzero(r, sizeof(r));
+    }
+
+    rx->prg_counter += (column_len + KDF_BLOCK_LEN - 1) / KDF_BLOCK_LEN;
+    rx->ot_counter += num_ots;
+
+    memzero(t, sizeof(t));
+    memzero(g1, sizeof(g1));
+    memzero(rows, sizeof(rows));
+
+    return 0;
+}
+
+int ot_ext_sender_extend(ot_ext_sender_t *tx, const uint8_t *matrix,
+                         size_t num_ots, uint8_t (*k0)[OT_EXT_KEY_LEN],
+                         uint8_t (*k1)[OT_EXT_KEY_LEN]) {
+    if (!tx || !matrix || !k0 || !k1 || num_ots == 0 || !tx->ready) {
+        LOG_ERROR("Invalid parameters in ot_ext_sender_extend");
+        return -1;
+    }
+
+    size_t column_len = OT_EXT_COLUMN_LEN(num_ots);
+    uint8_t q[OT_EXT_KAPPA][OT_EXT_CHUNK_BYTES];
+    uint8_t rows[OT_EXT_CHUNK_ROWS][OT_EXT_KAPPA_BYTES];
+
+    for (size_t offset = 0; offset < column_len; offset += OT_EXT_CHUNK_BYTES) {
+        size_t chunk_len = column_len - offset < OT_EXT_CHUNK_BYTES ?
+                           column_len - offset : OT_EXT_CHUNK_BYTES;
+        size_t first_row = offset * 8;
+        size_t chunk_rows = num_ots - first_row < OT_EXT_CHUNK_ROWS ?
+                            num_ots - first_row : OT_EXT_CHUNK_ROWS;
+
+        // q_j = G(k_{s_j}) ^ (s_j * u_j) = t_j ^ (s_j * r)
+        prg_expand_columns(tx->kdf, (const uint8_t (*)[OT_EXT_SEED_LEN])tx->seeds,
+                           OT_EXT_KAPPA, tx->prg_counter, offset, q, chunk_len);
+        for (int j = 0; j < OT_EXT_KAPPA; j++) {
+            const uint8_t *u = matrix + j * column_len + offset;
+
+            if (test_bit(tx->s, j)) {
+                for (size_t b = 0; b < chunk_len; b++) {
+                    q[j][b] ^= u[b];
+                }
+            }
+        }
+
+        // Row i of Q is t_i ^ (r_i * s): key0 = H(i, q_i), key1 = H(i, q_i ^ s)
+        transpose_chunk(q, chunk_rows, rows);
+        kdf_crh_rows(tx->kdf, tx->ot_counter + first_row,
+                     (const uint8_t (*)[OT_EXT_KAPPA_BYTES])rows, chunk_rows, k0 + first_row);
+        for (size_t i = 0; i < chunk_rows; i++) {
+            for (int b = 0; b < OT_EXT_KAPPA_BYTES; b++) {
+                rows[i][b] ^= tx->s[b];
+            }
+        }
+        kdf_crh_rows(tx->kdf, tx->ot_counter + first_row,
+                     (const uint8_t (*)[OT_EXT_KAPPA_BYTES])rows, chunk_rows, k1 + first_row);
+    }
+
+    tx->prg_counter += (column_len + KDF_BLOCK_LEN - 1) / KDF_BLOCK_LEN;
+    tx->ot_counter += num_ots;
+
+    memzero(q, sizeof(q));
+    memzero(rows, sizeof(rows));
+
+    return 0;
+}
+
+void ot_ext_sender_clear(ot_ext_sender_t *tx) {
+    if (tx) {
+        memzero(tx, sizeof(ot_ext_sender_t));
+    }
+}
+
+void ot_ext_receiver_clear(ot_ext_receiver_t *rx) {
+    if (rx) {
+        memzero(rx, sizeof(ot_ext_receiver_t));
+    }
+}
@@ -0,0 +1,62 @@
+/*
+  Implementation of the seeded PRG over the ChaCha20 DRBG
+ */
+#include <string.h>
+#include "prg.h"
+#include "memzero.h"
+#include "secp256k1.h"
+
+// chacha_drbg_generate serves less than 64 KB per call
+#define PRG_MAX_REQUEST 32768
+
+// Bytes drawn per scalar
+#define PRG_SCALAR_LEN 32
+
+// Scalars drawn per fill in prg_scalars
+#define PRG_SCALAR_CHUNK 64
+
+void prg_init(prg_t *prg, const uint8_t *seed, uint32_t stream) {
+    // The stream id is the DRBG nonce, under a fixed domain label
+    uint8_t nonce[8] = {'m', 't', 'a', 'p',
+                        (stream >> 24) & 0xff, (stream >> 16) & 0xff,
+                        (stream >> 8) & 0xff, stream & 0xff};
+
+    chacha_drbg_init(&prg->drbg, seed, PRG_SEED_LEN, nonce, sizeof(nonce));
+}
+
+void prg_fill(prg_t *prg, uint8_t *out, size_t len) {
+    while (len > 0) {
+        size_t take = len < PRG_MAX_REQUEST ? len : PRG_MAX_REQUEST;
+        chacha_drbg_generate(&prg->drbg, out, take);
+        out += take;
+        len -= take;
+    }
+}
+
+void prg_scalars(prg_t *prg, bignum256 *out, size_t count) {
+    uint8_t buffer[PRG_SCALAR_CHUNK * PRG_SCALAR_LEN];
+
+    for (size_t base = 0; base < count; base += PRG_SCALAR_CHUNK) {
+        size_t n = count - base < PRG_SCALAR_CHUNK ? count - base : PRG_SCALAR_CHUNK;
+        prg_fill(prg, buffer, n * PRG_SCALAR_LEN);
+
+        for (size_t i = 0; i < n; i++) {
+            bn_read_be(buffer + i * PRG_SCALAR_LEN, &out[base + i]);
+            bn_mod(&out[base + i], &secp256k1.order);
+        }
+    }
+
+    memzero(buffer, sizeof(buffer));
+}
+
+void prg_nonzero_scalar(prg_t *prg, bignum256 *out) {
+    do {
+        prg_scalars(prg, out, 1);
+    } while (bn_is_zero(out));
+}
+
+void prg_clear(prg_t *prg) {
+    if (prg) {
+        memzero(prg, sizeof(prg_t));
+    }
+}
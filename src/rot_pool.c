@@ -0,0 +1,229 @@
+/*
+  Implementation of the random OT pools
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "rot_pool.h"
+#include "logger.h"
+#include "memzero.h"
+#include "rand.h"
+
+static inline int test_bit(const uint8_t *buf, size_t i) {
+    return (buf[i >> 3] >> (i & 7)) & 1;
+}
+
+// Moves the unused OTs of a pool to its start when count more do not fit
+// after them; 0 if they do not fit at all
+static int make_room(size_t capacity, size_t *head, size_t *tail, size_t count,
+                     uint8_t *arrays[], const size_t entry_len[], int num_arrays) {
+    if (count > capacity - (*tail - *head)) {
+        return 0;
+    }
+    if (count <= capacity - *tail) {
+        return 1;
+    }
+
+    size_t used = *tail - *head;
+    for (int a = 0; a < num_arrays; a++) {
+        memmove(arrays[a], arrays[a] + *head * entry_len[a], used * entry_len[a]);
+        memzero(arrays[a] + used * entry_len[a], (*tail - used) * entry_len[a]);
+    }
+    *head = 0;
+    *tail = used;
+
+    return 1;
+}
+
+int rot_receiver_pool_init(rot_receiver_pool_t *pool, size_t capacity) {
+    if (!pool || capacity == 0 || capacity > SIZE_MAX / (OT_EXT_KEY_LEN + 1)) {
+        LOG_ERROR("Invalid parameters in rot_receiver_pool_init");
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(rot_receiver_pool_t));
+
+    // One allocation holds the keys, then the choice bits
+    uint8_t *memory = calloc(capacity, OT_EXT_KEY_LEN + 1);
+    if (!memory) {
+        LOG_ERROR("Failed to allocate a pool of %zu random OTs", capacity);
+        return -2;
+    }
+
+    pool->capacity = capacity;
+    pool->keys = (uint8_t (*)[OT_EXT_KEY_LEN])memory;
+    pool->choices = memory + capacity * OT_EXT_KEY_LEN;
+
+    return 0;
+}
+
+int rot_sender_pool_init(rot_sender_pool_t *pool, size_t capacity) {
+    if (!pool || capacity == 0 || capacity > SIZE_MAX / (2 * OT_EXT_KEY_LEN)) {
+        LOG_ERROR("Invalid parameters in rot_sender_pool_init");
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(rot_sender_pool_t));
+
+    uint8_t *memory = calloc(capacity, 2 * OT_EXT_KEY_LEN);
+    if (!memory) {
+        LOG_ERROR("Failed to allocate a pool of %zu random OTs", capacity);
+        return -2;
+    }
+
+    pool->capacity = capacity;
+    pool->keys0 = (uint8_t (*)[OT_EXT_KEY_LEN])memory;
+    pool->keys1 = pool->keys0 + capacity;
+
+    return 0;
+}
+
+int rot_receiver_pool_fill(rot_receiver_pool_t *pool, ot_ext_receiver_t *ot,
+                           size_t count, uint8_t *matrix) {
+    if (!pool || !pool->keys || !ot || !matrix || count == 0) {
+        LOG_ERROR("Invalid parameters in rot_receiver_pool_fill");
+        return -1;
+    }
+
+    uint8_t *arrays[2] = { (uint8_t *)pool->keys, pool->choices };
+    const size_t entry_len[2] = { OT_EXT_KEY_LEN, 1 };
+    if (!make_room(pool->capacity, &pool->head, &pool->tail, count, arrays, entry_len, 2)) {
+        LOG_ERROR("No room for %zu random OTs in the pool", count);
+        return -1;
+    }
+
+    uint8_t *choices = malloc(OT_EXT_COLUMN_LEN(count));
+    if (!choices) {
+        return -2;
+    }
+    random_buffer(choices, OT_EXT_COLUMN_LEN(count));
+
+    int ret = ot_ext_receiver_extend(ot, choices, count, matrix, pool->keys + pool->tail);
+    if (ret == 0) {
+        for (size_t i = 0; i < count; i++) {
+            pool->choices[pool->tail + i] = test_bit(choices, i);
+        }
+        pool->tail += count;
+        LOG_DEBUG("Bob pooled %zu random OTs (%zu available)", count, pool->tail - pool->head);
+    }
+
+    memzero(choices, OT_EXT_COLUMN_LEN(count));
+    free(choices);
+    return ret;
+}
+
+int rot_sender_pool_fill(rot_sender_pool_t *pool, ot_ext_sender_t *ot,
+                         const uint8_t *matrix, size_t count) {
+    if (!pool || !pool->keys0 || !ot || !matrix || count == 0) {
+        LOG_ERROR("Invalid parameters in rot_sender_pool_fill");
+        return -1;
+    }
+
+    uint8_t *arrays[2] = { (uint8_t *)pool->keys0, (uint8_t *)pool->keys1 };
+    const size_t entry_len[2] = { OT_EXT_KEY_LEN, OT_EXT_KEY_LEN };
+    if (!make_room(pool->capacity, &pool->head, &pool->tail, count, arrays, entry_len, 2)) {
+        LOG_ERROR("No room for %zu random OTs in the pool", count);
+        return -1;
+    }
+
+    int ret = ot_ext_sender_extend(ot, matrix, count, pool->keys0 + pool->tail,
+                                   pool->keys1 + pool->tail);
+    if (ret == 0) {
+        pool->tail += count;
+        LOG_DEBUG("Alice pooled %zu random OTs (%zu available)", count, pool->tail - pool->head);
+    }
+
+    return ret;
+}
+
+size_t rot_receiver_pool_available(const rot_receiver_pool_t *pool) {
+    return pool ? pool->tail - pool->head : 0;
+}
+
+size_t rot_sender_pool_available(const rot_sender_pool_t *pool) {
+    return pool ? pool->tail - pool->head : 0;
+}
+
+int rot_receiver_pool_derandomize(rot_receiver_pool_t *pool, const uint8_t *choices,
+                                  size_t count, uint64_t *first_index, uint8_t *flips,
+                                  uint8_t (*keys)[OT_EXT_KEY_LEN]) {
+    if (!pool || !choices || !first_index || !flips || !keys || count == 0) {
+        LOG_ERROR("Invalid parameters in rot_receiver_pool_derandomize");
+        return -1;
+    }
+    if (count > pool->tail - pool->head) {
+        LOG_ERROR("Only %zu random OTs pooled, %zu needed", pool->tail - pool->head, count);
+        return -2;
+    }
+
+    // e = c ^ r; k_r is the key of choice c once the sender swaps by e
+    memset(flips, 0, OT_EXT_COLUMN_LEN(count));
+    for (size_t i = 0; i < count; i++) {
+        uint8_t e = (uint8_t)(test_bit(choices, i) ^ pool->choices[pool->head + i]);
+        flips[i >> 3] |= (uint8_t)(e << (i & 7));
+    }
+    memcpy(keys, pool->keys + pool->head, count * OT_EXT_KEY_LEN);
+
+    memzero(pool->keys + pool->head, count * OT_EXT_KEY_LEN);
+    memzero(pool->choices + pool->head, count);
+    *first_index = pool->next_index;
+    pool->head += count;
+    pool->next_index += count;
+
+    return 0;
+}
+
+int rot_sender_pool_derandomize(rot_sender_pool_t *pool, uint64_t first_index,
+                                const uint8_t *flips, size_t count,
+                                uint8_t (*k0)[OT_EXT_KEY_LEN],
+                                uint8_t (*k1)[OT_EXT_KEY_LEN]) {
+    if (!pool || !flips || !k0 || !k1 || count == 0) {
+        LOG_ERROR("Invalid parameters in rot_sender_pool_derandomize");
+        return -1;
+    }
+    if (first_index != pool->next_index) {
+        LOG_ERROR("Random OT pools out of step: receiver at %llu, sender at %llu",
+                  (unsigned long long)first_index, (unsigned long long)pool->next_index);
+        return -3;
+    }
+    if (count > pool->tail - pool->head) {
+        LOG_ERROR("Only %zu random OTs pooled, %zu needed", pool->tail - pool->head, count);
+        return -2;
+    }
+
+    // The flips are public, the keys are swapped where e = 1
+    for (size_t i = 0; i < count; i++) {
+        size_t j = pool->head + i;
+        int e = test_bit(flips, i);
+        memcpy(k0[i], e ? pool->keys1[j] : pool->keys0[j], OT_EXT_KEY_LEN);
+        memcpy(k1[i], e ? pool->keys0[j] : pool->keys1[j], OT_EXT_KEY_LEN);
+    }
+
+    memzero(pool->keys0 + pool->head, count * OT_EXT_KEY_LEN);
+    memzero(pool->keys1 + pool->head, count * OT_EXT_KEY_LEN);
+    pool->head += count;
+    pool->next_index += count;
+
+    return 0;
+}
+
+void rot_receiver_pool_free(rot_receiver_pool_t *pool) {
+    if (!pool) {
+        return;
+    }
+    if (pool->keys) {
+        memzero(pool->keys, pool->capacity * (OT_EXT_KEY_LEN + 1));
+        free(pool->keys);
+    }
+    memzero(pool, sizeof(rot_receiver_pool_t));
+}
+
+void rot_sender_pool_free(rot_sender_pool_t *pool) {
+    if (!pool) {
+        return;
+    }
+    if (pool->keys0) {
+        memzero(pool->keys0, pool->capacity * 2 * OT_EXT_KEY_LEN);
+        free(pool->keys0);
+    }
+    memzero(pool, sizeof(rot_sender_pool_t));
+}
@@ -0,0 +1,159 @@
+/*
+  Implementation of the worker pool
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "thread_pool.h"
+#include "logger.h"
+
+// Hands out shards of the current job until none are left.
+// Called with the lock held, returns with the lock held.
+static void run_shards(thread_pool_t *pool) {
+    while (pool->next_shard < pool->num_shards) {
+        size_t shard = pool->next_shard++;
+        size_t begin = shard * pool->count / pool->num_shards;
+        size_t end = (shard + 1) * pool->count / pool->num_shards;
+        thread_pool_fn fn = pool->fn;
+        void *arg = pool->arg;
+
+        pthread_mutex_unlock(&pool->lock);
+        int ret = fn(arg, begin, end);
+        pthread_mutex_lock(&pool->lock);
+
+        if (ret != 0 && shard < pool->failed_shard) {
+            pool->failed_shard = shard;
+            pool->result = ret;
+        }
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->work_done);
+        }
+    }
+}
+
+static void *worker_main(void *arg) {
+    thread_pool_t *pool = (thread_pool_t *)arg;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->generation;
+        run_shards(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+int thread_pool_init(thread_pool_t *pool, int num_threads) {
+    if (!pool || num_threads < 1 || num_threads > THREAD_POOL_MAX_THREADS) {
+        LOG_ERROR("Invalid parameters in thread_pool_init");
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(thread_pool_t));
+    pool->num_threads = num_threads;
+
+    if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+        return -2;
+    }
+    if (pthread_cond_init(&pool->work_ready, NULL) != 0) {
+        pthread_mutex_destroy(&pool->lock);
+        return -2;
+    }
+    if (pthread_cond_init(&pool->work_done, NULL) != 0) {
+        pthread_cond_destroy(&pool->work_ready);
+        pthread_mutex_destroy(&pool->lock);
+        return -2;
+    }
+
+    if (num_threads > 1) {
+        pool->workers = calloc(num_threads - 1, sizeof(pthread_t));
+        if (!pool->workers) {
+            LOG_ERROR("Failed to allocate %d worker threads", num_threads - 1);
+            thread_pool_free(pool);
+            return -3;
+        }
+
+        for (int i = 0; i < num_threads - 1; i++) {
+            if (pthread_create(&pool->workers[i], NULL, worker_main, pool) != 0) {
+                LOG_ERROR("Failed to start worker thread %d", i);
+                // Only the threads started so far are joined
+                pool->num_threads = i + 1;
+                thread_pool_free(pool);
+                return -4;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int thread_pool_run(thread_pool_t *pool, size_t count, thread_pool_fn fn, void *arg) {
+    if (!pool || !fn) {
+        LOG_ERROR("Invalid parameters in thread_pool_run");
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    // Nothing to share: run inline without touching the lock
+    size_t num_shards = (size_t)pool->num_threads < count ? (size_t)pool->num_threads : count;
+    if (num_shards == 1) {
+        return fn(arg, 0, count);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->count = count;
+    pool->num_shards = num_shards;
+    pool->next_shard = 0;
+    pool->pending = num_shards;
+    pool->failed_shard = num_shards;
+    pool->result = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+
+    run_shards(pool);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    int result = pool->result;
+
+    pool->fn = NULL;
+    pool->arg = NULL;
+    pthread_mutex_unlock(&pool->lock);
+
+    return result;
+}
+
+void thread_pool_free(thread_pool_t *pool) {
+    if (!pool || pool->num_threads == 0) {
+        return;
+    }
+
+    if (pool->workers) {
+        pthread_mutex_lock(&pool->lock);
+        pool->shutdown = 1;
+        pthread_cond_broadcast(&pool->work_ready);
+        pthread_mutex_unlock(&pool->lock);
+
+        for (int i = 0; i < pool->num_threads - 1; i++) {
+            pthread_join(pool->workers[i], NULL);
+        }
+        free(pool->workers);
+    }
+
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    memset(pool, 0, sizeof(thread_pool_t));
+}
@@ -0,0 +1,394 @@
+/*
+  Implementation of the loopback and socket transports
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "transport.h"
+#include "logger.h"
+
+// One direction of a loopback connection
+typedef struct {
+    uint8_t data[TRANSPORT_LOOPBACK_CAPACITY];
+    size_t head;                        // Next byte to read
+    size_t len;                         // Bytes buffered
+} loopback_queue_t;
+
+// State shared by both loopback endpoints
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;             // Signalled on every read, write and close
+    loopback_queue_t queues[2];         // queues[i] is written by endpoint i
+    int closed[2];
+} loopback_shared_t;
+
+typedef struct {
+    loopback_shared_t *shared;
+    int side;
+} loopback_endpoint_t;
+
+static int loopback_send(void *state, const uint8_t *buf, size_t len) {
+    loopback_endpoint_t *ep = (loopback_endpoint_t *)state;
+    loopback_shared_t *shared = ep->shared;
+    loopback_queue_t *q = &shared->queues[ep->side];
+    int ret = 0;
+
+    pthread_mutex_lock(&shared->lock);
+    while (len > 0) {
+        while (q->len == TRANSPORT_LOOPBACK_CAPACITY && !shared->closed[1 - ep->side]) {
+            pthread_cond_wait(&shared->changed, &shared->lock);
+        }
+        if (shared->closed[1 - ep->side]) {
+            ret = -2;
+            break;
+        }
+
+        // Copy up to the free space, wrapping around the end of the ring
+        size_t tail = (q->head + q->len) % TRANSPORT_LOOPBACK_CAPACITY;
+        size_t take = TRANSPORT_LOOPBACK_CAPACITY - q->len;
+        if (take > TRANSPORT_LOOPBACK_CAPACITY - tail) {
+            take = TRANSPORT_LOOPBACK_CAPACITY - tail;
+        }
+        if (take > len) {
+            take = len;
+        }
+        memcpy(q->data + tail, buf, take);
+        q->len += take;
+        buf += take;
+        len -= take;
+        pthread_cond_broadcast(&shared->changed);
+    }
+    pthread_mutex_unlock(&shared->lock);
+
+    return ret;
+}
+
+static int loopback_recv(void *state, uint8_t *buf, size_t len) {
+    loopback_endpoint_t *ep = (loopback_endpoint_t *)state;
+    loopback_shared_t *shared = ep->shared;
+    loopback_queue_t *q = &shared->queues[1 - ep->side];
+    int ret = 0;
+
+    pthread_mutex_lock(&shared->lock);
+    while (len > 0) {
+        while (q->len == 0 && !shared->closed[1 - ep->side]) {
+            pthread_cond_wait(&shared->changed, &shared->lock);
+        }
+        if (q->len == 0) {
+            ret = -2;
+            break;
+        }
+
+        size_t take = q->len;
+        if (take > TRANSPORT_LOOPBACK_CAPACITY - q->head) {
+            take = TRANSPORT_LOOPBACK_CAPACITY - q->head;
+        }
+        if (take > len) {
+            take = len;
+        }
+        memcpy(buf, q->data + q->head, take);
+        q->head = (q->head + take) % TRANSPORT_LOOPBACK_CAPACITY;
+        q->len -= take;
+        buf += take;
+        len -= take;
+        pthread_cond_broadcast(&shared->changed);
+    }
+    pthread_mutex_unlock(&shared->lock);
+
+    return ret;
+}
+
+static void loopback_close(void *state) {
+    loopback_endpoint_t *ep = (loopback_endpoint_t *)state;
+    loopback_shared_t *shared = ep->shared;
+
+    pthread_mutex_lock(&shared->lock);
+    shared->closed[ep->side] = 1;
+    int last = shared->closed[1 - ep->side];
+    pthread_cond_broadcast(&shared->changed);
+    pthread_mutex_unlock(&shared->lock);
+
+    // The second endpoint to close releases the shared state
+    if (last) {
+        pthread_cond_destroy(&shared->changed);
+        pthread_mutex_destroy(&shared->lock);
+        free(shared);
+    }
+    free(ep);
+}
+
+int transport_loopback_pair(transport_t *a, transport_t *b) {
+    if (!a || !b) {
+        LOG_ERROR("Invalid parameters in transport_loopback_pair");
+        return -1;
+    }
+
+    loopback_shared_t *shared = calloc(1, sizeof(loopback_shared_t));
+    loopback_endpoint_t *ep_a = calloc(1, sizeof(loopback_endpoint_t));
+    loopback_endpoint_t *ep_b = calloc(1, sizeof(loopback_endpoint_t));
+    if (!shared || !ep_a || !ep_b) {
+        LOG_ERROR("Failed to allocate a loopback transport");
+        free(shared);
+        free(ep_a);
+        free(ep_b);
+        return -3;
+    }
+
+    pthread_mutex_init(&shared->lock, NULL);
+    pthread_cond_init(&shared->changed, NULL);
+    ep_a->shared = shared;
+    ep_a->side = 0;
+    ep_b->shared = shared;
+    ep_b->side = 1;
+
+    memset(a, 0, sizeof(transport_t));
+    memset(b, 0, sizeof(transport_t));
+    a->send = b->send = loopback_send;
+    a->recv = b->recv = loopback_recv;
+    a->close = b->close = loopback_close;
+    a->state = ep_a;
+    b->state = ep_b;
+
+    return 0;
+}
+
+// Socket state is the descriptor itself
+typedef struct {
+    int fd;
+} socket_endpoint_t;
+
+static int socket_send(void *state, const uint8_t *buf, size_t len) {
+    int fd = ((socket_endpoint_t *)state)->fd;
+
+    while (len > 0) {
+        // No SIGPIPE if the peer is gone, the error is returned instead
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Socket send failed: %s", strerror(errno));
+            return -2;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int socket_recv(void *state, uint8_t *buf, size_t len) {
+    int fd = ((socket_endpoint_t *)state)->fd;
+
+    while (len > 0) {
+        ssize_t n = recv(fd, buf, len, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Socket recv failed: %s", strerror(errno));
+            return -2;
+        }
+        if (n == 0) {
+            return -2;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static void socket_close(void *state) {
+    socket_endpoint_t *ep = (socket_endpoint_t *)state;
+    close(ep->fd);
+    free(ep);
+}
+
+int transport_fd(transport_t *t, int fd) {
+    if (!t || fd < 0) {
+        LOG_ERROR("Invalid parameters in transport_fd");
+        return -1;
+    }
+
+    socket_endpoint_t *ep = malloc(sizeof(socket_endpoint_t));
+    if (!ep) {
+        LOG_ERROR("Failed to allocate a socket transport");
+        return -3;
+    }
+    ep->fd = fd;
+
+    memset(t, 0, sizeof(transport_t));
+    t->send = socket_send;
+    t->recv = socket_recv;
+    t->close = socket_close;
+    t->state = ep;
+
+    return 0;
+}
+
+// Wraps two connected sockets, closing both on failure
+static int fd_pair(transport_t *a, transport_t *b, int fd_a, int fd_b) {
+    if (transport_fd(a, fd_a) != 0) {
+        close(fd_a);
+        close(fd_b);
+        return -3;
+    }
+    if (transport_fd(b, fd_b) != 0) {
+        transport_close(a);
+        close(fd_b);
+        return -3;
+    }
+    return 0;
+}
+
+int transport_socketpair(transport_t *a, transport_t *b) {
+    if (!a || !b) {
+        LOG_ERROR("Invalid parameters in transport_socketpair");
+        return -1;
+    }
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        LOG_ERROR("socketpair failed: %s", strerror(errno));
+        return -2;
+    }
+
+    return fd_pair(a, b, fds[0], fds[1]);
+}
+
+int transport_tcp_pair(transport_t *a, transport_t *b) {
+    if (!a || !b) {
+        LOG_ERROR("Invalid parameters in transport_tcp_pair");
+        return -1;
+    }
+
+    // Listen on an ephemeral port of 127.0.0.1, connect to it and accept
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        LOG_ERROR("socket failed: %s", strerror(errno));
+        return -2;
+    }
+    if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listener, 1) != 0 ||
+        getsockname(listener, (struct sockaddr *)&addr, &addr_len) != 0) {
+        LOG_ERROR("Failed to listen on 127.0.0.1: %s", strerror(errno));
+        close(listener);
+        return -2;
+    }
+
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    if (client < 0 || connect(client, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        LOG_ERROR("Failed to connect to 127.0.0.1:%d: %s", ntohs(addr.sin_port),
+                  strerror(errno));
+        if (client >= 0) {
+            close(client);
+        }
+        close(listener);
+        return -2;
+    }
+
+    int server = accept(listener, NULL, NULL);
+    close(listener);
+    if (server < 0) {
+        LOG_ERROR("accept failed: %s", strerror(errno));
+        close(client);
+        return -2;
+    }
+
+    // Rounds are single writes waited on by the peer, do not hold them back
+    int one = 1;
+    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    return fd_pair(a, b, client, server);
+}
+
+int transport_send(transport_t *t, const uint8_t *buf, size_t len) {
+    if (!t || !t->send || (!buf && len > 0)) {
+        LOG_ERROR("Invalid parameters in transport_send");
+        return -1;
+    }
+
+    int ret = t->send(t->state, buf, len);
+    if (ret == 0) {
+        t->bytes_sent += len;
+    }
+    return ret;
+}
+
+int transport_recv(transport_t *t, uint8_t *buf, size_t len) {
+    if (!t || !t->recv || (!buf && len > 0)) {
+        LOG_ERROR("Invalid parameters in transport_recv");
+        return -1;
+    }
+
+    int ret = t->recv(t->state, buf, len);
+    if (ret == 0) {
+        t->bytes_received += len;
+    }
+    return ret;
+}
+
+int transport_send_frame(transport_t *t, const uint8_t *frame) {
+    wire_header_t header;
+    const uint8_t *payload;
+
+    // The header alone gives the length of the frame
+    if (!frame || wire_frame_parse(frame, WIRE_HEADER_LEN, &header, &payload) != -2) {
+        LOG_ERROR("Invalid frame in transport_send_frame");
+        return -1;
+    }
+
+    return transport_send(t, frame, WIRE_HEADER_LEN + (size_t)header.payload_len);
+}
+
+int transport_recv_frame(transport_t *t, uint8_t *buf, size_t buf_len,
+                         wire_header_t *header, const uint8_t **payload) {
+    if (!buf || buf_len < WIRE_HEADER_LEN || !header || !payload) {
+        LOG_ERROR("Invalid parameters in transport_recv_frame");
+        return -1;
+    }
+
+    int ret = transport_recv(t, buf, WIRE_HEADER_LEN);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // A well-formed header reports the payload as missing
+    ret = wire_frame_parse(buf, WIRE_HEADER_LEN, header, payload);
+    if (ret != -2) {
+        return ret == 0 ? -3 : ret;
+    }
+    if (buf_len - WIRE_HEADER_LEN < header->payload_len) {
+        LOG_ERROR("Frame of %u bytes does not fit the receive buffer", header->payload_len);
+        return -3;
+    }
+
+    ret = transport_recv(t, buf + WIRE_HEADER_LEN, header->payload_len);
+    if (ret != 0) {
+        return ret;
+    }
+
+    return wire_frame_parse(buf, WIRE_HEADER_LEN + (size_t)header->payload_len,
+                            header, payload);
+}
+
+void transport_close(transport_t *t) {
+    if (t && t->close) {
+        t->close(t->state);
+        memset(t, 0, sizeof(transport_t));
+    }
+}
@@ -1,5 +1,7 @@
 // utils.c
 #include "utils.h"
+#include "kdf.h"
+#include "memzero.h"
 #include "rand.h"
 
 void generate_random_nonzero_scalar(bignum256 *scalar) {
@@ -30,19 +32,83 @@ void derive_key_from_point(const curve_point *point, uint8_t *key) {
     bn_write_be(&point->x, point_bytes + 1);
     bn_write_be(&point->y, point_bytes + 33);
     
-    // Hash the point using SHA-256
-    sha256_Raw(point_bytes, sizeof(point_bytes), key);
+    // Hash the point with the current kdf backend
+    kdf_hash(kdf_get_backend(), point_bytes, sizeof(point_bytes), key);
+}
+
+void derive_keys_from_points(const curve_point *points, size_t count, uint8_t (*keys)[32]) {
+    uint8_t point_bytes[8][65];
+    const uint8_t *inputs[8];
+    
+    size_t base = 0;
+    
+    for (; base + 8 <= count; base += 8) {
+        // Uncompressed encodings, as in derive_key_from_point
+        for (size_t i = 0; i < 8; i++) {
+            point_bytes[i][0] = 0x04;
+            bn_write_be(&points[base + i].x, point_bytes[i] + 1);
+            bn_write_be(&points[base + i].y, point_bytes[i] + 33);
+            inputs[i] = point_bytes[i];
+        }
+        kdf_hash_batch(kdf_get_backend(), 8, inputs, sizeof(point_bytes[0]), keys + base);
+    }
+    for (; base < count; base++) {
+        derive_key_from_point(&points[base], keys[base]);
+    }
+    
+    memzero(point_bytes, sizeof(point_bytes));
 }
 
 void sha256_xor_crypt(uint8_t *data, const uint8_t *key, size_t data_len) {
-    // Generate keystream using SHA-256
-    uint8_t keystream[32];
-    sha256_Raw(key, 32, keystream);
+    // Keystream block j is SHA-256(key || j), j as a 64-bit big-endian counter
+    uint8_t input[32 + 8];
+    uint8_t keystream[SHA256_DIGEST_LENGTH];
+    uint64_t counter = 0;
     
-    // XOR with keystream
-    for (size_t i = 0; i < data_len; i++) {
-        data[i] ^= keystream[i % 32];
+    // Whole groups of 8 blocks are hashed together
+    if (data_len >= 8 * SHA256_DIGEST_LENGTH) {
+        uint8_t inputs[8][32 + 8];
+        uint8_t streams[8][SHA256_DIGEST_LENGTH];
+        const uint8_t *ptrs[8];
+        
+        for (int i = 0; i < 8; i++) {
+            memcpy(inputs[i], key, 32);
+            ptrs[i] = inputs[i];
+        }
+        for (; data_len >= 8 * SHA256_DIGEST_LENGTH; counter += 8) {
+            for (int i = 0; i < 8; i++) {
+                for (int k = 0; k < 8; k++) {
+                    inputs[i][32 + k] = ((counter + i) >> (56 - 8 * k)) & 0xff;
+                }
+            }
+            sha256_Raw_x8(ptrs, sizeof(inputs[0]), streams);
+            xor_buffers(data, data, streams[0], sizeof(streams));
+            
+            data += sizeof(streams);
+            data_len -= sizeof(streams);
+        }
+        
+        memzero(streams, sizeof(streams));
+        memzero(inputs, sizeof(inputs));
     }
+    
+    memcpy(input, key, 32);
+    
+    for (; data_len > 0; counter++) {
+        for (int i = 0; i < 8; i++) {
+            input[32 + i] = (counter >> (56 - 8 * i)) & 0xff;
+        }
+        sha256_Raw(input, sizeof(input), keystream);
+        
+        size_t take = data_len < SHA256_DIGEST_LENGTH ? data_len : SHA256_DIGEST_LENGTH;
+        xor_buffers(data, data, keystream, take);
+        
+        data += take;
+        data_len -= take;
+    }
+    
+    memzero(keystream, sizeof(keystream));
+    memzero(input, sizeof(input));
 }
 
 void xor_buffers(uint8_t *result, const uint8_t *a, const uint8_t *b, size_t len) {
@@ -70,4 +136,45 @@ int get_bit(const bignum256 *num, int bit_index) {
 void pow2_bignum(int i, bignum256 *result) {
     bn_zero(result);
     bn_setbit(result, i);
-}
\ No newline at end of file
+}
+
+void scalar_acc_init(scalar_acc_t *acc) {
+    memset(acc, 0, sizeof(scalar_acc_t));
+}
+
+void scalar_acc_add(scalar_acc_t *acc, const bignum256 *x) {
+    // Fold the sum back into one scalar long before a limb can overflow
+    if (acc->count == SCALAR_ACC_MAX_ADDS) {
+        bignum256 sum;
+        scalar_acc_get(acc, &sum);
+        scalar_acc_init(acc);
+        scalar_acc_add(acc, &sum);
+        memzero(&sum, sizeof(sum));
+    }
+    
+    for (int i = 0; i < BN_LIMBS; i++) {
+        acc->val[i] += x->val[i];
+    }
+    acc->count++;
+}
+
+void scalar_acc_get(const scalar_acc_t *acc, bignum256 *result) {
+    // Carry the limbs into a normalized 512-bit value, which stays far
+    // below the 2^519 that bn_reduce accepts
+    bignum512 wide = {0};
+    uint64_t carry = 0;
+    
+    for (int i = 0; i < 2 * BN_LIMBS; i++) {
+        if (i < BN_LIMBS) {
+            carry += acc->val[i];
+        }
+        wide.val[i] = carry & BN_LIMB_MASK;
+        carry >>= BN_BITS_PER_LIMB;
+    }
+    
+    bn_reduce(&wide, &secp256k1.order);
+    bn_copy_lower(&wide, result);
+    bn_mod(result, &secp256k1.order);
+    
+    memzero(&wide, sizeof(wide));
+}
@@ -0,0 +1,262 @@
+/*
+  Implementation of the round wire format
+ */
+#include <stdio.h>
+#include <string.h>
+#include "wire.h"
+#include "logger.h"
+
+// Messages are used in place, so they must be plain byte arrays
+_Static_assert(sizeof(OT_SenderMessage) == 33 && sizeof(OT_ReceiverMessage) == 33,
+               "OT messages must be packed 33-byte points");
+
+static void wire_put_be(uint8_t *out, uint64_t v, int len) {
+    for (int i = len - 1; i >= 0; i--) {
+        out[i] = v & 0xff;
+        v >>= 8;
+    }
+}
+
+static uint64_t wire_get_be(const uint8_t *in, int len) {
+    uint64_t v = 0;
+    for (int i = 0; i < len; i++) {
+        v = (v << 8) | in[i];
+    }
+    return v;
+}
+
+// Bytes of one bit of one instance, 0 for the types sized per instance
+static size_t element_len(wire_type_t type) {
+    switch (type) {
+    case WIRE_OT_SENDER_MSGS:
+        return sizeof(OT_SenderMessage);
+    case WIRE_OT_RECEIVER_MSGS:
+        return sizeof(OT_ReceiverMessage);
+    case WIRE_CIPHERTEXTS:
+        return 2 * 32;
+    case WIRE_EXT_CORRECTIONS:
+        return 32;
+    default:
+        return 0;
+    }
+}
+
+size_t wire_payload_len(wire_type_t type, uint32_t num_instances, uint16_t num_bits) {
+    uint64_t per_instance;
+
+    if (type == WIRE_EXT_MATRIX) {
+        per_instance = OT_EXT_MATRIX_LEN((uint64_t)num_bits);
+    } else {
+        per_instance = (uint64_t)element_len(type) * num_bits;
+    }
+
+    // The length field of the header is 32 bits
+    uint64_t len = per_instance * num_instances;
+    if (per_instance == 0 || len > UINT32_MAX) {
+        return 0;
+    }
+    return (size_t)len;
+}
+
+size_t wire_frame_len(wire_type_t type, uint32_t num_instances, uint16_t num_bits) {
+    size_t payload_len = wire_payload_len(type, num_instances, num_bits);
+    return payload_len ? WIRE_HEADER_LEN + payload_len : 0;
+}
+
+int wire_frame_begin(uint8_t *buf, size_t buf_len, wire_type_t type,
+                     uint64_t instance_id, uint32_t num_instances,
+                     uint16_t first_bit, uint16_t num_bits, uint8_t **payload) {
+    size_t payload_len = wire_payload_len(type, num_instances, num_bits);
+    if (!buf || !payload || payload_len == 0 ||
+        (uint32_t)first_bit + num_bits > MTA_NUM_BITS) {
+        LOG_ERROR("Invalid parameters in wire_frame_begin");
+        return -1;
+    }
+    if (buf_len < WIRE_HEADER_LEN + payload_len) {
+        LOG_ERROR("Buffer of %zu bytes too small for a %zu-byte frame",
+                  buf_len, WIRE_HEADER_LEN + payload_len);
+        return -2;
+    }
+
+    wire_put_be(buf, WIRE_MAGIC, 2);
+    buf[2] = WIRE_VERSION;
+    buf[3] = (uint8_t)type;
+    wire_put_be(buf + 4, instance_id, 8);
+    wire_put_be(buf + 12, num_instances, 4);
+    wire_put_be(buf + 16, first_bit, 2);
+    wire_put_be(buf + 18, num_bits, 2);
+    wire_put_be(buf + 20, payload_len, 4);
+
+    *payload = buf + WIRE_HEADER_LEN;
+    return 0;
+}
+
+int wire_frame_parse(const uint8_t *buf, size_t buf_len, wire_header_t *header,
+                     const uint8_t **payload) {
+    if (!buf || !header || !payload) {
+        LOG_ERROR("Invalid parameters in wire_frame_parse");
+        return -1;
+    }
+    if (buf_len < WIRE_HEADER_LEN) {
+        return -2;
+    }
+
+    if (wire_get_be(buf, 2) != WIRE_MAGIC) {
+        LOG_ERROR("Not a protocol frame");
+        return -3;
+    }
+    if (buf[2] != WIRE_VERSION) {
+        LOG_ERROR("Unsupported frame version %d", buf[2]);
+        return -4;
+    }
+
+    header->version = buf[2];
+    header->type = (wire_type_t)buf[3];
+    header->instance_id = wire_get_be(buf + 4, 8);
+    header->num_instances = (uint32_t)wire_get_be(buf + 12, 4);
+    header->first_bit = (uint16_t)wire_get_be(buf + 16, 2);
+    header->num_bits = (uint16_t)wire_get_be(buf + 18, 2);
+    header->payload_len = (uint32_t)wire_get_be(buf + 20, 4);
+
+    // The length must be the one implied by the type and the ranges, so the
+    // typed views below never reach past the payload
+    size_t expected = wire_payload_len(header->type, header->num_instances,
+                                       header->num_bits);
+    if (expected == 0 || expected != header->payload_len ||
+        (uint32_t)header->first_bit + header->num_bits > MTA_NUM_BITS) {
+        LOG_ERROR("Malformed frame header (type %d, %u instances, bits %u+%u, %u bytes)",
+                  buf[3], header->num_instances, header->first_bit,
+                  header->num_bits, header->payload_len);
+        return -5;
+    }
+    if (buf_len - WIRE_HEADER_LEN < header->payload_len) {
+        return -2;
+    }
+
+    *payload = buf + WIRE_HEADER_LEN;
+    return 0;
+}
+
+int wire_encode_sender_msgs(uint8_t *buf, size_t buf_len, uint64_t instance_id,
+                            uint16_t first_bit, uint16_t num_bits,
+                            const OT_SenderMessage *msgs) {
+    uint8_t *payload;
+    if (!msgs) {
+        LOG_ERROR("Invalid parameters in wire_encode_sender_msgs");
+        return -1;
+    }
+
+    int ret = wire_frame_begin(buf, buf_len, WIRE_OT_SENDER_MSGS, instance_id, 1,
+                               first_bit, num_bits, &payload);
+    if (ret == 0) {
+        memcpy(payload, msgs, (size_t)num_bits * sizeof(OT_SenderMessage));
+    }
+    return ret;
+}
+
+int wire_encode_receiver_msgs(uint8_t *buf, size_t buf_len, uint64_t instance_id,
+                              uint16_t first_bit, uint16_t num_bits,
+                              const OT_ReceiverMessage *msgs) {
+    uint8_t *payload;
+    if (!msgs) {
+        LOG_ERROR("Invalid parameters in wire_encode_receiver_msgs");
+        return -1;
+    }
+
+    int ret = wire_frame_begin(buf, buf_len, WIRE_OT_RECEIVER_MSGS, instance_id, 1,
+                               first_bit, num_bits, &payload);
+    if (ret == 0) {
+        memcpy(payload, msgs, (size_t)num_bits * sizeof(OT_ReceiverMessage));
+    }
+    return ret;
+}
+
+int wire_encode_ciphertexts(uint8_t *buf, size_t buf_len, uint64_t instance_id,
+                            uint16_t first_bit, uint16_t num_bits,
+                            const uint8_t (*c0)[32], const uint8_t (*c1)[32]) {
+    uint8_t *payload;
+    if (!c0 || !c1) {
+        LOG_ERROR("Invalid parameters in wire_encode_ciphertexts");
+        return -1;
+    }
+
+    int ret = wire_frame_begin(buf, buf_len, WIRE_CIPHERTEXTS, instance_id, 1,
+                               first_bit, num_bits, &payload);
+    if (ret == 0) {
+        memcpy(payload, c0, (size_t)num_bits * 32);
+        memcpy(payload + (size_t)num_bits * 32, c1, (size_t)num_bits * 32);
+    }
+    return ret;
+}
+
+// Parses a frame and checks that it carries the expected type
+static int decode_typed(const uint8_t *buf, size_t buf_len, wire_type_t type,
+                        wire_header_t *header, const uint8_t **payload) {
+    int ret = wire_frame_parse(buf, buf_len, header, payload);
+    if (ret != 0) {
+        return ret;
+    }
+    if (header->type != type) {
+        LOG_ERROR("Expected a frame of type %d, got %d", type, header->type);
+        return -6;
+    }
+    return 0;
+}
+
+int wire_decode_sender_msgs(const uint8_t *buf, size_t buf_len, wire_header_t *header,
+                            const OT_SenderMessage **msgs) {
+    const uint8_t *payload;
+    if (!msgs) {
+        LOG_ERROR("Invalid parameters in wire_decode_sender_msgs");
+        return -1;
+    }
+
+    // OT_SenderMessage is a byte array, so the payload can be used in place
+    int ret = decode_typed(buf, buf_len, WIRE_OT_SENDER_MSGS, header, &payload);
+    if (ret == 0) {
+        *msgs = (const OT_SenderMessage *)payload;
+    }
+    return ret;
+}
+
+int wire_decode_receiver_msgs(const uint8_t *buf, size_t buf_len, wire_header_t *header,
+                              const OT_ReceiverMessage **msgs) {
+    const uint8_t *payload;
+    if (!msgs) {
+        LOG_ERROR("Invalid parameters in wire_decode_receiver_msgs");
+        return -1;
+    }
+
+    int ret = decode_typed(buf, buf_len, WIRE_OT_RECEIVER_MSGS, header, &payload);
+    if (ret == 0) {
+        *msgs = (const OT_ReceiverMessage *)payload;
+    }
+    return ret;
+}
+
+int wire_decode_ciphertexts(const uint8_t *buf, size_t buf_len, wire_header_t *header,
+                            const uint8_t (**c0)[32], const uint8_t (**c1)[32]) {
+    const uint8_t *payload;
+    if (!c0 || !c1) {
+        LOG_ERROR("Invalid parameters in wire_decode_ciphertexts");
+        return -1;
+    }
+
+    int ret = decode_typed(buf, buf_len, WIRE_CIPHERTEXTS, header, &payload);
+    if (ret == 0) {
+        size_t block_len = (size_t)header->num_instances * header->num_bits * 32;
+        *c0 = (const uint8_t (*)[32])payload;
+        *c1 = (const uint8_t (*)[32])(payload + block_len);
+    }
+    return ret;
+}
+
+int wire_decode_ext(const uint8_t *buf, size_t buf_len, wire_type_t type,
+                    wire_header_t *header, const uint8_t **data) {
+    if (!data || (type != WIRE_EXT_MATRIX && type != WIRE_EXT_CORRECTIONS)) {
+        LOG_ERROR("Invalid parameters in wire_decode_ext");
+        return -1;
+    }
+
+    return decode_typed(buf, buf_len, type, header, data);
+}
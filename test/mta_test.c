@@ -5,11 +5,19 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 #include "mta.h"
+#include "mta_pool.h"
+#include "utils.h"
 #include "secp256k1.h"
 #include "rand.h"
 #include "logger.h"
 #include "mta_test.h"
+#include "wire.h"
+#include "transport.h"
+#include "mta_party.h"
+#include "point_ops.h"
+#include "kdf.h"
 
 // Utility function to print a bignum
 static void print_bignum(const char *label, const bignum256 *bn) {
@@ -57,13 +65,18 @@ int run_mta_full_test(void) {
     
     print_bignum("Expected product a*b (mod order)", &expected_product);
     
-    // Initialize MtA contexts
-    mta_context_t sender_ctx, receiver_ctx;
+    // Sessions come from a pool rather than two ~85 KB contexts on the stack
+    mta_pool_t *pool = mta_pool_create(2);
+    mta_context_t *sender_ctx = NULL, *receiver_ctx = NULL;
     
     LOG_INFO("Initializing MtA contexts...");
-    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
-        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0) {
+    if (pool) {
+        sender_ctx = mta_session_acquire(pool, MTA_ROLE_SENDER, &a);
+        receiver_ctx = mta_session_acquire(pool, MTA_ROLE_RECEIVER, &b);
+    }
+    if (!sender_ctx || !receiver_ctx) {
         LOG_ERROR("Failed to initialize MtA contexts");
+        mta_pool_destroy(pool);
         return -1;
     }
     
@@ -81,12 +94,14 @@ int run_mta_full_test(void) {
     
     LOG_INFO("Processing %d bits in the MtA protocol", bits_to_process);
     
-    // Sum of all Ui values (for sender's final share)
+    // Sum of all Ui values (for sender's final share), reduced once at the end
     bignum256 sum_Ui;
-    bn_zero(&sum_Ui);
+    scalar_acc_t sum_Ui_acc;
+    scalar_acc_init(&sum_Ui_acc);
     
     // Process bit by bit
-    for (int i = 0; i < bits_to_process; i++) {
+    int result = 0;
+    for (int i = 0; i < bits_to_process && result == 0; i++) {
         if (i % 32 == 0) {
             LOG_INFO("Processing bits %d to %d...", 
                     i, i + 31 < bits_to_process ? i + 31 : bits_to_process - 1);
@@ -94,41 +109,38 @@ int run_mta_full_test(void) {
         
         // Sender generates message for this bit
         OT_SenderMessage sender_msg;
-        if (mta_sender_bit_message(&sender_ctx, i, &sender_msg) != 0) {
+        if (mta_sender_bit_message(sender_ctx, i, &sender_msg) != 0) {
             LOG_ERROR("Failed to generate sender message for bit %d", i);
-            return -1;
+            result = -1;
+            break;
         }
         
         // Add the random value to the sum (for sender's final share)
-        bn_add(&sum_Ui, &sender_ctx.random_values[i]);
-        bn_mod(&sum_Ui, &secp256k1.order);
+        scalar_acc_add(&sum_Ui_acc, &sender_ctx->random_values[i]);
         
         // Receiver processes the sender's message to determine choice bit
         OT_ReceiverMessage receiver_msg;
-        if (mta_receiver_bit_response(&receiver_ctx, i, &sender_msg, &receiver_msg) != 0) {
+        if (mta_receiver_bit_response(receiver_ctx, i, &sender_msg, &receiver_msg) != 0) {
             LOG_ERROR("Failed to process sender message for bit %d", i);
-            return -1;
+            result = -1;
+            break;
         }
         
-        // Get the receiver's choice bit for this position
-        int choice_bit = receiver_ctx.choice_bits[i];
-        
-        // Sender processes receiver's response (normally would generate encryption keys)
-        if (mta_sender_bit_complete(&sender_ctx, i, &receiver_msg) != 0) {
+        // Sender processes receiver's response and derives the encryption keys
+        if (mta_sender_bit_complete(sender_ctx, i, &receiver_msg) != 0) {
             LOG_ERROR("Failed to process receiver message for bit %d", i);
-            return -1;
+            result = -1;
+            break;
         }
         
-        // DIRECT TRANSFER without encryption: Determine which message to send based on choice bit
-        uint8_t *message_to_receive = choice_bit ? sender_ctx.m1_values[i] : sender_ctx.m0_values[i];
-        
-        // Convert message to bignum
-        bignum256 received_value;
-        bn_read_be(message_to_receive, &received_value);
-        
-        // Add to receiver's share
-        bn_add(&receiver_ctx.additive_share, &received_value);
-        bn_mod(&receiver_ctx.additive_share, &secp256k1.order);
+        // Sender encrypts m0 and m1, receiver decrypts the chosen one and adds it to his share
+        uint8_t c0[32], c1[32];
+        if (mta_sender_bit_encrypt(sender_ctx, i, c0, c1) != 0 ||
+            mta_receiver_bit_complete(receiver_ctx, i, c0, c1) != 0) {
+            LOG_ERROR("Failed to transfer the message of bit %d", i);
+            result = -1;
+            break;
+        }
         
         // Print status periodically
         if (i % 32 == 31 || i == bits_to_process - 1) {
@@ -136,6 +148,9 @@ int run_mta_full_test(void) {
         }
     }
     
+    scalar_acc_get(&sum_Ui_acc, &sum_Ui);
+    mta_compute_additive_share(receiver_ctx);
+    
     // Calculate sender's share as -sum(Ui)
     bignum256 sender_share;
     bn_subtract(&secp256k1.order, &sum_Ui, &sender_share);
@@ -144,20 +159,1673 @@ int run_mta_full_test(void) {
     LOG_INFO("--- Final Results ---");
     print_bignum("Sum of all Ui values", &sum_Ui);
     print_bignum("Sender's Share (c = -Σ Ui)", &sender_share);
-    print_bignum("Receiver's Share (d = Σ received values)", &receiver_ctx.additive_share);
+    print_bignum("Receiver's Share (d = Σ received values)", &receiver_ctx->additive_share);
     
     // Calculate c+d
     bignum256 c_plus_d;
     bn_copy(&sender_share, &c_plus_d);
-    bn_add(&c_plus_d, &receiver_ctx.additive_share);
+    bn_add(&c_plus_d, &receiver_ctx->additive_share);
     bn_mod(&c_plus_d, &secp256k1.order);
     
+    mta_session_release(pool, sender_ctx);
+    mta_session_release(pool, receiver_ctx);
+    mta_pool_destroy(pool);
+    
     LOG_INFO("--- Verification ---");
     print_bignum("a*b", &expected_product);
     print_bignum("c+d", &c_plus_d);
     
-    int verified = bn_is_equal(&expected_product, &c_plus_d);
+    int verified = result == 0 && bn_is_equal(&expected_product, &c_plus_d);
     LOG_INFO("Verification result: %s", verified ? "SUCCESS" : "FAILURE");
     
     return verified ? 0 : -1;
-}
\ No newline at end of file
+}
+
+// Run the base phase of an OT extension session between the two parties
+static int setup_ot_ext_session(ot_ext_sender_t *ot_sender, ot_ext_receiver_t *ot_receiver) {
+    OT_SenderMessage base_msgs[OT_EXT_KAPPA];
+    OT_ReceiverMessage base_responses[OT_EXT_KAPPA];
+    
+    clock_t start = clock();
+    if (ot_ext_receiver_setup(ot_receiver, base_msgs) != 0 ||
+        ot_ext_sender_setup(ot_sender, base_msgs, base_responses) != 0 ||
+        ot_ext_receiver_setup_complete(ot_receiver, base_responses) != 0) {
+        LOG_ERROR("OT extension base phase failed");
+        return -1;
+    }
+    LOG_INFO("Base phase: %.1f ms", 1000.0 * (clock() - start) / CLOCKS_PER_SEC);
+    
+    return 0;
+}
+
+// Run one MtA over an already established OT extension session
+static int run_mta_ext_instance(ot_ext_sender_t *ot_sender, ot_ext_receiver_t *ot_receiver) {
+    bignum256 a, b;
+    generate_random_scalar(&a);
+    generate_random_scalar(&b);
+    
+    mta_context_t sender_ctx, receiver_ctx;
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0) {
+        LOG_ERROR("Failed to initialize MtA contexts");
+        return -1;
+    }
+    
+    static uint8_t matrix[MTA_EXT_MATRIX_LEN];
+    static uint8_t corrections[MTA_NUM_BITS][32];
+    
+    if (mta_receiver_ext_choose(&receiver_ctx, ot_receiver, matrix) != 0 ||
+        mta_sender_ext_transfer(&sender_ctx, ot_sender, matrix, corrections) != 0 ||
+        mta_receiver_ext_complete(&receiver_ctx, (const uint8_t (*)[32])corrections) != 0) {
+        LOG_ERROR("MtA over OT extension failed");
+        return -1;
+    }
+    
+    // The transfer already set the sender's share
+    bignum256 c, d;
+    mta_compute_additive_share(&receiver_ctx);
+    mta_get_additive_share(&sender_ctx, &c);
+    mta_get_additive_share(&receiver_ctx, &d);
+    
+    return mta_verify(&a, &b, &c, &d) ? 0 : -1;
+}
+
+int run_mta_ot_ext_test(void) {
+    LOG_INFO("===== MtA over OT Extension Test =====");
+    
+    static ot_ext_sender_t ot_sender;
+    static ot_ext_receiver_t ot_receiver;
+    if (setup_ot_ext_session(&ot_sender, &ot_receiver) != 0) {
+        return -1;
+    }
+    
+    // Several MtA instances share the same session
+    clock_t start;
+    int result = 0;
+    for (int i = 0; i < 4 && result == 0; i++) {
+        start = clock();
+        result = run_mta_ext_instance(&ot_sender, &ot_receiver);
+        LOG_INFO("MtA instance %d: %.2f ms, %s", i,
+                 1000.0 * (clock() - start) / CLOCKS_PER_SEC,
+                 result == 0 ? "SUCCESS" : "FAILURE");
+    }
+    
+    ot_ext_sender_clear(&ot_sender);
+    ot_ext_receiver_clear(&ot_receiver);
+    
+    return result;
+}
+
+int run_mta_batch_test(void) {
+    LOG_INFO("===== Batched MtA Test =====");
+    
+    enum { BATCH_SIZE = 16 };
+    
+    static ot_ext_sender_t ot_sender;
+    static ot_ext_receiver_t ot_receiver;
+    if (setup_ot_ext_session(&ot_sender, &ot_receiver) != 0) {
+        return -1;
+    }
+    
+    bignum256 a[BATCH_SIZE], b[BATCH_SIZE], c[BATCH_SIZE], d[BATCH_SIZE];
+    for (int k = 0; k < BATCH_SIZE; k++) {
+        generate_random_scalar(&a[k]);
+        generate_random_scalar(&b[k]);
+    }
+    
+    // Counts whose buffer size would overflow and unknown roles are refused
+    mta_batch_t sender_batch, receiver_batch;
+    if (mta_batch_init(&receiver_batch, MTA_ROLE_RECEIVER, b, SIZE_MAX / 64) == 0 ||
+        mta_batch_init(&receiver_batch, (mta_role_t)2, b, BATCH_SIZE) == 0) {
+        LOG_ERROR("Invalid MtA batch accepted");
+        return -1;
+    }
+    
+    if (mta_batch_init(&sender_batch, MTA_ROLE_SENDER, a, BATCH_SIZE) != 0 ||
+        mta_batch_init(&receiver_batch, MTA_ROLE_RECEIVER, b, BATCH_SIZE) != 0) {
+        LOG_ERROR("Failed to initialize MtA batches");
+        return -1;
+    }
+    
+    static uint8_t matrix[MTA_BATCH_MATRIX_LEN(BATCH_SIZE)];
+    static uint8_t corrections[MTA_BATCH_CORRECTIONS_LEN(BATCH_SIZE)];
+    
+    clock_t start = clock();
+    int result = 0;
+    if (mta_batch_receiver_choose(&receiver_batch, &ot_receiver, matrix) != 0 ||
+        mta_batch_sender_transfer(&sender_batch, &ot_sender, matrix, corrections) != 0 ||
+        mta_batch_receiver_complete(&receiver_batch, corrections) != 0 ||
+        mta_batch_get_additive_shares(&sender_batch, c) != 0 ||
+        mta_batch_get_additive_shares(&receiver_batch, d) != 0) {
+        LOG_ERROR("Batched MtA failed");
+        result = -1;
+    }
+    LOG_INFO("Batch of %d MtA instances: %.2f ms", BATCH_SIZE,
+             1000.0 * (clock() - start) / CLOCKS_PER_SEC);
+    
+    for (int k = 0; k < BATCH_SIZE && result == 0; k++) {
+        if (!mta_verify(&a[k], &b[k], &c[k], &d[k])) {
+            LOG_ERROR("Verification failed for batch instance %d", k);
+            result = -1;
+        }
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    mta_batch_free(&sender_batch);
+    mta_batch_free(&receiver_batch);
+    ot_ext_sender_clear(&ot_sender);
+    ot_ext_receiver_clear(&ot_receiver);
+    
+    return result;
+}
+
+int run_mta_parallel_test(int num_threads) {
+    LOG_INFO("===== Parallel MtA Test (%d threads) =====", num_threads);
+    
+    bignum256 a, b;
+    generate_random_scalar(&a);
+    generate_random_scalar(&b);
+    
+    static mta_context_t sender_ctx, receiver_ctx;
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0) {
+        LOG_ERROR("Failed to initialize MtA contexts");
+        return -1;
+    }
+    
+    thread_pool_t pool;
+    if (thread_pool_init(&pool, num_threads) != 0) {
+        LOG_ERROR("Failed to start the worker pool");
+        return -1;
+    }
+    
+    static OT_SenderMessage sender_msgs[MTA_NUM_BITS];
+    static OT_ReceiverMessage receiver_msgs[MTA_NUM_BITS];
+    static uint8_t c0[MTA_NUM_BITS][32], c1[MTA_NUM_BITS][32];
+    
+    // Wall-clock time, the CPU time of all threads would hide the speedup
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    int result = 0;
+    if (mta_sender_messages_parallel(&sender_ctx, &pool, sender_msgs) != 0 ||
+        mta_receiver_responses_parallel(&receiver_ctx, &pool, sender_msgs, receiver_msgs) != 0 ||
+        mta_sender_complete_parallel(&sender_ctx, &pool, receiver_msgs, c0, c1) != 0 ||
+        mta_receiver_complete_parallel(&receiver_ctx, &pool,
+                                       (const uint8_t (*)[32])c0,
+                                       (const uint8_t (*)[32])c1) != 0) {
+        LOG_ERROR("Parallel MtA failed");
+        result = -1;
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    LOG_INFO("Parallel MtA: %.1f ms", 1000.0 * (end.tv_sec - start.tv_sec) +
+                                      (end.tv_nsec - start.tv_nsec) / 1e6);
+    
+    thread_pool_free(&pool);
+    
+    if (result == 0) {
+        bignum256 c, d;
+        mta_get_additive_share(&sender_ctx, &c);
+        mta_get_additive_share(&receiver_ctx, &d);
+        result = mta_verify(&a, &b, &c, &d) ? 0 : -1;
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_mta_compact_test(void) {
+    LOG_INFO("===== Compact MtA Test =====");
+    LOG_INFO("Context size: %zu bytes (compact) vs %zu bytes (full)",
+             sizeof(mta_compact_t), sizeof(mta_context_t));
+    
+    bignum256 a, b;
+    generate_random_scalar(&a);
+    generate_random_scalar(&b);
+    
+    mta_compact_t sender_ctx, receiver_ctx;
+    if (mta_compact_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_compact_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0) {
+        LOG_ERROR("Failed to initialize compact MtA contexts");
+        return -1;
+    }
+    
+    // Bits travel in flights of one window: only the OT messages of the
+    // current flight exist at any time
+    int result = 0;
+    for (int base = 0; base < MTA_NUM_BITS && result == 0; base += MTA_COMPACT_WINDOW) {
+        OT_SenderMessage sender_msgs[MTA_COMPACT_WINDOW];
+        OT_ReceiverMessage receiver_msgs[MTA_COMPACT_WINDOW];
+        uint8_t c0[MTA_COMPACT_WINDOW][32], c1[MTA_COMPACT_WINDOW][32];
+        
+        for (int j = 0; j < MTA_COMPACT_WINDOW && result == 0; j++) {
+            if (mta_compact_sender_bit_message(&sender_ctx, base + j, &sender_msgs[j]) != 0 ||
+                mta_compact_receiver_bit_response(&receiver_ctx, base + j, &sender_msgs[j],
+                                                  &receiver_msgs[j]) != 0) {
+                result = -1;
+            }
+        }
+        for (int j = 0; j < MTA_COMPACT_WINDOW && result == 0; j++) {
+            if (mta_compact_sender_bit_complete(&sender_ctx, base + j, &receiver_msgs[j],
+                                                c0[j], c1[j]) != 0 ||
+                mta_compact_receiver_bit_complete(&receiver_ctx, base + j, c0[j], c1[j]) != 0) {
+                result = -1;
+            }
+        }
+        if (result != 0) {
+            LOG_ERROR("Compact MtA failed for bits %d to %d", base, base + MTA_COMPACT_WINDOW - 1);
+        }
+    }
+    
+    bignum256 c, d;
+    if (result == 0 &&
+        (mta_compact_get_additive_share(&sender_ctx, &c) != 0 ||
+         mta_compact_get_additive_share(&receiver_ctx, &d) != 0 ||
+         !mta_verify(&a, &b, &c, &d))) {
+        result = -1;
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    mta_compact_clear(&sender_ctx);
+    mta_compact_clear(&receiver_ctx);
+    
+    return result;
+}
+
+int run_mta_seeded_test(void) {
+    LOG_INFO("===== Seeded MtA Test =====");
+    
+    enum { CHECKED_BITS = 8 };
+    
+    bignum256 a, b;
+    generate_random_scalar(&a);
+    generate_random_scalar(&b);
+    
+    uint8_t sender_seed[PRG_SEED_LEN], receiver_seed[PRG_SEED_LEN];
+    random_buffer(sender_seed, sizeof(sender_seed));
+    random_buffer(receiver_seed, sizeof(receiver_seed));
+    
+    // Two runs from the same seeds must send the same messages
+    static mta_context_t sender_ctx[2], receiver_ctx[2];
+    OT_SenderMessage sender_msgs[2][CHECKED_BITS];
+    OT_ReceiverMessage receiver_msgs[2][CHECKED_BITS];
+    
+    for (int run = 0; run < 2; run++) {
+        if (mta_init_seeded(&sender_ctx[run], MTA_ROLE_SENDER, &a, sender_seed) != 0 ||
+            mta_init_seeded(&receiver_ctx[run], MTA_ROLE_RECEIVER, &b, receiver_seed) != 0) {
+            LOG_ERROR("Failed to initialize seeded MtA contexts");
+            return -1;
+        }
+        
+        for (int i = 0; i < CHECKED_BITS; i++) {
+            if (mta_sender_bit_message(&sender_ctx[run], i, &sender_msgs[run][i]) != 0 ||
+                mta_receiver_bit_response(&receiver_ctx[run], i, &sender_msgs[run][i],
+                                          &receiver_msgs[run][i]) != 0) {
+                LOG_ERROR("Seeded MtA failed for bit %d", i);
+                return -1;
+            }
+        }
+    }
+    
+    int result = 0;
+    if (memcmp(sender_msgs[0], sender_msgs[1], sizeof(sender_msgs[0])) != 0 ||
+        memcmp(receiver_msgs[0], receiver_msgs[1], sizeof(receiver_msgs[0])) != 0 ||
+        memcmp(sender_ctx[0].random_values, sender_ctx[1].random_values,
+               sizeof(sender_ctx[0].random_values)) != 0) {
+        LOG_ERROR("Runs from the same seed differ");
+        result = -1;
+    }
+    LOG_INFO("Reproducibility result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_mta_rounds_test(void) {
+    LOG_INFO("===== Three-Flow MtA Test =====");
+    
+    bignum256 a, b;
+    generate_random_scalar(&a);
+    generate_random_scalar(&b);
+    
+    uint8_t sender_seed[PRG_SEED_LEN], receiver_seed[PRG_SEED_LEN];
+    random_buffer(sender_seed, sizeof(sender_seed));
+    random_buffer(receiver_seed, sizeof(receiver_seed));
+    
+    // Run 0 uses the rounds, run 1 the per-bit functions, from the same seeds
+    static mta_context_t sender_ctx[2], receiver_ctx[2];
+    static OT_SenderMessage sender_msgs[2][MTA_NUM_BITS];
+    static OT_ReceiverMessage receiver_msgs[2][MTA_NUM_BITS];
+    static uint8_t c0[2][MTA_NUM_BITS][32], c1[2][MTA_NUM_BITS][32];
+    
+    for (int run = 0; run < 2; run++) {
+        if (mta_init_seeded(&sender_ctx[run], MTA_ROLE_SENDER, &a, sender_seed) != 0 ||
+            mta_init_seeded(&receiver_ctx[run], MTA_ROLE_RECEIVER, &b, receiver_seed) != 0) {
+            LOG_ERROR("Failed to initialize seeded MtA contexts");
+            return -1;
+        }
+    }
+    
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    int result = 0;
+    if (mta_sender_round1(&sender_ctx[0], sender_msgs[0]) != 0 ||
+        mta_receiver_round1(&receiver_ctx[0], sender_msgs[0], receiver_msgs[0]) != 0 ||
+        mta_sender_round2(&sender_ctx[0], receiver_msgs[0], c0[0], c1[0]) != 0 ||
+        mta_receiver_round2(&receiver_ctx[0], (const uint8_t (*)[32])c0[0],
+                            (const uint8_t (*)[32])c1[0]) != 0) {
+        LOG_ERROR("Three-flow MtA failed");
+        result = -1;
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    LOG_INFO("Three flows: %.1f ms",
+             1000.0 * (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e6);
+    
+    for (int i = 0; result == 0 && i < MTA_NUM_BITS; i++) {
+        if (mta_sender_bit_message(&sender_ctx[1], i, &sender_msgs[1][i]) != 0 ||
+            mta_receiver_bit_response(&receiver_ctx[1], i, &sender_msgs[1][i],
+                                      &receiver_msgs[1][i]) != 0 ||
+            mta_sender_bit_complete(&sender_ctx[1], i, &receiver_msgs[1][i]) != 0 ||
+            mta_sender_bit_encrypt(&sender_ctx[1], i, c0[1][i], c1[1][i]) != 0 ||
+            mta_receiver_bit_complete(&receiver_ctx[1], i, c0[1][i], c1[1][i]) != 0) {
+            LOG_ERROR("Per-bit MtA failed for bit %d", i);
+            result = -1;
+        }
+    }
+    if (result == 0) {
+        result = mta_compute_additive_share(&sender_ctx[1]) == 0 &&
+                 mta_compute_additive_share(&receiver_ctx[1]) == 0 ? 0 : -1;
+    }
+    
+    // Both schedules send the same flows and end with the same shares
+    bignum256 c[2], d[2];
+    for (int run = 0; result == 0 && run < 2; run++) {
+        mta_get_additive_share(&sender_ctx[run], &c[run]);
+        mta_get_additive_share(&receiver_ctx[run], &d[run]);
+    }
+    if (result == 0 &&
+        (memcmp(sender_msgs[0], sender_msgs[1], sizeof(sender_msgs[0])) != 0 ||
+         memcmp(receiver_msgs[0], receiver_msgs[1], sizeof(receiver_msgs[0])) != 0 ||
+         memcmp(c0[0], c0[1], sizeof(c0[0])) != 0 ||
+         memcmp(c1[0], c1[1], sizeof(c1[0])) != 0 ||
+         !bn_is_equal(&c[0], &c[1]) || !bn_is_equal(&d[0], &d[1]))) {
+        LOG_ERROR("Three-flow and per-bit schedules differ");
+        result = -1;
+    }
+    if (result == 0 && !mta_verify(&a, &b, &c[0], &d[0])) {
+        result = -1;
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_mta_simplest_test(void) {
+    LOG_INFO("===== Simplest OT MtA Test =====");
+    
+    bignum256 a, b;
+    generate_random_scalar(&a);
+    generate_random_scalar(&b);
+    
+    static mta_context_t sender_ctx, receiver_ctx;
+    static OT_ReceiverMessage receiver_msgs[MTA_NUM_BITS];
+    static uint8_t c0[MTA_NUM_BITS][32], c1[MTA_NUM_BITS][32];
+    OT_SenderMessage sender_msg;
+    
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0) {
+        LOG_ERROR("Failed to initialize MtA contexts");
+        return -1;
+    }
+    
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    int result = 0;
+    if (mta_sender_round1_simplest(&sender_ctx, &sender_msg) != 0 ||
+        mta_receiver_round1_simplest(&receiver_ctx, &sender_msg, receiver_msgs) != 0 ||
+        mta_sender_round2_simplest(&sender_ctx, receiver_msgs, c0, c1) != 0 ||
+        mta_receiver_round2(&receiver_ctx, (const uint8_t (*)[32])c0,
+                            (const uint8_t (*)[32])c1) != 0) {
+        LOG_ERROR("Simplest OT MtA failed");
+        result = -1;
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    LOG_INFO("Three flows over Simplest OT: %.1f ms",
+             1000.0 * (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e6);
+    
+    if (result == 0) {
+        bignum256 c, d;
+        mta_get_additive_share(&sender_ctx, &c);
+        mta_get_additive_share(&receiver_ctx, &d);
+        result = mta_verify(&a, &b, &c, &d) ? 0 : -1;
+    }
+    
+    // The sender key is spent after one instance
+    if (result == 0 && mta_sender_round2_simplest(&sender_ctx, receiver_msgs, c0, c1) == 0) {
+        LOG_ERROR("Simplest OT sender key was reused");
+        result = -1;
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_base_ot_curve25519_test(void) {
+    LOG_INFO("===== Curve25519 Base OT Test =====");
+    
+    base_ot_backend_t saved = base_ot_get_backend();
+    base_ot_set_backend(BASE_OT_BACKEND_CURVE25519);
+    
+    // Single OTs: the receiver's key is the sender's key of its choice only
+    int result = 0;
+    for (int choice_bit = 0; choice_bit <= 1 && result == 0; choice_bit++) {
+        uint8_t m0[32] = {0}, m1[32] = {1};
+        OT_SenderMessage sender_msg;
+        OT_ReceiverMessage receiver_msg;
+        bignum256 a;
+        uint8_t k0[32], k1[32], k_c[32];
+        
+        if (base_ot_init_sender(m0, m1, &sender_msg, &a) != 0 ||
+            base_ot_receiver_choice(&sender_msg, choice_bit, &receiver_msg, k_c) != 0 ||
+            base_ot_sender_keys(&a, &receiver_msg, k0, k1) != 0) {
+            LOG_ERROR("Curve25519 base OT failed for choice bit %d", choice_bit);
+            result = -1;
+            break;
+        }
+        if (sender_msg.A_compressed[0] != BASE_OT_CURVE25519_TAG ||
+            receiver_msg.B_compressed[0] != BASE_OT_CURVE25519_TAG ||
+            memcmp(k_c, choice_bit ? k1 : k0, 32) != 0 ||
+            memcmp(k_c, choice_bit ? k0 : k1, 32) == 0) {
+            LOG_ERROR("Wrong Curve25519 keys for choice bit %d", choice_bit);
+            result = -1;
+        }
+        
+        // A secp256k1 point is not accepted by a Curve25519 sender
+        receiver_msg.B_compressed[0] = 0x02;
+        if (result == 0 && base_ot_sender_keys(&a, &receiver_msg, k0, k1) == 0) {
+            LOG_ERROR("Curve25519 sender accepted a secp256k1 point");
+            result = -1;
+        }
+    }
+    
+    // Whole MtAs on the Curve25519 backend, with one key per bit and over Simplest OT
+    bignum256 a, b;
+    generate_random_scalar(&a);
+    generate_random_scalar(&b);
+    
+    static mta_context_t sender_ctx, receiver_ctx;
+    static OT_SenderMessage sender_msgs[MTA_NUM_BITS];
+    static OT_ReceiverMessage receiver_msgs[MTA_NUM_BITS];
+    static uint8_t c0[MTA_NUM_BITS][32], c1[MTA_NUM_BITS][32];
+    
+    for (int simplest = 0; simplest <= 1 && result == 0; simplest++) {
+        if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+            mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0) {
+            LOG_ERROR("Failed to initialize MtA contexts");
+            result = -1;
+            break;
+        }
+        
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        
+        int ret;
+        if (simplest) {
+            ret = mta_sender_round1_simplest(&sender_ctx, &sender_msgs[0]);
+            if (ret == 0) {
+                ret = mta_receiver_round1_simplest(&receiver_ctx, &sender_msgs[0], receiver_msgs);
+            }
+            if (ret == 0) {
+                ret = mta_sender_round2_simplest(&sender_ctx, receiver_msgs, c0, c1);
+            }
+        } else {
+            ret = mta_sender_round1(&sender_ctx, sender_msgs);
+            if (ret == 0) {
+                ret = mta_receiver_round1(&receiver_ctx, sender_msgs, receiver_msgs);
+            }
+            if (ret == 0) {
+                ret = mta_sender_round2(&sender_ctx, receiver_msgs, c0, c1);
+            }
+        }
+        if (ret == 0) {
+            ret = mta_receiver_round2(&receiver_ctx, (const uint8_t (*)[32])c0,
+                                      (const uint8_t (*)[32])c1);
+        }
+        
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        LOG_INFO("Three flows over Curve25519%s: %.1f ms", simplest ? " Simplest OT" : "",
+                 1000.0 * (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e6);
+        
+        bignum256 c, d;
+        if (ret == 0) {
+            mta_get_additive_share(&sender_ctx, &c);
+            mta_get_additive_share(&receiver_ctx, &d);
+        }
+        if (ret != 0 || !mta_verify(&a, &b, &c, &d)) {
+            LOG_ERROR("Curve25519 MtA failed (simplest %d)", simplest);
+            result = -1;
+        }
+    }
+    
+    base_ot_set_backend(saved);
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_base_ot_vector_test(void) {
+    LOG_INFO("===== Base OT Vector Payload Test =====");
+    
+    // One OT carries a whole vector of packed scalars
+    enum { NUM_SCALARS = 16, PAYLOAD_LEN = NUM_SCALARS * 32 };
+    
+    uint8_t m0[PAYLOAD_LEN], m1[PAYLOAD_LEN];
+    for (int k = 0; k < NUM_SCALARS; k++) {
+        bignum256 v;
+        generate_random_scalar(&v);
+        bn_write_be(&v, m0 + k * 32);
+        generate_random_scalar(&v);
+        bn_write_be(&v, m1 + k * 32);
+    }
+    
+    int result = 0;
+    for (int choice_bit = 0; choice_bit <= 1 && result == 0; choice_bit++) {
+        OT_SenderMessage sender_msg;
+        OT_ReceiverMessage receiver_msg;
+        bignum256 a;
+        uint8_t k0[32], k1[32], k_c[32];
+        uint8_t c0[PAYLOAD_LEN], c1[PAYLOAD_LEN], output[PAYLOAD_LEN];
+        
+        if (base_ot_init_sender(m0, m1, &sender_msg, &a) != 0 ||
+            base_ot_receiver_choice(&sender_msg, choice_bit, &receiver_msg, k_c) != 0 ||
+            base_ot_sender_keys(&a, &receiver_msg, k0, k1) != 0 ||
+            base_ot_encrypt_messages(m0, m1, k0, k1, c0, c1, PAYLOAD_LEN) != 0 ||
+            base_ot_receive_message(choice_bit, k_c, c0, c1, output, PAYLOAD_LEN) != 0) {
+            LOG_ERROR("Base OT with a %d-byte payload failed", PAYLOAD_LEN);
+            return -1;
+        }
+        
+        if (memcmp(output, choice_bit ? m1 : m0, PAYLOAD_LEN) != 0) {
+            LOG_ERROR("Wrong message received for choice bit %d", choice_bit);
+            result = -1;
+        }
+        
+        // Encrypting zeros exposes the keystream, which must not repeat
+        uint8_t stream[PAYLOAD_LEN] = {0};
+        sha256_xor_crypt(stream, k0, PAYLOAD_LEN);
+        if (memcmp(stream, stream + PAYLOAD_LEN - 32, 32) == 0) {
+            LOG_ERROR("Keystream repeats across blocks");
+            result = -1;
+        }
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_scalar_acc_test(void) {
+    LOG_INFO("===== Scalar Accumulator Test =====");
+    
+    // Reference: reduce after every addition, as the MtA used to
+    enum { NUM_VALUES = 1000 };
+    scalar_acc_t acc;
+    bignum256 expected, sum, v;
+    scalar_acc_init(&acc);
+    bn_zero(&expected);
+    
+    for (int i = 0; i < NUM_VALUES; i++) {
+        // Include the largest scalar so that every limb sum grows quickly
+        if (i % 10 == 0) {
+            bn_copy(&secp256k1.order, &v);
+            v.val[0] -= 1;
+        } else {
+            generate_random_scalar(&v);
+        }
+        scalar_acc_add(&acc, &v);
+        bn_add(&expected, &v);
+        bn_mod(&expected, &secp256k1.order);
+    }
+    
+    scalar_acc_get(&acc, &sum);
+    int result = bn_is_equal(&sum, &expected) ? 0 : -1;
+    
+    // A full accumulator folds its sum into a single value first
+    acc.count = SCALAR_ACC_MAX_ADDS;
+    scalar_acc_add(&acc, &v);
+    bn_add(&expected, &v);
+    bn_mod(&expected, &secp256k1.order);
+    scalar_acc_get(&acc, &sum);
+    if (acc.count != 2 || !bn_is_equal(&sum, &expected)) {
+        LOG_ERROR("Accumulator fold changed the sum");
+        result = -1;
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_shifted_shares_test(void) {
+    LOG_INFO("===== Shifted Shares Test =====");
+    
+    bignum256 x, expected, power2i;
+    bignum256 shifted[MTA_NUM_BITS];
+    generate_random_scalar(&x);
+    
+    int result = mta_precompute_shifted_shares(&x, shifted);
+    
+    // Every doubled entry must match a direct multiplication by 2^i
+    for (int i = 0; i < MTA_NUM_BITS && result == 0; i++) {
+        pow2_bignum(i, &power2i);
+        bn_copy(&x, &expected);
+        bn_multiply(&power2i, &expected, &secp256k1.order);
+        bn_mod(&expected, &secp256k1.order);
+        if (!bn_is_equal(&shifted[i], &expected)) {
+            LOG_ERROR("Shifted share of bit %d does not match", i);
+            result = -1;
+        }
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_multi_point_test(void) {
+    LOG_INFO("===== Multi-Point Multiplication Test =====");
+    
+    enum { TERMS = 5 };
+    bignum256 k[TERMS + 1];
+    curve_point p[TERMS + 1];
+    for (int i = 0; i < TERMS; i++) {
+        bignum256 key;
+        generate_random_scalar(&k[i]);
+        generate_random_scalar(&key);
+        opt_scalar_multiply(&secp256k1, &key, &p[i]);
+    }
+    
+    // Every prefix of the terms against the sum of single multiplications
+    int result = 0;
+    curve_point expected, term, res;
+    point_set_infinity(&expected);
+    for (int n = 1; n <= TERMS && result == 0; n++) {
+        opt_point_multiply(&secp256k1, &k[n - 1], &p[n - 1], &term);
+        point_add(&secp256k1, &term, &expected);
+        if (opt_multi_point_multiply(&secp256k1, n, k, p, &res) != 1 ||
+            !point_is_equal(&res, &expected)) {
+            LOG_ERROR("Sum of %d terms differs", n);
+            result = -1;
+        }
+    }
+    
+    // k·P + k·(-P) cancels, and a zero scalar drops its term
+    if (result == 0) {
+        k[1] = k[0];
+        p[1] = p[0];
+        bn_subtract(&secp256k1.prime, &p[1].y, &p[1].y);
+        if (opt_multi_point_multiply(&secp256k1, 2, k, p, &res) != 1 ||
+            !point_is_infinity(&res)) {
+            LOG_ERROR("k·P + k·(-P) is not the point at infinity");
+            result = -1;
+        }
+        k[2] = k[0];
+        bn_zero(&k[1]);
+        opt_point_multiply(&secp256k1, &k[0], &p[0], &expected);
+        point_add(&secp256k1, &expected, &expected);
+        p[2] = p[0];
+        if (opt_multi_point_multiply(&secp256k1, 3, k, p, &res) != 1 ||
+            !point_is_equal(&res, &expected)) {
+            LOG_ERROR("k·P + 0·Q + k·P differs from 2k·P");
+            result = -1;
+        }
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+// Scalars the optimized multiplications are compared on: 0 to 15, n - 2,
+// n - 1 and random ones
+enum { DIFF_SMALL_SCALARS = 16, DIFF_RANDOM_SCALARS = 16 };
+enum { DIFF_SCALARS = DIFF_SMALL_SCALARS + 2 + DIFF_RANDOM_SCALARS };
+
+static void generate_diff_scalars(bignum256 k[DIFF_SCALARS]) {
+    bignum256 small;
+    int i = 0;
+    
+    for (; i < DIFF_SMALL_SCALARS; i++) {
+        bn_read_uint32((uint32_t)i, &k[i]);
+    }
+    for (uint32_t j = 2; j >= 1; j--, i++) {
+        bn_read_uint32(j, &small);
+        bn_subtract(&secp256k1.order, &small, &k[i]);
+    }
+    for (; i < DIFF_SCALARS; i++) {
+        generate_random_scalar(&k[i]);
+    }
+}
+
+int run_point_multiply_diff_test(void) {
+    LOG_INFO("===== Variable-Base Multiplication Differential Test =====");
+    
+    bignum256 k[DIFF_SCALARS], key;
+    generate_diff_scalars(k);
+    
+    // The generator and a random point
+    curve_point p[2];
+    p[0] = secp256k1.G;
+    generate_random_scalar(&key);
+    scalar_multiply(&secp256k1, &key, &p[1]);
+    
+    // Both engines against trezor's point_multiply
+    int result = 0;
+    curve_point expected, res;
+    for (int j = 0; j < 2; j++) {
+        for (int i = 0; i < DIFF_SCALARS; i++) {
+            point_multiply(&secp256k1, &k[i], &p[j], &expected);
+            if (opt_point_multiply(&secp256k1, &k[i], &p[j], &res) != 1 ||
+                !point_is_equal(&res, &expected)) {
+                LOG_ERROR("opt_point_multiply differs for scalar %d of point %d", i, j);
+                result = -1;
+            }
+            if (opt_point_multiply_ct(&secp256k1, &k[i], &p[j], &res) != 1 ||
+                !point_is_equal(&res, &expected)) {
+                LOG_ERROR("opt_point_multiply_ct differs for scalar %d of point %d", i, j);
+                result = -1;
+            }
+        }
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_comb_multiply_diff_test(void) {
+    LOG_INFO("===== Fixed-Base Multiplication Differential Test =====");
+    
+    bignum256 k[DIFF_SCALARS], key;
+    generate_diff_scalars(k);
+    
+    // Comb tables of the generator and of a random point
+    curve_point p[2];
+    p[0] = secp256k1.G;
+    generate_random_scalar(&key);
+    scalar_multiply(&secp256k1, &key, &p[1]);
+    
+    opt_comb_table *tables = malloc(2 * sizeof(opt_comb_table));
+    if (!tables) {
+        LOG_ERROR("Failed to allocate the comb tables");
+        return -1;
+    }
+    int result = 0;
+    for (int j = 0; j < 2; j++) {
+        if (opt_comb_table_build(&secp256k1, &p[j], &tables[j]) != 1) {
+            LOG_ERROR("Failed to build the comb table of point %d", j);
+            result = -1;
+        }
+    }
+    
+    // opt_scalar_multiply against scalar_multiply, the tables against
+    // point_multiply
+    curve_point expected, res;
+    for (int i = 0; i < DIFF_SCALARS && result == 0; i++) {
+        scalar_multiply(&secp256k1, &k[i], &expected);
+        if (opt_scalar_multiply(&secp256k1, &k[i], &res) != 1 ||
+            !point_is_equal(&res, &expected)) {
+            LOG_ERROR("opt_scalar_multiply differs for scalar %d", i);
+            result = -1;
+        }
+        for (int j = 0; j < 2; j++) {
+            point_multiply(&secp256k1, &k[i], &p[j], &expected);
+            if (opt_comb_multiply(&secp256k1, tables[j].cp, &k[i], &res) != 1 ||
+                !point_is_equal(&res, &expected)) {
+                LOG_ERROR("opt_comb_multiply differs for scalar %d of point %d", i, j);
+                result = -1;
+            }
+        }
+    }
+    free(tables);
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+// Checks jacobian_batch_to_affine on count points against jacobian_to_curve,
+// or the point at infinity where z == 0 modulo p
+static int check_batch_to_affine(const jacobian_curve_point *points, size_t count,
+                                 curve_point *out) {
+    const bignum256 *prime = &secp256k1.prime;
+    curve_point expected;
+    bignum256 z;
+    
+    jacobian_batch_to_affine(points, out, count, prime);
+    for (size_t i = 0; i < count; i++) {
+        z = points[i].z;
+        bn_mod(&z, prime);
+        if (bn_is_zero(&z)) {
+            point_set_infinity(&expected);
+        } else {
+            jacobian_to_curve(&points[i], &expected, prime);
+        }
+        if (!point_is_equal(&out[i], &expected)) {
+            LOG_ERROR("Point %zu of a batch of %zu differs", i, count);
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+int run_batch_to_affine_diff_test(void) {
+    LOG_INFO("===== Batch Jacobian-to-Affine Differential Test =====");
+    
+    // Results of opt_point_multiply_ct_jacobian (infinity first, for k = 0),
+    // points with a random z, then z == 0 and z == p
+    enum { RANDOM_Z_POINTS = 4, BATCH = DIFF_SCALARS + RANDOM_Z_POINTS + 2 };
+    bignum256 k[DIFF_SCALARS], key;
+    jacobian_curve_point points[BATCH];
+    curve_point p, out[BATCH];
+    generate_diff_scalars(k);
+    generate_random_scalar(&key);
+    scalar_multiply(&secp256k1, &key, &p);
+    
+    int result = 0;
+    size_t n = 0;
+    for (int i = 0; i < DIFF_SCALARS; i++, n++) {
+        if (opt_point_multiply_ct_jacobian(&secp256k1, &k[i], &p, &points[n]) != 1) {
+            LOG_ERROR("opt_point_multiply_ct_jacobian failed for scalar %d", i);
+            result = -1;
+        }
+    }
+    for (int i = 0; i < RANDOM_Z_POINTS + 2; i++, n++) {
+        curve_to_jacobian(&p, &points[n], &secp256k1.prime);
+        point_add(&secp256k1, &secp256k1.G, &p);
+    }
+    bn_zero(&points[BATCH - 2].z);
+    points[BATCH - 1].z = secp256k1.prime;
+    
+    // The whole batch, a single point, and a batch of points at infinity only
+    if (result == 0) {
+        result = check_batch_to_affine(points, BATCH, out);
+    }
+    if (result == 0) {
+        result = check_batch_to_affine(points + 1, 1, out);
+    }
+    if (result == 0) {
+        result = check_batch_to_affine(points + BATCH - 2, 2, out);
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+// Checks bn_multiply(k, x) modulo m against the generic 29-bit limb
+// reduction; both only need to agree modulo m and be partly reduced
+static int check_multiply(const bignum256 *k, const bignum256 *x, const bignum256 *m) {
+    bignum512 wide;
+    bignum256 expected, res = *x;
+    
+    bn_multiply(k, &res, m);
+    bn_multiply_long(k, x, &wide);
+    bn_reduce(&wide, m);
+    bn_copy_lower(&wide, &expected);
+    
+    for (int i = 0; i < BN_LIMBS - 1; i++) {
+        if (res.val[i] > BN_LIMB_MASK) {
+            return -1;
+        }
+    }
+    bn_mod(&res, m);
+    bn_mod(&expected, m);
+    
+    return bn_is_less(&res, m) && bn_is_equal(&res, &expected) ? 0 : -1;
+}
+
+int run_bn_multiply_diff_test(void) {
+    LOG_INFO("===== Modular Multiplication Differential Test =====");
+#if !USE_BN_INT128
+    LOG_INFO("bn_multiply has no 64-bit limb path in this build");
+#endif
+    
+    // Operands of the contract (normalized, k * x < 2**519) near the edges:
+    // 0, 1, m - 2, m - 1, m, m + 1, 2**256 - 1 and 2m - 1, then random ones
+    enum { EDGES = 8, RANDOM_OPERANDS = 64 };
+    const bignum256 *moduli[2] = { &secp256k1.prime, &secp256k1.order };
+    const char *names[2] = { "p", "n" };
+    bignum256 edges[EDGES], random_operands[RANDOM_OPERANDS], one;
+    uint8_t buffer[32];
+    
+    for (int i = 0; i < RANDOM_OPERANDS; i++) {
+        random_buffer(buffer, sizeof(buffer));
+        bn_read_be(buffer, &random_operands[i]);
+    }
+    memset(buffer, 0xff, sizeof(buffer));
+    bn_one(&one);
+    
+    int result = 0;
+    for (int m = 0; m < 2; m++) {
+        const bignum256 *mod = moduli[m];
+        bn_zero(&edges[0]);
+        bn_one(&edges[1]);
+        bn_read_uint32(2, &edges[2]);
+        bn_subtract(mod, &edges[2], &edges[2]);
+        bn_subtract(mod, &one, &edges[3]);
+        edges[4] = *mod;
+        edges[5] = *mod;
+        bn_add(&edges[5], &one);
+        bn_read_be(buffer, &edges[6]);
+        edges[7] = edges[3];
+        bn_add(&edges[7], mod);
+    
+        int failures = 0;
+        for (int i = 0; i < EDGES; i++) {
+            for (int j = 0; j < EDGES; j++) {
+                failures += check_multiply(&edges[i], &edges[j], mod) != 0;
+            }
+            for (int j = 0; j < RANDOM_OPERANDS; j++) {
+                failures += check_multiply(&edges[i], &random_operands[j], mod) != 0;
+                failures += check_multiply(&random_operands[j], &edges[i], mod) != 0;
+            }
+        }
+        for (int i = 0; i < RANDOM_OPERANDS; i++) {
+            for (int j = 0; j < RANDOM_OPERANDS; j++) {
+                failures += check_multiply(&random_operands[i], &random_operands[j], mod) != 0;
+            }
+        }
+        if (failures) {
+            LOG_ERROR("%d products modulo %s differ from the generic reduction", failures, names[m]);
+            result = -1;
+        }
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_sha256_test(void) {
+    LOG_INFO("===== SHA-256 Fast Paths Test =====");
+    
+    // Known answers go through sha256_Transform, with SHA-NI when present
+    static const struct {
+        const char *msg;
+        const char *digest;
+    } vectors[] = {
+        { "", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+        { "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+        { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+          "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+    };
+    
+    int result = 0;
+    for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]) && result == 0; v++) {
+        uint8_t digest[SHA256_DIGEST_LENGTH];
+        char hex[2 * SHA256_DIGEST_LENGTH + 1];
+        sha256_Raw((const uint8_t *)vectors[v].msg, strlen(vectors[v].msg), digest);
+        for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+            sprintf(hex + 2 * i, "%02x", digest[i]);
+        }
+        if (strcmp(hex, vectors[v].digest) != 0) {
+            LOG_ERROR("SHA-256 of \"%s\" is %s", vectors[v].msg, hex);
+            result = -1;
+        }
+    }
+    
+    // The 8-way hashes against sha256_Raw, across the padding boundaries
+    enum { MAX_LEN = 200, COUNT = 11 };
+    static uint8_t msgs[COUNT][MAX_LEN];
+    random_buffer(&msgs[0][0], sizeof(msgs));
+    const uint8_t *ptrs[COUNT];
+    for (int i = 0; i < COUNT; i++) {
+        ptrs[i] = msgs[i];
+    }
+    
+    for (size_t len = 0; len <= MAX_LEN && result == 0; len++) {
+        uint8_t batch[COUNT][SHA256_DIGEST_LENGTH], single[SHA256_DIGEST_LENGTH];
+        sha256_Raw_batch(COUNT, ptrs, len, batch);
+        for (int i = 0; i < COUNT; i++) {
+            sha256_Raw(msgs[i], len, single);
+            if (memcmp(batch[i], single, sizeof(single)) != 0) {
+                LOG_ERROR("Batched SHA-256 of message %d differs at length %zu", i, len);
+                result = -1;
+                break;
+            }
+        }
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_kdf_test(void) {
+    LOG_INFO("===== KDF Backends Test =====");
+    
+    // BLAKE2s-256 of "abc"
+    static const uint8_t blake2s_abc[32] = {
+        0x50, 0x8c, 0x5e, 0x8c, 0x32, 0x7c, 0x14, 0xe2, 0xe1, 0xa7, 0x2b, 0xa3, 0x4e, 0xeb, 0x45, 0x2f,
+        0x37, 0x45, 0x8b, 0x20, 0x9e, 0xd6, 0x3a, 0x29, 0x4d, 0x99, 0x9b, 0x4c, 0x86, 0x67, 0x59, 0x82
+    };
+    uint8_t digest[KDF_BLOCK_LEN];
+    kdf_hash(KDF_BACKEND_BLAKE2S, (const uint8_t *)"abc", 3, digest);
+    int result = memcmp(digest, blake2s_abc, sizeof(digest)) == 0 ? 0 : -1;
+    if (result != 0) {
+        LOG_ERROR("BLAKE2s of \"abc\" is wrong");
+    }
+    
+    // The AES backend computes the same hashes and streams with and without AES-NI
+    enum { ROWS = 21, SEEDS = 3, BLOCKS = 3 };
+    static uint8_t rows[ROWS][KDF_CRH_INPUT_LEN];
+    static uint8_t seeds[SEEDS][32];
+    static uint8_t hashes[2][ROWS][KDF_BLOCK_LEN];
+    static uint8_t streams[2][SEEDS][BLOCKS * KDF_BLOCK_LEN];
+    random_buffer(&rows[0][0], sizeof(rows));
+    random_buffer(&seeds[0][0], sizeof(seeds));
+    
+    int aes_ni = kdf_use_aes_ni(1);
+    for (int ni = 0; ni < 2; ni++) {
+        kdf_use_aes_ni(ni);
+        kdf_crh_rows(KDF_BACKEND_AES, 1000, (const uint8_t (*)[KDF_CRH_INPUT_LEN])rows, ROWS,
+                     hashes[ni]);
+        kdf_prg(KDF_BACKEND_AES, (const uint8_t (*)[32])seeds, SEEDS, 7, BLOCKS,
+                streams[ni][0], sizeof(streams[ni][0]));
+    }
+    kdf_use_aes_ni(1);
+    LOG_INFO("AES-NI: %s", aes_ni ? "yes" : "no");
+    if (result == 0 && (memcmp(hashes[0], hashes[1], sizeof(hashes[0])) != 0 ||
+                        memcmp(streams[0], streams[1], sizeof(streams[0])) != 0)) {
+        LOG_ERROR("AES-NI and portable AES disagree");
+        result = -1;
+    }
+    
+    // An MtA over base OTs and an OT extension session with every backend
+    static const kdf_backend_t backends[] = {
+        KDF_BACKEND_SHA256, KDF_BACKEND_BLAKE2S, KDF_BACKEND_AES
+    };
+    static ot_ext_sender_t ot_sender;
+    static ot_ext_receiver_t ot_receiver;
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]) && result == 0; i++) {
+        kdf_set_backend(backends[i]);
+        result = run_mta_full_test();
+        if (result == 0) {
+            result = setup_ot_ext_session(&ot_sender, &ot_receiver);
+        }
+        if (result == 0) {
+            result = run_mta_ext_instance(&ot_sender, &ot_receiver);
+        }
+        LOG_INFO("Backend %s: %s", kdf_backend_name(backends[i]),
+                 result == 0 ? "SUCCESS" : "FAILURE");
+        ot_ext_sender_clear(&ot_sender);
+        ot_ext_receiver_clear(&ot_receiver);
+    }
+    kdf_set_backend(KDF_DEFAULT_BACKEND);
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_wire_test(void) {
+    LOG_INFO("===== Wire Format Test =====");
+    
+    bignum256 a, b;
+    generate_random_scalar(&a);
+    generate_random_scalar(&b);
+    
+    static mta_context_t sender_ctx, receiver_ctx;
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0) {
+        LOG_ERROR("Failed to initialize MtA contexts");
+        return -1;
+    }
+    
+    // One frame per round, each party only sees the frames of the other
+    static uint8_t round1[WIRE_HEADER_LEN + MTA_NUM_BITS * 33];
+    static uint8_t round2[WIRE_HEADER_LEN + MTA_NUM_BITS * 33];
+    static uint8_t round3[WIRE_HEADER_LEN + MTA_NUM_BITS * 64];
+    const uint64_t instance_id = 42;
+    uint8_t *out;
+    wire_header_t header;
+    const OT_SenderMessage *sender_msgs;
+    const OT_ReceiverMessage *receiver_msgs;
+    const uint8_t (*c0)[32], (*c1)[32];
+    
+    // The protocol functions write straight into the frame payloads
+    int result = 0;
+    if (wire_frame_begin(round1, sizeof(round1), WIRE_OT_SENDER_MSGS, instance_id, 1,
+                         0, MTA_NUM_BITS, &out) != 0 ||
+        mta_sender_messages_parallel(&sender_ctx, NULL, (OT_SenderMessage *)out) != 0 ||
+        wire_decode_sender_msgs(round1, sizeof(round1), &header, &sender_msgs) != 0 ||
+        wire_frame_begin(round2, sizeof(round2), WIRE_OT_RECEIVER_MSGS, header.instance_id, 1,
+                         header.first_bit, header.num_bits, &out) != 0 ||
+        mta_receiver_responses_parallel(&receiver_ctx, NULL, sender_msgs,
+                                        (OT_ReceiverMessage *)out) != 0 ||
+        wire_decode_receiver_msgs(round2, sizeof(round2), &header, &receiver_msgs) != 0 ||
+        wire_frame_begin(round3, sizeof(round3), WIRE_CIPHERTEXTS, header.instance_id, 1,
+                         header.first_bit, header.num_bits, &out) != 0 ||
+        mta_sender_complete_parallel(&sender_ctx, NULL, receiver_msgs, (uint8_t (*)[32])out,
+                                     (uint8_t (*)[32])(out + MTA_NUM_BITS * 32)) != 0 ||
+        wire_decode_ciphertexts(round3, sizeof(round3), &header, &c0, &c1) != 0 ||
+        mta_receiver_complete_parallel(&receiver_ctx, NULL, c0, c1) != 0) {
+        LOG_ERROR("MtA over framed rounds failed");
+        result = -1;
+    }
+    
+    if (result == 0) {
+        bignum256 c, d;
+        mta_get_additive_share(&sender_ctx, &c);
+        mta_get_additive_share(&receiver_ctx, &d);
+        if (header.instance_id != instance_id || !mta_verify(&a, &b, &c, &d)) {
+            result = -1;
+        }
+    }
+    
+    // Truncated, mistyped and unknown-version frames are refused
+    if (result == 0) {
+        if (wire_decode_ciphertexts(round3, sizeof(round3) - 1, &header, &c0, &c1) != -2 ||
+            wire_decode_sender_msgs(round3, sizeof(round3), &header, &sender_msgs) == 0) {
+            result = -1;
+        }
+        round3[2] = WIRE_VERSION + 1;
+        if (wire_decode_ciphertexts(round3, sizeof(round3), &header, &c0, &c1) == 0) {
+            result = -1;
+        }
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+typedef struct {
+    mta_context_t *ctx;
+    transport_t *transport;
+    int pipelined;
+    int result;
+} receiver_party_t;
+
+static void *receiver_party_main(void *arg) {
+    receiver_party_t *party = (receiver_party_t *)arg;
+    if (party->pipelined) {
+        party->result = mta_party_run_receiver_pipelined(party->ctx, party->transport, 7);
+    } else {
+        party->result = mta_party_run_receiver(party->ctx, party->transport, NULL, 7);
+    }
+    return NULL;
+}
+
+// One MtA between two threads, each holding one end of the transport;
+// a window > 0 runs the pipelined parties with that window and chunk
+static int run_two_party(const char *name, int (*make_pair)(transport_t *, transport_t *),
+                         int window, int chunk) {
+    bignum256 a, b;
+    generate_random_scalar(&a);
+    generate_random_scalar(&b);
+    
+    static mta_context_t sender_ctx, receiver_ctx;
+    transport_t sender_end, receiver_end;
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0 ||
+        make_pair(&sender_end, &receiver_end) != 0) {
+        LOG_ERROR("Failed to set up the %s parties", name);
+        return -1;
+    }
+    
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    receiver_party_t receiver = { &receiver_ctx, &receiver_end, window > 0, -1 };
+    pthread_t thread;
+    int result = 0;
+    if (pthread_create(&thread, NULL, receiver_party_main, &receiver) != 0) {
+        result = -1;
+    } else {
+        if (window > 0) {
+            result = mta_party_run_sender_pipelined(&sender_ctx, &sender_end, 7,
+                                                    window, chunk);
+        } else {
+            result = mta_party_run_sender(&sender_ctx, &sender_end, NULL, 7);
+        }
+        // A failed sender must not leave the receiver waiting
+        if (result != 0) {
+            transport_close(&sender_end);
+        }
+        pthread_join(thread, NULL);
+        if (receiver.result != 0) {
+            result = -1;
+        }
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    LOG_INFO("%s: %.1f ms, %llu bytes sent, %llu bytes received", name,
+             1000.0 * (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e6,
+             (unsigned long long)sender_end.bytes_sent,
+             (unsigned long long)sender_end.bytes_received);
+    
+    if (result == 0) {
+        bignum256 c, d;
+        mta_get_additive_share(&sender_ctx, &c);
+        mta_get_additive_share(&receiver_ctx, &d);
+        result = mta_verify(&a, &b, &c, &d) ? 0 : -1;
+    }
+    
+    transport_close(&sender_end);
+    transport_close(&receiver_end);
+    
+    return result;
+}
+
+int run_mta_two_party_test(void) {
+    LOG_INFO("===== Two-Party MtA Test =====");
+    
+    int result = run_two_party("loopback", transport_loopback_pair, 0, 0);
+    if (result == 0) {
+        result = run_two_party("socketpair", transport_socketpair, 0, 0);
+    }
+    if (result == 0) {
+        result = run_two_party("tcp", transport_tcp_pair, 0, 0);
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+int run_mta_pipelined_test(void) {
+    LOG_INFO("===== Pipelined MtA Test =====");
+    
+    // Uneven chunks, a single bit in flight and the whole MtA in flight
+    int result = run_two_party("loopback, window 64, chunk 16", transport_loopback_pair, 64, 16);
+    if (result == 0) {
+        result = run_two_party("socketpair, window 100, chunk 30", transport_socketpair, 100, 30);
+    }
+    if (result == 0) {
+        result = run_two_party("tcp, window 1, chunk 1", transport_tcp_pair, 1, 1);
+    }
+    if (result == 0) {
+        result = run_two_party("tcp, window 256, chunk 256", transport_tcp_pair,
+                               MTA_NUM_BITS, MTA_NUM_BITS);
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+// Checks that a released session left nothing behind
+static int session_is_wiped(const mta_context_t *ctx) {
+    static const mta_context_t zero;
+    return memcmp(ctx, &zero, sizeof(zero)) == 0;
+}
+
+int run_mta_pool_test(void) {
+    LOG_INFO("===== MtA Session Pool Test =====");
+    
+    mta_pool_t *pool = mta_pool_create(2);
+    if (!pool) {
+        LOG_ERROR("Failed to create the session pool");
+        return -1;
+    }
+    
+    static ot_ext_sender_t ot_sender;
+    static ot_ext_receiver_t ot_receiver;
+    static OT_SenderMessage sender_msgs[MTA_NUM_BITS];
+    static OT_ReceiverMessage receiver_msgs[MTA_NUM_BITS];
+    static uint8_t c0[MTA_NUM_BITS][32], c1[MTA_NUM_BITS][32];
+    static uint8_t matrix[MTA_EXT_MATRIX_LEN];
+    static uint8_t corrections[MTA_NUM_BITS][32];
+    
+    int result = setup_ot_ext_session(&ot_sender, &ot_receiver);
+    
+    // Run 0 goes through the three flows, run 1 through OT extension, on
+    // the contexts released by run 0
+    for (int run = 0; result == 0 && run < 2; run++) {
+        bignum256 a, b;
+        generate_random_scalar(&a);
+        generate_random_scalar(&b);
+        
+        mta_context_t *sender_ctx = mta_session_acquire(pool, MTA_ROLE_SENDER, &a);
+        mta_context_t *receiver_ctx = mta_session_acquire(pool, MTA_ROLE_RECEIVER, &b);
+        if (!sender_ctx || !receiver_ctx ||
+            ((uintptr_t)sender_ctx | (uintptr_t)receiver_ctx) % MTA_POOL_ALIGN != 0) {
+            LOG_ERROR("Failed to acquire two aligned sessions");
+            result = -1;
+        }
+        
+        // The pool is exhausted
+        if (result == 0 && (mta_pool_available(pool) != 0 ||
+                            mta_session_acquire(pool, MTA_ROLE_SENDER, &a) != NULL)) {
+            LOG_ERROR("Acquired more sessions than the pool holds");
+            result = -1;
+        }
+        
+        if (result == 0 && run == 0 &&
+            (mta_sender_round1(sender_ctx, sender_msgs) != 0 ||
+             mta_receiver_round1(receiver_ctx, sender_msgs, receiver_msgs) != 0 ||
+             mta_sender_round2(sender_ctx, receiver_msgs, c0, c1) != 0 ||
+             mta_receiver_round2(receiver_ctx, (const uint8_t (*)[32])c0,
+                                 (const uint8_t (*)[32])c1) != 0)) {
+            LOG_ERROR("Three-flow MtA failed on pooled sessions");
+            result = -1;
+        }
+        if (result == 0 && run == 1 &&
+            (mta_receiver_ext_choose(receiver_ctx, &ot_receiver, matrix) != 0 ||
+             mta_sender_ext_transfer(sender_ctx, &ot_sender, matrix, corrections) != 0 ||
+             mta_receiver_ext_complete(receiver_ctx, (const uint8_t (*)[32])corrections) != 0)) {
+            LOG_ERROR("MtA over OT extension failed on pooled sessions");
+            result = -1;
+        }
+        
+        bignum256 c, d;
+        if (result == 0) {
+            mta_compute_additive_share(sender_ctx);
+            mta_compute_additive_share(receiver_ctx);
+            mta_get_additive_share(sender_ctx, &c);
+            mta_get_additive_share(receiver_ctx, &d);
+            if (!mta_verify(&a, &b, &c, &d)) {
+                result = -1;
+            }
+        }
+        
+        // Released sessions are all zero again, as acquire expects
+        if (sender_ctx && mta_session_release(pool, sender_ctx) != 0) {
+            result = -1;
+        }
+        if (receiver_ctx && mta_session_release(pool, receiver_ctx) != 0) {
+            result = -1;
+        }
+        if (result == 0 && (!session_is_wiped(sender_ctx) || !session_is_wiped(receiver_ctx))) {
+            LOG_ERROR("Released session %d was not wiped", run);
+            result = -1;
+        }
+        LOG_INFO("Pooled MtA %d: %s", run, result == 0 ? "SUCCESS" : "FAILURE");
+        
+        // A session released twice is refused
+        if (result == 0 && run == 1 && mta_session_release(pool, sender_ctx) == 0) {
+            LOG_ERROR("Released a session twice");
+            result = -1;
+        }
+    }
+    
+    if (result == 0 && mta_pool_available(pool) != 2) {
+        LOG_ERROR("The pool did not get its sessions back");
+        result = -1;
+    }
+    
+    ot_ext_sender_clear(&ot_sender);
+    ot_ext_receiver_clear(&ot_receiver);
+    mta_pool_destroy(pool);
+    
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+// One MtA over pooled random OTs; bad_index makes the sender refuse it first
+static int run_mta_rot_instance(rot_sender_pool_t *sender_pool,
+                                rot_receiver_pool_t *receiver_pool, int bad_index) {
+    bignum256 a, b;
+    generate_random_scalar(&a);
+    generate_random_scalar(&b);
+    
+    static mta_context_t sender_ctx, receiver_ctx;
+    if (mta_init(&sender_ctx, MTA_ROLE_SENDER, &a) != 0 ||
+        mta_init(&receiver_ctx, MTA_ROLE_RECEIVER, &b) != 0) {
+        LOG_ERROR("Failed to initialize MtA contexts");
+        return -1;
+    }
+    
+    uint64_t first_index;
+    uint8_t flips[MTA_ROT_FLIPS_LEN];
+    static uint8_t corrections[MTA_NUM_BITS][32];
+    
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    if (mta_receiver_rot_choose(&receiver_ctx, receiver_pool, &first_index, flips) != 0) {
+        LOG_ERROR("Receiver failed to take pooled random OTs");
+        return -1;
+    }
+    if (bad_index &&
+        mta_sender_rot_transfer(&sender_ctx, sender_pool, first_index + 1, flips,
+                                corrections) == 0) {
+        LOG_ERROR("Sender used random OTs out of step with the receiver");
+        return -1;
+    }
+    if (mta_sender_rot_transfer(&sender_ctx, sender_pool, first_index, flips, corrections) != 0 ||
+        mta_receiver_ext_complete(&receiver_ctx, (const uint8_t (*)[32])corrections) != 0) {
+        LOG_ERROR("MtA over pooled random OTs failed");
+        return -1;
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    LOG_INFO("Online MtA on random OTs %llu..%llu: %.2f ms",
+             (unsigned long long)first_index,
+             (unsigned long long)first_index + MTA_NUM_BITS - 1,
+             1000.0 * (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e6);
+    
+    // The transfer already set the sender's share
+    bignum256 c, d;
+    mta_compute_additive_share(&receiver_ctx);
+    mta_get_additive_share(&sender_ctx, &c);
+    mta_get_additive_share(&receiver_ctx, &d);
+    
+    return mta_verify(&a, &b, &c, &d) ? 0 : -1;
+}
+
+// Offline phase: both parties pool count more random OTs
+static int fill_rot_pools(rot_sender_pool_t *sender_pool, rot_receiver_pool_t *receiver_pool,
+                          ot_ext_sender_t *ot_sender, ot_ext_receiver_t *ot_receiver,
+                          size_t count) {
+    uint8_t *matrix = malloc(OT_EXT_MATRIX_LEN(count));
+    if (!matrix) {
+        return -1;
+    }
+    
+    clock_t start = clock();
+    int ret = rot_receiver_pool_fill(receiver_pool, ot_receiver, count, matrix);
+    if (ret == 0) {
+        ret = rot_sender_pool_fill(sender_pool, ot_sender, matrix, count);
+    }
+    LOG_INFO("Offline: pooled %zu random OTs in %.2f ms", count,
+             1000.0 * (clock() - start) / CLOCKS_PER_SEC);
+    
+    free(matrix);
+    return ret;
+}
+
+int run_rot_pool_test(void) {
+    LOG_INFO("===== Random OT Pool Test =====");
+    
+    static ot_ext_sender_t ot_sender;
+    static ot_ext_receiver_t ot_receiver;
+    rot_sender_pool_t sender_pool;
+    rot_receiver_pool_t receiver_pool;
+    
+    if (setup_ot_ext_session(&ot_sender, &ot_receiver) != 0) {
+        return -1;
+    }
+    if (rot_sender_pool_init(&sender_pool, 5 * MTA_NUM_BITS / 2) != 0) {
+        return -1;
+    }
+    if (rot_receiver_pool_init(&receiver_pool, 5 * MTA_NUM_BITS / 2) != 0) {
+        rot_sender_pool_free(&sender_pool);
+        return -1;
+    }
+    
+    // Two MtAs' worth, then one more after the first MtA, which moves the
+    // unused OTs to the front of the pools
+    int result = fill_rot_pools(&sender_pool, &receiver_pool, &ot_sender, &ot_receiver,
+                                2 * MTA_NUM_BITS);
+    if (result == 0) {
+        result = run_mta_rot_instance(&sender_pool, &receiver_pool, 0);
+    }
+    if (result == 0) {
+        result = fill_rot_pools(&sender_pool, &receiver_pool, &ot_sender, &ot_receiver,
+                                MTA_NUM_BITS);
+    }
+    for (int i = 0; i < 2 && result == 0; i++) {
+        result = run_mta_rot_instance(&sender_pool, &receiver_pool, i == 0);
+    }
+    
+    // Both pools are used up
+    if (result == 0 && (rot_sender_pool_available(&sender_pool) != 0 ||
+                        rot_receiver_pool_available(&receiver_pool) != 0)) {
+        LOG_ERROR("Random OTs left in the pools");
+        result = -1;
+    }
+    
+    rot_sender_pool_free(&sender_pool);
+    rot_receiver_pool_free(&receiver_pool);
+    ot_ext_sender_clear(&ot_sender);
+    ot_ext_receiver_clear(&ot_receiver);
+    
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
+
+// Scratch log of the async logger test, read back and removed
+#define LOGGER_TEST_FILE "logger_test.log"
+#define LOGGER_TEST_THREADS 4
+#define LOGGER_TEST_LINES 200
+#define LOGGER_TEST_OVERFLOW 100
+
+static void *logger_test_thread_main(void *arg) {
+    int t = *(const int *)arg;
+    for (int i = 0; i < LOGGER_TEST_LINES; i++) {
+        LOG_INFO("async %d %d", t, i);
+    }
+    return NULL;
+}
+
+int run_logger_async_test(void) {
+    LOG_INFO("===== Async Logger Test =====");
+    
+    // Everything goes to a scratch file from here on, only errors to the
+    // terminal; the caller's configuration is put back at the end
+    logger_config_t saved;
+    logger_get_config(&saved);
+    logger_stop_async();
+    if (logger_init(LOG_ERROR, LOGGER_TEST_FILE, LOG_DEBUG) != 0) {
+        logger_set_config(&saved);
+        return -1;
+    }
+    
+    int result = 0;
+    
+    // Several threads log at once, every line reaches the file
+    pthread_t threads[LOGGER_TEST_THREADS];
+    int ids[LOGGER_TEST_THREADS];
+    int started = 0;
+    if (logger_start_async() != 0) {
+        result = -1;
+    }
+    for (int t = 0; result == 0 && t < LOGGER_TEST_THREADS; t++) {
+        ids[t] = t;
+        if (pthread_create(&threads[t], NULL, logger_test_thread_main, &ids[t]) != 0) {
+            result = -1;
+            break;
+        }
+        started++;
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    logger_stop_async();
+    uint64_t dropped_concurrent = logger_dropped_lines();
+    
+    // The drain thread is held up on the stdout lock behind one INFO line.
+    // Whether it popped that line before or during the flood, it frees at
+    // most one slot, so LOGGER_TEST_OVERFLOW or one more lines are dropped
+    uint64_t dropped_overflow = 0;
+    if (result == 0) {
+        logger_set_level(LOG_INFO);
+        if (logger_start_async() != 0) {
+            result = -1;
+        }
+    }
+    if (result == 0) {
+        flockfile(stdout);
+        LOG_INFO("Async log sink held up behind this line");
+        for (int i = 0; i < LOGGER_ASYNC_SLOTS + LOGGER_TEST_OVERFLOW; i++) {
+            LOG_DEBUG("overflow %d", i);
+        }
+        dropped_overflow = logger_dropped_lines();
+        
+        // The count of dropped lines only goes to the file
+        logger_set_level(LOG_NONE);
+        funlockfile(stdout);
+        logger_stop_async();
+    }
+    
+    // After stop lines are written directly, before log_message returns
+    LOG_DEBUG("sync after stop");
+    uint64_t dropped_after = logger_dropped_lines();
+    logger_init(LOG_ERROR, NULL, LOG_NONE);
+    
+    if (result == 0 && dropped_concurrent != 0) {
+        LOG_ERROR("Async log sink dropped %llu of %d lines", 
+                  (unsigned long long)dropped_concurrent,
+                  LOGGER_TEST_THREADS * LOGGER_TEST_LINES);
+        result = -1;
+    }
+    if (result == 0 && (dropped_overflow < LOGGER_TEST_OVERFLOW ||
+                        dropped_overflow > LOGGER_TEST_OVERFLOW + 1 ||
+                        dropped_after != dropped_overflow)) {
+        LOG_ERROR("Async log sink dropped %llu lines, expected %d",
+                  (unsigned long long)dropped_overflow, LOGGER_TEST_OVERFLOW);
+        result = -1;
+    }
+    
+    // Read the lines back: each async line once, the overflow lines that
+    // were not dropped in order, and the direct line last
+    static uint8_t seen[LOGGER_TEST_THREADS][LOGGER_TEST_LINES];
+    memset(seen, 0, sizeof(seen));
+    int async_lines = 0, overflow_lines = 0, last_overflow = -1;
+    int sync_last = 0, dropped_noted = 0;
+    char line[LOGGER_LINE_MAX + 16];
+    FILE *f = fopen(LOGGER_TEST_FILE, "r");
+    if (!f) {
+        result = -1;
+    }
+    while (f && fgets(line, sizeof(line), f)) {
+        int t, i;
+        sync_last = strcmp(line, "[DEBUG] sync after stop\n") == 0;
+        if (sscanf(line, "[INFO] async %d %d", &t, &i) == 2 &&
+            t >= 0 && t < LOGGER_TEST_THREADS && i >= 0 && i < LOGGER_TEST_LINES &&
+            !seen[t][i]) {
+            seen[t][i] = 1;
+            async_lines++;
+        } else if (sscanf(line, "[DEBUG] overflow %d", &i) == 1 && i > last_overflow) {
+            last_overflow = i;
+            overflow_lines++;
+        } else if (strstr(line, "Async log sink dropped")) {
+            dropped_noted = 1;
+        }
+    }
+    if (f) {
+        fclose(f);
+    }
+    remove(LOGGER_TEST_FILE);
+    
+    logger_config_t restored;
+    if (logger_set_config(&saved) != 0) {
+        result = -1;
+    }
+    logger_get_config(&restored);
+    if (restored.level != saved.level || restored.file_level != saved.file_level ||
+        strcmp(restored.logfile, saved.logfile) != 0 || restored.async != saved.async) {
+        LOG_ERROR("Logger configuration not restored");
+        result = -1;
+    }
+    LOG_INFO("Async lines: %d of %d, overflow lines kept: %d, dropped: %llu",
+             async_lines, LOGGER_TEST_THREADS * LOGGER_TEST_LINES, overflow_lines,
+             (unsigned long long)dropped_overflow);
+    if (result == 0 && (async_lines != LOGGER_TEST_THREADS * LOGGER_TEST_LINES ||
+                        overflow_lines + dropped_overflow !=
+                            LOGGER_ASYNC_SLOTS + LOGGER_TEST_OVERFLOW ||
+                        !dropped_noted || !sync_last)) {
+        LOG_ERROR("Async log sink lost, reordered or duplicated lines");
+        result = -1;
+    }
+    LOG_INFO("Verification result: %s", result == 0 ? "SUCCESS" : "FAILURE");
+    
+    return result;
+}
@@ -10,4 +10,179 @@
  */
 int run_mta_full_test(void);
 
+/**
+ * Run several MtA instances over one OT extension session
+ * 
+ * @return 0 on success (all verifications passed), -1 on failure
+ */
+int run_mta_ot_ext_test(void);
+
+/**
+ * Run a batch of MtA instances over one OT extension session
+ * 
+ * @return 0 on success (all verifications passed), -1 on failure
+ */
+int run_mta_batch_test(void);
+
+/**
+ * Run one MtA with every phase spread over a worker pool
+ * 
+ * @param num_threads Number of threads of the pool
+ * @return 0 on success (verification passed), -1 on failure
+ */
+int run_mta_parallel_test(int num_threads);
+
+/**
+ * Run one MtA with the compact, streaming contexts
+ * 
+ * @return 0 on success (verification passed), -1 on failure
+ */
+int run_mta_compact_test(void);
+
+/**
+ * Check that seeded MtA contexts replay the same messages
+ * 
+ * @return 0 on success (runs match), -1 on failure
+ */
+int run_mta_seeded_test(void);
+
+/**
+ * Run the three-flow MtA and compare it with the per-bit schedule
+ * 
+ * @return 0 on success (same flows and shares, verification passed), -1 on failure
+ */
+int run_mta_rounds_test(void);
+
+/**
+ * Run the three-flow MtA over Simplest OT
+ * 
+ * @return 0 on success (verification passed), -1 on failure
+ */
+int run_mta_simplest_test(void);
+
+/**
+ * Run base OTs and whole MtAs on the Curve25519 backend
+ * 
+ * @return 0 on success (keys match the choices, verifications passed), -1 on failure
+ */
+int run_base_ot_curve25519_test(void);
+
+/**
+ * Run base OTs that carry a multi-block vector payload
+ * 
+ * @return 0 on success (chosen messages received), -1 on failure
+ */
+int run_base_ot_vector_test(void);
+
+/**
+ * Check the lazily reduced scalar sum against step-by-step reduction
+ * 
+ * @return 0 on success (sums match), -1 on failure
+ */
+int run_scalar_acc_test(void);
+
+/**
+ * Check the doubling table of x(2^i) against multiplications by 2^i
+ * 
+ * @return 0 on success (tables match), -1 on failure
+ */
+int run_shifted_shares_test(void);
+
+/**
+ * Check opt_multi_point_multiply against sums of single multiplications
+ * 
+ * @return 0 on success (sums match), -1 on failure
+ */
+int run_multi_point_test(void);
+
+/**
+ * Check opt_point_multiply and opt_point_multiply_ct against point_multiply
+ * on G and a random point, for small, near-order and random scalars
+ * 
+ * @return 0 on success (points match), -1 on failure
+ */
+int run_point_multiply_diff_test(void);
+
+/**
+ * Check opt_scalar_multiply against scalar_multiply, and opt_comb_multiply
+ * with the tables of G and a random point against point_multiply
+ * 
+ * @return 0 on success (points match), -1 on failure
+ */
+int run_comb_multiply_diff_test(void);
+
+/**
+ * Check jacobian_batch_to_affine against jacobian_to_curve, with points at
+ * infinity (z == 0 modulo p) inside the batch and on their own
+ * 
+ * @return 0 on success (points match), -1 on failure
+ */
+int run_batch_to_affine_diff_test(void);
+
+/**
+ * Check bn_multiply modulo the secp256k1 prime and order (the 64-bit limb
+ * path when built in) against the generic reduction, on operands near the
+ * moduli, partly reduced ones and random ones
+ * 
+ * @return 0 on success (products match), -1 on failure
+ */
+int run_bn_multiply_diff_test(void);
+
+/**
+ * Check SHA-256 against known answers and the 8-way hashes against sha256_Raw
+ * 
+ * @return 0 on success (all digests match), -1 on failure
+ */
+int run_sha256_test(void);
+
+/**
+ * Check the kdf backends against each other and run MtAs with each of them
+ * 
+ * @return 0 on success (all MtAs verified, AES paths agree), -1 on failure
+ */
+int run_kdf_test(void);
+
+/**
+ * Run one MtA whose rounds go through wire frames
+ * 
+ * @return 0 on success (verification passed, bad frames refused), -1 on failure
+ */
+int run_wire_test(void);
+
+/**
+ * Run one MtA between two threads over each transport backend
+ * 
+ * @return 0 on success (verification passed), -1 on failure
+ */
+int run_mta_two_party_test(void);
+
+/**
+ * Run the pipelined parties with several windows and chunk sizes
+ * 
+ * @return 0 on success (verification passed), -1 on failure
+ */
+int run_mta_pipelined_test(void);
+
+/**
+ * Run MtAs on sessions from a pool and check that released sessions are wiped
+ * 
+ * @return 0 on success (verification passed, sessions wiped), -1 on failure
+ */
+int run_mta_pool_test(void);
+
+/**
+ * Run MtAs over pooled random OTs, refilling the pools in between
+ * 
+ * @return 0 on success (verification passed, out-of-step OTs refused), -1 on failure
+ */
+int run_rot_pool_test(void);
+
+/**
+ * Check the async log sink: concurrent lines, overflow and the direct path
+ * after stop. Restores the logger configuration it found.
+ * 
+ * @return 0 on success (every line written or counted as dropped), -1 on failure
+ */
+int run_logger_async_test(void);
+
 #endif /* __MTA_TEST_H__ */
\ No newline at end of file